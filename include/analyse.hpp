@@ -1,7 +1,12 @@
+#pragma once
+
 #include <unistd.h>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -10,20 +15,37 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <numeric>
+#include <optional>
 #include <print>
 #include <ranges>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "call_graph.hpp"
+#include "clone_detector.hpp"
+#include "error.hpp"
 #include "file.hpp"
+#include "git_source.hpp"
 #include "function.hpp"
+#include "interner.hpp"
 #include "metric.hpp"
 #include "metric_accumulator.hpp"
+#include "path_queue.hpp"
+#include "result_cache.hpp"
+#include "schedule.hpp"
+#include "source_reader.hpp"
 
 namespace analyzer {
 
@@ -34,11 +56,23 @@ using FunctionAnalysisEntry = std::pair<function::Function, metric::MetricResult
 using FunctionAnalysis = std::vector<FunctionAnalysisEntry>;
 using GroupedFunctionAnalysis = std::vector<FunctionAnalysis>;
 
+// Запись отчёта об ошибке. Для пропущенного файла function и metric_name пусты,
+// для невычисленной метрики заполнены оба, а остальные метрики функции остаются в анализе
+struct AnalysisError {
+    interner::InternedString filename;
+    std::string function;  // Класс.функция или просто имя функции
+    interner::InternedString metric_name;
+    Error error;
+};
+
+using AnalysisErrors = std::vector<AnalysisError>;
+
 namespace detail {
 
 template <typename Range, typename KeySelector>
 auto GroupByRange(Range &&range, KeySelector &&key_selector) {
-    using State = std::pair<GroupedFunctionAnalysis, std::unordered_map<std::string, std::size_t>>;
+    using Key = std::invoke_result_t<KeySelector &, std::ranges::range_reference_t<Range>>;
+    using State = std::pair<GroupedFunctionAnalysis, std::unordered_map<Key, std::size_t>>;
 
     auto view = rv::all(std::forward<Range>(range));
     auto selector = std::forward<KeySelector>(key_selector);
@@ -62,45 +96,622 @@ auto GroupByRange(Range &&range, KeySelector &&key_selector) {
 
 }  // namespace detail
 
-inline auto AnalyseFunctions(const std::vector<std::string> &files,
-                             const analyzer::metric::MetricExtractor &metric_extractor) {
-    analyzer::function::FunctionExtractor extractor;
-
-    return files
-           | rv::transform([&](const std::string &filename) {
-                 analyzer::file::File file(filename);
-                 return extractor.Get(file);
-             })
-           | rv::join
-           | rv::transform([&](function::Function func) {
-                 auto metrics = metric_extractor.Get(func);
-                 return FunctionAnalysisEntry{std::move(func), std::move(metrics)};
-             })
+// Монотонная арена файла: выделения из неё — сдвиг указателя, освобождение — один вызов release()
+using FileArena = std::pmr::monotonic_buffer_resource;
+
+// Ограничения прогона; нулевое значение — без ограничения
+struct AnalysisLimits {
+    file::ParseLimits parse;              // Таймаут и лимит вывода для каждого запуска tree-sitter
+    std::chrono::milliseconds budget{0};  // Общее время: после него новые файлы не начинаются
+};
+
+namespace detail {
+
+// Общий дедлайн прогона. Таймаут разбора урезается до остатка бюджета, поэтому прогон
+// выходит за бюджет не больше чем на время метрик одного файла
+class RunBudget {
+public:
+    explicit RunBudget(const AnalysisLimits &limits)
+        : limits_(limits), deadline_(std::chrono::steady_clock::now() + limits.budget) {}
+
+    // nullopt, если бюджет исчерпан и файл начинать нельзя
+    std::optional<file::ParseLimits> NextFileLimits() const {
+        auto parse = limits_.parse;
+        if (limits_.budget.count() <= 0)
+            return parse;
+
+        // Остаток округляется вверх: урезанный разбор заканчивается не раньше дедлайна, и следующий файл
+        // пропускается, а не запускается с таймаутом в доли миллисекунды
+        const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline_ - std::chrono::steady_clock::now());
+        if (left.count() <= 0)
+            return std::nullopt;
+        if (parse.timeout.count() <= 0 || parse.timeout > left)
+            parse.timeout = left;
+        return parse;
+    }
+
+private:
+    AnalysisLimits limits_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+inline AnalysisError SkippedByBudget(const std::string &filename) {
+    return AnalysisError{.filename = filename, .error = Error{ErrorCode::kSkipped, "time budget exhausted"}};
+}
+
+}  // namespace detail
+
+namespace detail {
+
+// Функции и метрики уже разобранного файла; имя файла в результатах — file.name
+inline FunctionAnalysis AnalyseOpenedFile(const file::File &file,
+                                          const analyzer::metric::MetricExtractor &metric_extractor,
+                                          std::pmr::memory_resource *resource, AnalysisErrors &errors) {
+    analyzer::function::FunctionExtractor extractor{.collect_callees = metric_extractor.collect_callees};
+    auto functions = extractor.TryGet(file, resource);
+    if (!functions) {
+        errors.push_back(AnalysisError{.filename = file.name, .error = std::move(functions.error())});
+        return {};
+    }
+
+    std::vector<metric::MetricError> metric_errors;
+    return *functions | rv::transform([&](function::Function &func) {
+               auto metrics = metric_extractor.Get(func, resource, metric_errors);
+               rs::for_each(metric_errors, [&](metric::MetricError &metric_error) {
+                   errors.push_back(AnalysisError{.filename = func.filename,
+                                                  .function = function::QualifiedName(func),
+                                                  .metric_name = metric_error.metric_name,
+                                                  .error = std::move(metric_error.error)});
+               });
+               metric_errors.clear();
+               func.source_lines = {};  // Строки живут вместе с File
+               return FunctionAnalysisEntry{std::move(func), std::move(metrics)};
+           })
            | rs::to<FunctionAnalysis>();
 }
 
+}  // namespace detail
+
+// AST и строки исходника выделяются из scratch и не нужны после возврата;
+// строки функций и результаты метрик выделяются из resource.
+// Ошибки файла и метрик дописываются в errors, исключений на некорректном входе нет.
+// source — уже прочитанный исходник, например из io::Prefetcher
+inline FunctionAnalysis AnalyseFile(const std::string &filename, io::Source source,
+                                    const analyzer::metric::MetricExtractor &metric_extractor,
+                                    std::pmr::memory_resource *scratch, std::pmr::memory_resource *resource,
+                                    AnalysisErrors &errors, const file::ParseLimits &limits = {}) {
+    auto file = analyzer::file::File::Open(filename, std::move(source), scratch, limits);
+    if (!file) {
+        errors.push_back(AnalysisError{.filename = filename, .error = std::move(file.error())});
+        return {};
+    }
+    return detail::AnalyseOpenedFile(*file, metric_extractor, resource, errors);
+}
+
+inline FunctionAnalysis AnalyseFile(const std::string &filename,
+                                    const analyzer::metric::MetricExtractor &metric_extractor,
+                                    std::pmr::memory_resource *scratch, std::pmr::memory_resource *resource,
+                                    AnalysisErrors &errors, const file::ParseLimits &limits = {}) {
+    return AnalyseFile(filename, io::ReadWholeFile(filename), metric_extractor, scratch, resource, errors, limits);
+}
+
+// resource должен пережить результат; данные разбора каждого файла живут в отдельной арене,
+// которая освобождается сразу после файла. Файлы и метрики с ошибками пропускаются и попадают в errors.
+// Файлы, не начатые до конца бюджета, тоже попадают в errors, а результат остаётся частичным
+inline FunctionAnalysis AnalyseFunctions(const std::vector<std::string> &files,
+                                         const analyzer::metric::MetricExtractor &metric_extractor,
+                                         AnalysisErrors &errors,
+                                         std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                         const AnalysisLimits &limits = {}) {
+    FunctionAnalysis analysis;
+    FileArena scratch;
+    const detail::RunBudget budget(limits);
+    rs::for_each(files, [&](const std::string &filename) {
+        const auto parse_limits = budget.NextFileLimits();
+        if (!parse_limits) {
+            errors.push_back(detail::SkippedByBudget(filename));
+            return;
+        }
+        auto file_analysis = AnalyseFile(filename, metric_extractor, &scratch, resource, errors, *parse_limits);
+        scratch.release();
+        rs::move(file_analysis, std::back_inserter(analysis));
+    });
+    return analysis;
+}
+
+namespace detail {
+
+// Копия записи в resource: строки функции и вектор метрик выделяются заново, интернированные имена общие
+inline FunctionAnalysisEntry CopyEntry(const FunctionAnalysisEntry &entry, std::pmr::memory_resource *resource) {
+    const auto &func = entry.first;
+    return FunctionAnalysisEntry{function::Function{.filename = func.filename,
+                                                    .class_name = func.class_name,
+                                                    .name = std::pmr::string(func.name, resource),
+                                                    .ast = std::pmr::string(func.ast, resource),
+                                                    .first_line = func.first_line,
+                                                    .end_line = func.end_line,
+                                                    .callees = {func.callees.begin(), func.callees.end(), resource}},
+                                 metric::MetricResults(entry.second.begin(), entry.second.end(), resource)};
+}
+
+// Состояние параллельного прогона: у каждого воркера свои арены, результаты хранятся по номеру файла.
+// Collect копирует их в resource в порядке номеров, поэтому resource не обязан быть потокобезопасным
+class ParallelRun {
+public:
+    ParallelRun(std::size_t workers, const AnalysisLimits &limits)
+        : scratch_(workers), results_(workers), budget_(limits) {}
+
+    // Исходник забирается из prefetcher только после проверки бюджета; без prefetcher файл читается здесь же.
+    // Когда бюджет исчерпан, prefetcher останавливается, и оставшиеся файлы не читаются с диска
+    void Analyse(std::size_t index, const std::string &filename,
+                 const analyzer::metric::MetricExtractor &metric_extractor, std::size_t worker,
+                 io::Prefetcher *prefetcher = nullptr) {
+        auto &slot = Slot(index);
+        const auto parse_limits = budget_.NextFileLimits();
+        if (!parse_limits) {
+            slot.errors.push_back(SkippedByBudget(filename));
+            if (prefetcher)
+                prefetcher->Stop();
+            return;
+        }
+        auto source = prefetcher ? prefetcher->Take(index) : io::ReadWholeFile(filename);
+        slot.analysis = AnalyseFile(filename, std::move(source), metric_extractor, &scratch_[worker],
+                                    &results_[worker], slot.errors, *parse_limits);
+        scratch_[worker].release();
+    }
+
+    FunctionAnalysis Collect(AnalysisErrors &errors, std::pmr::memory_resource *resource) {
+        auto filled = slots_ | rv::filter([](const auto &slot) { return slot != nullptr; });
+        FunctionAnalysis analysis;
+        analysis.reserve(rs::fold_left(filled, std::size_t{0}, [](std::size_t total, const auto &slot) {
+            return total + slot->analysis.size();
+        }));
+        rs::for_each(filled, [&](const auto &slot) {
+            rs::transform(slot->analysis, std::back_inserter(analysis),
+                          [resource](const FunctionAnalysisEntry &entry) { return CopyEntry(entry, resource); });
+            rs::move(slot->errors, std::back_inserter(errors));
+        });
+        return analysis;
+    }
+
+private:
+    struct FileSlot {
+        FunctionAnalysis analysis;
+        AnalysisErrors errors;
+    };
+
+    // Слот создаётся под мьютексом и дальше принадлежит одному воркеру
+    FileSlot &Slot(std::size_t index) {
+        std::lock_guard lock(mutex_);
+        if (index >= slots_.size())
+            slots_.resize(index + 1);
+        if (!slots_[index])
+            slots_[index] = std::make_unique<FileSlot>();
+        return *slots_[index];
+    }
+
+    std::vector<FileArena> scratch_;
+    std::vector<FileArena> results_;
+    RunBudget budget_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<FileSlot>> slots_;  // Объявлены после арен, поэтому уничтожаются раньше них
+};
+
+}  // namespace detail
+
+// Параллельный AnalyseFunctions: файлы раздаются jobs воркерам по убыванию размера (LPT), а результаты
+// и ошибки складываются в исходном порядке файлов. Исходники заранее читаются пачками в том же порядке
+// (io_uring или пул pread), воркер получает готовый буфер. Воркеры разбирают файлы в своих аренах, итог
+// копируется в resource в вызывающем потоке, поэтому resource не обязан быть потокобезопасным.
+// Если profile не nullptr, в него пишется makespan и его нижняя граница
+inline FunctionAnalysis AnalyseFunctionsParallel(const std::vector<std::string> &files,
+                                                 const analyzer::metric::MetricExtractor &metric_extractor,
+                                                 AnalysisErrors &errors, std::size_t jobs,
+                                                 std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                                 const AnalysisLimits &limits = {},
+                                                 schedule::ScheduleProfile *profile = nullptr) {
+    const auto workers = std::clamp<std::size_t>(jobs, 1, std::max<std::size_t>(files.size(), 1));
+    detail::ParallelRun run(workers, limits);
+
+    const auto costs = files | rv::transform(schedule::EstimateFileCost) | rs::to<std::vector<std::uint64_t>>();
+    io::Prefetcher prefetcher(files, schedule::LongestFirstOrder(costs),
+                              io::MakeBatchReader(io::Backend::kAuto, workers));
+    const auto run_profile = schedule::RunLongestFirst(costs, workers, [&](std::size_t index, std::size_t worker) {
+        run.Analyse(index, files[index], metric_extractor, worker, &prefetcher);
+    });
+    if (profile)
+        *profile = run_profile;
+    return run.Collect(errors, resource);
+}
+
+// Потоковый вариант AnalyseFunctionsParallel: воркеры берут пути из очереди, пока источник
+// (обход каталогов, список из stdin) ещё пишет в неё. Результаты и ошибки идут в порядке поступления путей
+inline FunctionAnalysis AnalyseFunctionsStreaming(
+    PathQueue &paths, const analyzer::metric::MetricExtractor &metric_extractor, AnalysisErrors &errors,
+    std::size_t jobs, std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+    const AnalysisLimits &limits = {}, schedule::ScheduleProfile *profile = nullptr) {
+    const auto workers = std::max<std::size_t>(jobs, 1);
+    detail::ParallelRun run(workers, limits);
+
+    const auto run_profile = schedule::RunWorkers(
+        workers, [&paths] { return paths.Pop(); },
+        [&](QueuedPath queued, std::size_t worker) {
+            run.Analyse(queued.index, queued.path, metric_extractor, worker);
+        });
+    if (profile)
+        *profile = run_profile;
+    return run.Collect(errors, resource);
+}
+
+namespace detail {
+
+// Результаты файла для кеша: без пути и AST
+inline cache::CachedFile ToCachedFile(const FunctionAnalysis &analysis) {
+    cache::CachedFile cached;
+    cached.functions.reserve(analysis.size());
+    rs::for_each(analysis, [&](const FunctionAnalysisEntry &entry) {
+        const auto &func = entry.first;
+        cached.functions.push_back(cache::CachedFunction{
+            .class_name = func.class_name ? std::optional<std::string>(func.class_name->View()) : std::nullopt,
+            .name = std::string(func.name),
+            .metrics = {entry.second.begin(), entry.second.end()}});
+    });
+    return cached;
+}
+
+// Записи анализа из кеша под именем filename; AST функций пуст
+inline void AppendCachedFile(const cache::CachedFile &cached, const interner::InternedString &filename,
+                             std::pmr::memory_resource *resource, FunctionAnalysis &analysis) {
+    rs::transform(cached.functions, std::back_inserter(analysis), [&](const cache::CachedFunction &cached_func) {
+        return FunctionAnalysisEntry{
+            function::Function{.filename = filename,
+                               .class_name = cached_func.class_name
+                                                 ? std::optional<interner::InternedString>(*cached_func.class_name)
+                                                 : std::nullopt,
+                               .name = std::pmr::string(cached_func.name, resource),
+                               .ast = std::pmr::string(resource)},
+            metric::MetricResults(cached_func.metrics.begin(), cached_func.metrics.end(), resource)};
+    });
+}
+
+// Ключ кеша — id blob-а и набор метрик (FNV-1a имён): после смены метрик старые записи не подходят
+inline std::string RevisionCacheKey(std::string_view object_id,
+                                    const analyzer::metric::MetricExtractor &metric_extractor) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const auto &metric : metric_extractor.metrics)
+        for (char ch : std::string(metric->MetricName().View()) + '\n')
+            hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+    std::ostringstream key;
+    key << object_id << '-' << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+}  // namespace detail
+
+// Анализ blob-ов репозитория repository прямо из базы объектов git, без рабочего дерева. Содержимое blob-ов
+// читается одним долгоживущим git cat-file --batch и раздаётся jobs воркерам; tree-sitter читает файлы с диска,
+// поэтому blob пишется во временный файл, а в отчёте остаётся путь из blobs. Одинаковые blob-ы
+// разбираются один раз; с cache результаты по id blob-а переиспользуются между ревизиями и запусками.
+// Файлы с ошибками в кеш не попадают. У функций из результата пустой AST
+inline FunctionAnalysis AnalyseBlobs(const std::string &repository, const std::vector<git::BlobEntry> &blobs,
+                                     const analyzer::metric::MetricExtractor &metric_extractor,
+                                     AnalysisErrors &errors, std::size_t jobs,
+                                     std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                     const AnalysisLimits &limits = {}, cache::ResultCache *cache = nullptr,
+                                     schedule::ScheduleProfile *profile = nullptr) {
+    // Уникальные blob-ы в порядке первого появления
+    std::vector<std::size_t> unique_of(blobs.size());
+    std::vector<std::size_t> first_blob;
+    std::unordered_map<std::string_view, std::size_t> unique_index;
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        const auto [it, inserted] = unique_index.try_emplace(blobs[i].object_id, first_blob.size());
+        if (inserted)
+            first_blob.push_back(i);
+        unique_of[i] = it->second;
+    }
+
+    std::vector<std::string> keys(first_blob.size());
+    std::vector<std::shared_ptr<const cache::CachedFile>> results(first_blob.size());
+    std::vector<AnalysisErrors> file_errors(first_blob.size());
+    std::vector<std::size_t> pending;
+    for (std::size_t unique = 0; unique < first_blob.size(); ++unique) {
+        keys[unique] = detail::RevisionCacheKey(blobs[first_blob[unique]].object_id, metric_extractor);
+        if (cache)
+            results[unique] = cache->Find(keys[unique]);
+        if (!results[unique])
+            pending.push_back(unique);
+    }
+
+    if (!pending.empty()) {
+        auto objects = git::CatFileBatch::Start(repository);
+        auto temp = git::TempDirectory::Create("analyzer-rev-");
+        if (!objects || !temp) {
+            errors.push_back(AnalysisError{.filename = repository, .error = objects ? temp.error() : objects.error()});
+            return {};
+        }
+
+        struct BlobJob {
+            std::size_t unique;
+            io::Source source;
+        };
+        std::mutex objects_mutex;
+        std::size_t next_pending = 0;
+        const auto workers = std::clamp<std::size_t>(jobs, 1, pending.size());
+        std::vector<FileArena> scratch(workers);
+        const detail::RunBudget budget(limits);
+
+        const auto run_profile = schedule::RunWorkers(
+            workers,
+            [&]() -> std::optional<BlobJob> {
+                std::lock_guard lock(objects_mutex);
+                if (next_pending == pending.size())
+                    return std::nullopt;
+                const auto unique = pending[next_pending++];
+                return BlobJob{unique, (*objects)->Read(blobs[first_blob[unique]].object_id)};
+            },
+            [&](BlobJob job, std::size_t worker) {
+                scratch[worker].release();  // Данные предыдущего blob-а этого воркера
+                const auto &blob = blobs[first_blob[job.unique]];
+                auto &blob_errors = file_errors[job.unique];
+                const auto parse_limits = budget.NextFileLimits();
+                if (!parse_limits) {
+                    blob_errors.push_back(detail::SkippedByBudget(blob.path));
+                    return;
+                }
+                if (!job.source) {
+                    blob_errors.push_back(
+                        AnalysisError{.filename = blob.path, .error = std::move(job.source.error())});
+                    return;
+                }
+
+                const auto extension = std::filesystem::path(blob.path).extension().string();
+                const auto temp_path = (temp->Path() / (blob.object_id + extension)).string();
+                if (!(std::ofstream(temp_path, std::ios::binary) << *job.source)) {
+                    blob_errors.push_back(AnalysisError{
+                        .filename = blob.path, .error = Error{ErrorCode::kIo, "Failed to write " + temp_path}});
+                    return;
+                }
+                auto file = file::File::Open(temp_path, std::move(job.source), &scratch[worker], *parse_limits);
+                std::filesystem::remove(temp_path);
+                if (!file) {
+                    blob_errors.push_back(AnalysisError{.filename = blob.path, .error = std::move(file.error())});
+                    return;
+                }
+
+                file->name = blob.path;
+                const auto analysis =
+                    detail::AnalyseOpenedFile(*file, metric_extractor, &scratch[worker], blob_errors);
+                results[job.unique] = std::make_shared<const cache::CachedFile>(detail::ToCachedFile(analysis));
+                if (cache && blob_errors.empty())
+                    cache->Store(keys[job.unique], results[job.unique]);
+            });
+        if (profile)
+            *profile = run_profile;
+    }
+
+    FunctionAnalysis analysis;
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        const interner::InternedString filename(blobs[i].path);
+        const auto unique = unique_of[i];
+        if (results[unique])
+            detail::AppendCachedFile(*results[unique], filename, resource, analysis);
+        rs::transform(file_errors[unique], std::back_inserter(errors), [&](AnalysisError error) {
+            error.filename = filename;
+            return error;
+        });
+    }
+    return analysis;
+}
+
+// Анализ ревизии rev (коммит, тег, ветка) через AnalyseBlobs: все её файлы .py
+inline FunctionAnalysis AnalyseRevision(const std::string &repository, const std::string &rev,
+                                        const analyzer::metric::MetricExtractor &metric_extractor,
+                                        AnalysisErrors &errors, std::size_t jobs,
+                                        std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                        const AnalysisLimits &limits = {}, cache::ResultCache *cache = nullptr,
+                                        schedule::ScheduleProfile *profile = nullptr) {
+    auto blobs = git::ListBlobs(rev, {".py"}, repository);
+    if (!blobs) {
+        errors.push_back(AnalysisError{.filename = rev, .error = std::move(blobs.error())});
+        return {};
+    }
+    return AnalyseBlobs(repository, *blobs, metric_extractor, errors, jobs, resource, limits, cache, profile);
+}
+
+// Изменённые функции рабочего дерева и их версии в базовой ревизии
+struct ChangeAnalysis {
+    FunctionAnalysis changed;
+    FunctionAnalysis base;  // Функции затронутых файлов в базовой ревизии, AST пуст
+    // Для changed[i] — индекс той же функции в base, nullopt у новой функции. Функции сопоставляются по файлу
+    // (с учётом переименования) и имени с классом; одноимённые — по порядку в файле
+    std::vector<std::optional<std::size_t>> base_index;
+};
+
+// Анализ для проверки изменений: разбираются только файлы .py, изменённые относительно base_rev по git diff,
+// и остаются функции, чьи строки пересекают ханки. Базовые версии затронутых файлов берутся из базы
+// объектов git через AnalyseBlobs и cache, поэтому время зависит от размера diff, а не репозитория
+inline ChangeAnalysis AnalyseChanges(const std::string &repository, const std::string &base_rev,
+                                     const analyzer::metric::MetricExtractor &metric_extractor,
+                                     AnalysisErrors &errors, std::size_t jobs,
+                                     std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                     const AnalysisLimits &limits = {}, cache::ResultCache *cache = nullptr,
+                                     schedule::ScheduleProfile *profile = nullptr) {
+    auto changes = git::ChangedFiles(base_rev, {".py"}, repository);
+    if (!changes) {
+        errors.push_back(AnalysisError{.filename = base_rev, .error = std::move(changes.error())});
+        return {};
+    }
+
+    std::vector<std::string> files;
+    std::vector<git::BlobEntry> base_blobs;
+    std::unordered_map<std::string, std::size_t> change_of_file;
+    std::unordered_map<std::string, std::size_t> change_of_base;
+    for (std::size_t i = 0; i < changes->size(); ++i) {
+        const auto &change = (*changes)[i];
+        files.push_back((std::filesystem::path(repository) / change.path).lexically_normal().string());
+        change_of_file.emplace(files.back(), i);
+        if (change.base_object_id.empty())
+            continue;
+        base_blobs.push_back(git::BlobEntry{
+            .path = (std::filesystem::path(repository) / change.base_path).lexically_normal().string(),
+            .object_id = change.base_object_id});
+        change_of_base.emplace(base_blobs.back().path, i);
+    }
+
+    ChangeAnalysis result;
+    result.base = AnalyseBlobs(repository, base_blobs, metric_extractor, errors, jobs, resource, limits, cache);
+    auto current = AnalyseFunctionsParallel(files, metric_extractor, errors, jobs, resource, limits, profile);
+
+    // Ключ функции: номер изменения, имя с классом и номер среди одноимённых в файле
+    using FunctionKey = std::tuple<std::size_t, std::string, std::size_t>;
+    std::map<FunctionKey, std::size_t> base_of_key;
+    std::map<std::pair<std::size_t, std::string>, std::size_t> occurrences;
+    for (std::size_t i = 0; i < result.base.size(); ++i) {
+        const auto change = change_of_base.at(std::string(result.base[i].first.filename.View()));
+        auto name = function::QualifiedName(result.base[i].first);
+        const auto occurrence = occurrences[{change, name}]++;
+        base_of_key.emplace(FunctionKey{change, std::move(name), occurrence}, i);
+    }
+
+    occurrences.clear();
+    for (auto &entry : current) {
+        const auto change = change_of_file.at(std::string(entry.first.filename.View()));
+        auto name = function::QualifiedName(entry.first);
+        const auto occurrence = occurrences[{change, name}]++;
+
+        // Ханки отсортированы и не пересекаются: первый ханк, заканчивающийся после начала функции
+        const auto &lines = (*changes)[change].lines;
+        const auto hunk = rs::upper_bound(lines, entry.first.first_line, {}, &git::LineRange::last);
+        if (hunk == lines.end() || hunk->first >= entry.first.end_line)
+            continue;
+
+        const auto base = base_of_key.find(FunctionKey{change, std::move(name), occurrence});
+        result.base_index.push_back(base == base_of_key.end() ? std::nullopt : std::optional(base->second));
+        result.changed.push_back(std::move(entry));
+    }
+    return result;
+}
+
+// Поиск структурных клонов: файлы разбираются параллельно так же, как в AnalyseFunctionsParallel,
+// поддеревья каждого файла добавляются в общий индекс, а AST освобождается сразу после файла.
+// Ошибки разбора попадают в errors в порядке файлов
+inline std::vector<clones::CloneClass> FindClones(const std::vector<std::string> &files,
+                                                  const clones::CloneOptions &options, AnalysisErrors &errors,
+                                                  std::size_t jobs, const AnalysisLimits &limits = {},
+                                                  schedule::ScheduleProfile *profile = nullptr) {
+    const auto workers = std::clamp<std::size_t>(jobs, 1, std::max<std::size_t>(files.size(), 1));
+    std::vector<FileArena> scratch(workers);
+    std::vector<std::optional<AnalysisError>> file_errors(files.size());
+    const detail::RunBudget budget(limits);
+    clones::CloneIndex index(options);
+
+    const auto costs = files | rv::transform(schedule::EstimateFileCost) | rs::to<std::vector<std::uint64_t>>();
+    io::Prefetcher prefetcher(files, schedule::LongestFirstOrder(costs),
+                              io::MakeBatchReader(io::Backend::kAuto, workers));
+    const auto run_profile = schedule::RunLongestFirst(costs, workers, [&](std::size_t i, std::size_t worker) {
+        const auto parse_limits = budget.NextFileLimits();
+        if (!parse_limits) {
+            file_errors[i] = detail::SkippedByBudget(files[i]);
+            prefetcher.Stop();
+            return;
+        }
+        auto source = prefetcher.Take(i);
+        {
+            // File уничтожается до освобождения арены, из которой выделены его строки
+            auto file = file::File::Open(files[i], std::move(source), &scratch[worker], *parse_limits);
+            if (!file)
+                file_errors[i] = AnalysisError{.filename = files[i], .error = std::move(file.error())};
+            else if (auto added = index.AddFile(*file); !added)
+                file_errors[i] = AnalysisError{.filename = files[i], .error = std::move(added.error())};
+        }
+        scratch[worker].release();
+    });
+    if (profile)
+        *profile = run_profile;
+
+    for (auto &error : file_errors)
+        if (error)
+            errors.push_back(std::move(*error));
+    return index.Classes();
+}
+
+// Строит граф вызовов между всеми функциями analysis и дописывает каждой функции целочисленные метрики
+// fan_in, fan_out и unreferenced, которые агрегируются как обычные. Имена вызовов собраны FunctionExtractor
+// при разборе файлов, поэтому функции из кеша результатов рёбер не дают
+inline calls::CallGraph AppendCallGraphMetrics(FunctionAnalysis &analysis) {
+    const auto functions = analysis | rv::transform([](const FunctionAnalysisEntry &entry) { return &entry.first; })
+                           | rs::to<std::vector<const function::Function *>>();
+    calls::CallGraph graph(functions);
+
+    // Имя и id регистрируются один раз, в цикле меняется только значение
+    const auto make_template = [](std::string_view name) {
+        return metric::MetricResult{.metric_name = name, .metric_id = metric::RegisterMetricName(name), .value = 0};
+    };
+    const auto fan_in = make_template(calls::kFanInMetric);
+    const auto fan_out = make_template(calls::kFanOutMetric);
+    const auto unreferenced = make_template(calls::kUnreferencedMetric);
+    const auto with_value = [](metric::MetricResult result, std::size_t value) {
+        result.value = static_cast<int>(value);
+        return result;
+    };
+    for (std::size_t i = 0; i < analysis.size(); ++i) {
+        auto &metrics = analysis[i].second;
+        metrics.push_back(with_value(fan_in, graph.FanIn(i)));
+        metrics.push_back(with_value(fan_out, graph.FanOut(i)));
+        metrics.push_back(with_value(unreferenced, graph.Unreferenced(i) ? 1 : 0));
+    }
+    return graph;
+}
+
+// Потоковый вариант для долгих прогонов: весь анализ файла живёт в арене, которая освобождается
+// целиком после callback(analysis, errors), где errors — ошибки этого файла.
+// Ссылки на результаты нельзя сохранять после возврата из callback
+template <typename Callback>
+void ForEachFileAnalysis(const std::vector<std::string> &files,
+                         const analyzer::metric::MetricExtractor &metric_extractor, Callback &&callback,
+                         const AnalysisLimits &limits = {}) {
+    FileArena arena;
+    AnalysisErrors errors;
+    const detail::RunBudget budget(limits);
+    rs::for_each(files, [&](const std::string &filename) {
+        {
+            FunctionAnalysis analysis;
+            if (const auto parse_limits = budget.NextFileLimits())
+                analysis = AnalyseFile(filename, metric_extractor, &arena, &arena, errors, *parse_limits);
+            else
+                errors.push_back(detail::SkippedByBudget(filename));
+            callback(std::as_const(analysis), std::as_const(errors));
+        }
+        errors.clear();
+        arena.release();
+    });
+}
+
 auto SplitByClasses(const auto &analysis) {
     return detail::GroupByRange(
         analysis | rv::filter([](const auto &entry) { return static_cast<bool>(entry.first.class_name); }),
         [](const auto &entry) {
-            auto key = entry.first.filename;
-            key.push_back('\n');
-            key.append(*entry.first.class_name);
-            return key;
+            return interner::CombineIds(entry.first.filename.Id(), entry.first.class_name->Id());
         });
 }
 
 auto SplitByFiles(const auto &analysis) {
-    return detail::GroupByRange(analysis, [](const auto &entry) { return entry.first.filename; });
+    return detail::GroupByRange(analysis, [](const auto &entry) { return entry.first.filename.Id(); });
 }
 
 void AccumulateFunctionAnalysis(const auto &analysis,
                                 const analyzer::metric_accumulator::MetricsAccumulator &accumulator) {
-    rs::fold_left(analysis | rv::elements<1>, std::monostate{},
-                  [&accumulator](std::monostate state, const auto &metrics) {
-                      accumulator.AccumulateNextFunctionResults(metrics);
-                      return state;
-                  });
+    rs::fold_left(analysis, std::monostate{}, [&accumulator](std::monostate state, const auto &entry) {
+        accumulator.AccumulateNextFunctionResults(entry.first, entry.second);
+        return state;
+    });
+}
+
+// Колоночный вариант AccumulateFunctionAnalysis: значения каждой метрики уходят аккумулятору одной пачкой
+// вместе с функциями-источниками, порядок значений метрики тот же
+void AccumulateFunctionAnalysisBatch(const auto &analysis,
+                                     const analyzer::metric_accumulator::MetricsAccumulator &accumulator) {
+    accumulator.AccumulateFunctionAnalysisBatch(analysis);
 }
 
 }  // namespace analyzer
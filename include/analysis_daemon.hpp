@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "daemon_protocol.hpp"
+#include "error.hpp"
+#include "file.hpp"
+#include "git_source.hpp"
+#include "metric.hpp"
+#include "result_cache.hpp"
+
+namespace analyzer::daemon {
+
+// Долгоживущий демон анализа (режим --daemon). Метрики регистрируются один раз при старте, а результаты
+// кешируются по содержимому файла и набору метрик: повторный запрос неизменённого файла не запускает
+// tree-sitter. Каждое соединение читается своим потоком, а файлы всех клиентов разбирают общие workers
+// воркеров, поэтому одновременные клиенты не умножают число процессов tree-sitter
+class AnalysisDaemon {
+public:
+    // Бросает std::runtime_error, если не удалось создать каталог для буферов редактора
+    AnalysisDaemon(const analyzer::metric::MetricExtractor &metric_extractor, cache::ResultCache &cache,
+                   std::size_t workers, const file::ParseLimits &limits = {});
+    ~AnalysisDaemon();
+
+    AnalysisDaemon(const AnalysisDaemon &) = delete;
+    AnalysisDaemon &operator=(const AnalysisDaemon &) = delete;
+
+    // Сокет с правами только для владельца. Файл сокета, оставшийся от упавшего демона, удаляется;
+    // живой демон на том же пути или чужой файл — ошибка
+    Expected<void> Listen(const std::string &socket_path);
+
+    // Принимает клиентов до Stop и дожидается завершения их соединений
+    Expected<void> Serve();
+
+    // Можно вызывать из другого потока и из обработчика сигнала
+    void Stop();
+
+    // Ответ на запрос без сокета; потокобезопасен
+    Response Handle(const Request &request);
+
+private:
+    using Task = std::function<void(std::size_t worker)>;
+
+    struct Connection {
+        int fd;
+        std::atomic<bool> finished{false};
+        std::jthread thread;
+    };
+
+    void Submit(Task task);
+    void WorkerLoop(std::size_t worker);
+    void AnalyseItem(const RequestItem &item, ItemResult &result, std::pmr::memory_resource *scratch);
+    void ServeConnection(Connection &connection);
+    // Завершённые соединения; с all — закрывает и дожидается всех
+    void ReapConnections(bool all);
+
+    const analyzer::metric::MetricExtractor &metric_extractor_;
+    cache::ResultCache &cache_;
+    file::ParseLimits limits_;
+    git::TempDirectory buffers_;  // Буферы редактора: tree-sitter читает исходник с диска
+    std::atomic<std::size_t> next_buffer_{0};
+
+    std::mutex tasks_mutex_;
+    std::condition_variable tasks_ready_;
+    std::deque<Task> tasks_;
+    bool stopping_workers_ = false;
+    std::vector<std::pmr::monotonic_buffer_resource> scratch_;  // Арена разбора каждого воркера
+    std::vector<std::jthread> workers_;
+
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    int wake_pipe_[2] = {-1, -1};  // Stop пишет байт: write безопасен в обработчике сигнала
+    std::mutex connections_mutex_;
+    std::list<Connection> connections_;
+};
+
+}  // namespace analyzer::daemon
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "function.hpp"
+
+namespace analyzer::calls {
+
+// Метрики графа вызовов; unreferenced — 1 у функции, которую не вызывает ни одна другая
+inline constexpr std::string_view kFanInMetric = "fan_in";
+inline constexpr std::string_view kFanOutMetric = "fan_out";
+inline constexpr std::string_view kUnreferencedMetric = "unreferenced";
+
+// Граф вызовов между функциями всех файлов в формате CSR: вызываемые функцией i лежат в общем массиве рёбер
+// на отрезке [offsets[i], offsets[i + 1]). Вызов разрешается по имени из Function::callees: среди функций
+// файла вызывающей, а если там таких нет — среди функций всех файлов. Одноимённые кандидаты получают ребро
+// все, поэтому obj.get() связывается с каждым get. Рёбра без повторов, рекурсивный вызов ребра не даёт
+class CallGraph {
+public:
+    using FunctionIndex = std::uint32_t;
+
+    // functions[i] — вершина i. Бросает std::length_error, если функций больше, чем индексов
+    explicit CallGraph(std::span<const function::Function *const> functions);
+
+    std::size_t Size() const { return fan_in_.size(); }
+    std::size_t EdgeCount() const { return targets_.size(); }
+    // Вызываемые функции по возрастанию индекса
+    std::span<const FunctionIndex> Callees(std::size_t function) const {
+        return std::span(targets_).subspan(offsets_[function], FanOut(function));
+    }
+    std::size_t FanOut(std::size_t function) const { return offsets_[function + 1] - offsets_[function]; }
+    std::size_t FanIn(std::size_t function) const { return fan_in_[function]; }
+    // Точки входа, колбэки и функции, вызываемые только через getattr, тоже попадают сюда
+    bool Unreferenced(std::size_t function) const { return fan_in_[function] == 0; }
+
+private:
+    std::vector<std::size_t> offsets_;
+    std::vector<FunctionIndex> targets_;
+    std::vector<std::size_t> fan_in_;
+};
+
+}  // namespace analyzer::calls
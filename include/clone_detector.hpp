@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "error.hpp"
+#include "file.hpp"
+#include "interner.hpp"
+
+namespace analyzer::clones {
+
+struct CloneOptions {
+    std::size_t min_nodes = 30;          // Поддеревья меньше порога (в узлах AST) не рассматриваются
+    bool normalize_identifiers = false;  // Имена не различаются: находятся и копии с переименованием
+};
+
+// Позиции с нуля, как в AST tree-sitter; end — позиция сразу после поддерева
+struct SourcePosition {
+    std::size_t line = 0;
+    std::size_t column = 0;
+
+    auto operator<=>(const SourcePosition &) const = default;
+};
+
+struct CloneLocation {
+    interner::InternedString filename;
+    interner::InternedString node_type;
+    SourcePosition start;
+    SourcePosition end;
+};
+
+// Одинаковые поддеревья; копии, целиком лежащие в копиях большего класса, отдельно не сообщаются
+struct CloneClass {
+    std::uint64_t hash = 0;
+    std::size_t nodes = 0;
+    std::vector<CloneLocation> locations;  // По файлу и позиции
+};
+
+// Индекс поддеревьев по структурному хешу. Хеш считается снизу вверх за один проход по тексту AST:
+// хеш узла — его тип, поле в родителе, текст листа из исходника и хеши детей по порядку, поэтому
+// разбор файла линеен по размеру AST. Таблица разбита на шарды со своими мьютексами, и файлы
+// добавляются из разных воркеров параллельно
+class CloneIndex {
+public:
+    explicit CloneIndex(CloneOptions options = {}) : options_(options) {}
+
+    // Потокобезопасен. Ошибка kParse, если AST не разбирается; тогда в индекс ничего не попадает
+    Expected<void> AddFile(const file::File &file);
+    // То же для текста AST tree-sitter и строк исходника без перевода строки
+    Expected<void> AddTree(const std::string &filename, std::string_view ast,
+                           std::span<const std::pmr::string> source_lines);
+
+    // Классы по убыванию размера поддерева, затем числа копий. Вызывается после всех AddFile
+    std::vector<CloneClass> Classes() const;
+
+private:
+    struct Occurrence {
+        std::uint64_t parent_hash;  // 0 у корня файла
+        std::size_t nodes;
+        CloneLocation location;
+    };
+
+    static constexpr std::size_t kShards = 64;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::vector<Occurrence>> buckets;
+    };
+
+    static std::size_t ShardOf(std::uint64_t hash) { return hash >> 58; }
+
+    CloneOptions options_;
+    std::array<Shard, kShards> shards_;
+};
+
+}  // namespace analyzer::clones
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -16,14 +18,78 @@ public:
     bool Parse(int argc, char *argv[]);
 
     const std::vector<std::string> &GetFiles() const { return files_; }
+    const std::vector<std::string> &GetDirectories() const { return directories_; }
+    const std::vector<std::string> &GetExcludePatterns() const { return exclude_; }
+    // Источники списков путей из --files-from и @file; "-" — stdin. Читаются во время анализа
+    const std::vector<std::string> &GetFileLists() const { return file_lists_; }
+    // Пустая строка — анализ рабочего дерева
+    const std::string &GetGitRevision() const { return git_revision_; }
+    // Базовая ревизия для анализа только изменённых функций; пустая строка — обычный анализ
+    const std::string &GetChangedSince() const { return changed_since_; }
+    // Пустой путь — кеш только в памяти текущего запуска
+    const std::string &GetCacheDirectory() const { return cache_directory_; }
+    // Пустой путь — мемоизация метрик только в памяти текущего запуска
+    const std::string &GetMemoFile() const { return memo_file_; }
+    // Сколько записей кеш результатов и мемоизация держат в памяти; 0 — без ограничения
+    std::size_t GetCacheEntries() const { return cache_entries_; }
+    std::size_t GetMemoEntries() const { return memo_entries_; }
+    bool GitignoreEnabled() const { return !ignore_gitignore_; }
     bool IsHelpRequested() const { return help_requested_; }
     bool DebugEnabled() const { return debug_enabled_; }
+    std::size_t GetTopCount() const { return top_count_; }
+    // Нулевые значения означают отсутствие ограничения
+    std::chrono::milliseconds GetParseTimeout() const { return std::chrono::milliseconds(parse_timeout_ms_); }
+    std::size_t GetMaxAstBytes() const { return max_ast_bytes_; }
+    std::chrono::milliseconds GetTimeBudget() const { return std::chrono::milliseconds(time_budget_ms_); }
+    // 0 в командной строке заменяется числом аппаратных потоков
+    std::size_t GetJobs() const { return jobs_; }
+    bool ProfileEnabled() const { return profile_enabled_; }
+    bool WatchEnabled() const { return watch_enabled_; }
+    // Режим поиска клонов: вместо метрик печатаются классы одинаковых поддеревьев AST
+    bool ClonesEnabled() const { return clones_enabled_; }
+    std::size_t GetCloneMinNodes() const { return clone_min_nodes_; }
+    bool CloneNormalizeIdentifiers() const { return clone_normalize_identifiers_; }
+    // Метрики fan_in, fan_out и unreferenced по графу вызовов между всеми входными файлами
+    bool CallGraphEnabled() const { return call_graph_enabled_; }
+    // Сокет режима демона; пустая строка — обычный запуск
+    const std::string &GetDaemonSocket() const { return daemon_socket_; }
+    // Сокет демона для тонкого клиента; пустая строка — анализ в этом процессе
+    const std::string &GetConnectSocket() const { return connect_socket_; }
+    // Имя, под которым stdin отправляется демону как буфер редактора; пустая строка — stdin не читается
+    const std::string &GetStdinName() const { return stdin_name_; }
 
 private:
+    // Позиционные аргументы: @file — список путей, каталоги обходятся рекурсивно, остальное считается файлами
+    void AddInputPaths(const std::vector<std::string> &paths);
+
     std::vector<std::string> files_;
+    std::vector<std::string> directories_;
+    std::vector<std::string> exclude_;
+    std::vector<std::string> file_lists_;
+    std::string git_revision_;
+    std::string changed_since_;
+    std::string cache_directory_;
+    std::string memo_file_;
+    std::string daemon_socket_;
+    std::string connect_socket_;
+    std::string stdin_name_;
     boost::program_options::options_description desc_;
     bool help_requested_ = false;
     bool debug_enabled_ = false;
+    std::size_t top_count_ = 10;
+    std::size_t parse_timeout_ms_ = 0;
+    std::size_t max_ast_bytes_ = 0;
+    std::size_t time_budget_ms_ = 0;
+    std::size_t jobs_ = 0;
+    std::size_t cache_entries_ = 4096;
+    std::size_t memo_entries_ = 1 << 20;
+    bool profile_enabled_ = false;
+    bool watch_enabled_ = false;
+    bool clones_enabled_ = false;
+    std::size_t clone_min_nodes_ = 30;
+    bool clone_normalize_identifiers_ = false;
+    bool call_graph_enabled_ = false;
+    bool ignore_gitignore_ = false;
 };
 
 }  // namespace analyzer::cmd
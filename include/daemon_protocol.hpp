@@ -0,0 +1,60 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.hpp"
+#include "result_cache.hpp"
+
+namespace analyzer::daemon {
+
+// Двоичный протокол демона анализа поверх Unix-сокета. Сообщение — кадр: длина (u32, little-endian)
+// и тело. Тело начинается с байта версии; числа фиксированной ширины little-endian, строки — u32 длины
+// и байты. Клиент шлёт запрос и получает один ответ; по соединению можно отправить несколько запросов
+
+// Файл запроса. Без content демон сам читает name как путь (в своём рабочем каталоге, поэтому клиенту
+// лучше слать абсолютные пути); с content — несохранённый буфер редактора, name используется только
+// в отчёте и для расширения
+struct RequestItem {
+    std::string name;
+    std::optional<std::string> content;
+};
+
+struct Request {
+    std::vector<RequestItem> items;
+};
+
+// Ошибка файла (function и metric_name пусты) или одной метрики функции
+struct ErrorRecord {
+    std::string function;
+    std::string metric_name;
+    ErrorCode code;
+    std::string message;
+};
+
+// Результат одного файла запроса; items ответа идут в порядке items запроса
+struct ItemResult {
+    cache::CachedFile result;
+    std::vector<ErrorRecord> errors;
+};
+
+struct Response {
+    std::vector<ItemResult> items;
+};
+
+std::string EncodeRequest(const Request &request);
+std::string EncodeResponse(const Response &response);
+// nullopt на повреждённом теле или другой версии протокола
+std::optional<Request> DecodeRequest(std::string_view payload);
+std::optional<Response> DecodeResponse(std::string_view payload);
+
+// Кадр целиком; ошибка kIo при разрыве соединения посреди кадра, nullopt — соединение закрыто между кадрами
+Expected<std::optional<std::string>> ReadFrame(int fd);
+Expected<void> WriteFrame(int fd, std::string_view payload);
+
+// Тонкий клиент: подключение к демону, один запрос и ответ
+Expected<Response> Call(const std::string &socket_path, const Request &request);
+
+}  // namespace analyzer::daemon
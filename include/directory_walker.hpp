@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.hpp"
+#include "path_queue.hpp"
+
+namespace analyzer::walk {
+
+// Сопоставление в стиле .gitignore: * и ? не переходят через '/', ** — любое число каталогов, [...] — класс
+bool GlobMatch(std::string_view pattern, std::string_view text);
+
+// Правила исключения в стиле .gitignore. Ведущий '/' или '/' внутри шаблона привязывает его к каталогу
+// правил, иначе шаблон сравнивается с именем на любой глубине; завершающий '/' — только каталоги;
+// '!' отменяет исключение. Побеждает последнее совпавшее правило
+class IgnoreRules {
+public:
+    // base — каталог, в котором действует правило, относительно корня обхода; "" — сам корень
+    void Add(std::string_view pattern, std::string_view base = {});
+    // Строки файла .gitignore; пустые строки и комментарии пропускаются
+    void AddFile(std::string_view content, std::string_view base);
+    // relative — путь относительно корня обхода с разделителем '/'
+    bool IsIgnored(std::string_view relative, bool is_directory) const;
+
+private:
+    struct Rule {
+        std::string pattern;
+        std::string base;
+        bool negated = false;
+        bool directory_only = false;
+        bool anchored = false;
+    };
+
+    std::vector<Rule> rules_;
+};
+
+struct WalkOptions {
+    std::vector<std::string> extensions{".py"};
+    std::vector<std::string> exclude;  // Шаблоны относительно каждого корня, действуют вместе с .gitignore
+    bool read_gitignore = true;
+    std::size_t threads = 1;
+};
+
+struct WalkError {
+    std::string path;
+    Error error;
+};
+
+// Обходит корни в options.threads потоков и кладёт подходящие файлы в paths по мере обнаружения,
+// не дожидаясь конца обхода. Корень-файл добавляется как есть. Символические ссылки на каталоги
+// не раскрываются, каталоги .git пропускаются. Очередь не закрывается: в неё могут писать другие источники
+std::vector<WalkError> Walk(const std::vector<std::string> &roots, const WalkOptions &options, PathQueue &paths);
+
+}  // namespace analyzer::walk
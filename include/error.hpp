@@ -0,0 +1,50 @@
+#pragma once
+
+#include <expected>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace analyzer {
+
+enum class ErrorCode {
+    kIo,          // Файл не открывается или не читается
+    kToolFailed,  // tree-sitter не запустился или завершился с ошибкой
+    kParse,       // Неожиданный формат AST или исходника
+    kTimeout,     // tree-sitter не уложился в отведённое время и был остановлен
+    kTooLarge,    // Вывод tree-sitter превысил лимит
+    kSkipped,     // Файл не начат: исчерпан общий бюджет времени
+};
+
+// Ошибка горячего пути: возвращается через std::expected без раскрутки стека
+struct Error {
+    ErrorCode code;
+    std::string message;
+};
+
+template <typename T>
+using Expected = std::expected<T, Error>;
+
+inline std::unexpected<Error> MakeError(ErrorCode code, std::string message) {
+    return std::unexpected(Error{code, std::move(message)});
+}
+
+constexpr std::string_view ToString(ErrorCode code) {
+    switch (code) {
+        case ErrorCode::kIo:
+            return "io";
+        case ErrorCode::kToolFailed:
+            return "tool";
+        case ErrorCode::kParse:
+            return "parse";
+        case ErrorCode::kTimeout:
+            return "timeout";
+        case ErrorCode::kTooLarge:
+            return "too-large";
+        case ErrorCode::kSkipped:
+            return "skipped";
+    }
+    return "unknown";
+}
+
+}  // namespace analyzer
@@ -1,25 +1,55 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <ranges>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "error.hpp"
+#include "source_reader.hpp"
+
 namespace analyzer::file {
 
+// Ограничения одного запуска tree-sitter; нулевое значение — без ограничения.
+// При превышении процесс убивается вместе со своей группой, файл возвращается как ошибка
+struct ParseLimits {
+    std::chrono::milliseconds timeout{0};
+    std::size_t max_output_bytes = 0;
+};
+
 struct File {
-    static inline const std::string command_prefix =
-        "tree-sitter parse --config-path /root/.config/tree-sitter/config.json ";
-    File(const std::string &filename);
+    // Команда разбора без оболочки: программа ищется в PATH, имя файла добавляется последним аргументом.
+    // Тесты подменяют её; менять можно только пока файлы не разбираются
+    static inline std::vector<std::string> command = {"tree-sitter", "parse", "--config-path",
+                                                      "/root/.config/tree-sitter/config.json"};
+    // AST и строки исходника выделяются из resource, например из арены файла.
+    // Бросает std::runtime_error, если файл не читается или tree-sitter завершился с ошибкой
+    File(const std::string &filename, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+    // То же без исключений: ошибка возвращается вызывающему, чтобы прогон мог пропустить файл
+    static Expected<File> Open(const std::string &filename,
+                               std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                               const ParseLimits &limits = {});
+    // Разбор уже прочитанного исходника, например из io::Prefetcher; ошибка чтения возвращается как есть
+    static Expected<File> Open(const std::string &filename, io::Source source,
+                               std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                               const ParseLimits &limits = {});
     std::string name;
-    std::string ast;
-    std::vector<std::string> source_lines;
+    std::pmr::string ast;
+    std::pmr::vector<std::pmr::string> source_lines;
 
 private:
-    std::vector<std::string> ReadSourceFile(std::ifstream &file);
-    std::string GetAst(const std::string &filename);
+    explicit File(std::pmr::memory_resource *resource);
+
+    static std::pmr::vector<std::pmr::string> SplitSourceLines(std::string_view source,
+                                                               std::pmr::memory_resource *resource);
+    static Expected<std::pmr::string> GetAst(const std::string &filename, const ParseLimits &limits,
+                                             std::pmr::memory_resource *resource);
 };
 
 }  // namespace analyzer::file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "error.hpp"
+
+namespace analyzer::watch {
+
+// Файлы, затронутые за один Wait, без повторов в порядке первого события
+struct Changes {
+    std::vector<std::string> paths;
+    // Удалённые и унесённые из дерева каталоги: все файлы под ними исчезли. Ядро не сообщает о файлах
+    // внутри такого каталога, поэтому известные файлы под префиксом удаляет вызывающий
+    std::vector<std::string> removed_directories;
+    // Очередь событий ядра переполнилась и часть изменений потеряна: состояние нужно пересобрать целиком
+    bool overflowed = false;
+    // Новые каталоги, за которыми не удалось начать следить, например при исчерпании лимита inotify.
+    // Их файлы попадают в paths, но следующие изменения в них не будут замечены
+    std::vector<Error> warnings;
+};
+
+// Слежение за каталогами через inotify. Следим за каталогами, а не за файлами: редакторы сохраняют файл
+// через запись во временный и rename, после чего наблюдение за старым inode бесполезно. Не потокобезопасен
+class Watcher {
+public:
+    static Expected<std::unique_ptr<Watcher>> Create();
+    ~Watcher();
+
+    Watcher(const Watcher &) = delete;
+    Watcher &operator=(const Watcher &) = delete;
+
+    // С recursive следит и за подкаталогами, включая созданные позже; каталоги .git пропускаются.
+    // Подкаталог, исчезнувший во время обхода, пропускается
+    Expected<void> WatchDirectory(const std::string &directory, bool recursive);
+
+    // Ждёт первого изменения, затем ещё settle собирает следующие: сохранение в редакторе — несколько событий.
+    // Пути — каталог из WatchDirectory и имя файла; созданные, изменённые, удалённые и переименованные файлы
+    Expected<Changes> Wait(std::chrono::milliseconds settle = std::chrono::milliseconds(50));
+
+private:
+    explicit Watcher(int fd) : fd_(fd) {}
+
+    struct WatchedDirectory {
+        std::string path;
+        bool recursive;
+    };
+
+    // false, если событий не было за timeout; отрицательный timeout — ждать без ограничения
+    Expected<bool> ReadEvents(int timeout_ms, Changes &changes);
+    // Снимает наблюдение с каталога и всех наблюдаемых каталогов под ним
+    void Unwatch(const std::string &directory);
+
+    int fd_;
+    std::unordered_map<int, WatchedDirectory> directories_;  // Дескриптор наблюдения -> каталог
+};
+
+}  // namespace analyzer::watch
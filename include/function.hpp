@@ -10,13 +10,19 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "error.hpp"
 #include "file.hpp"
+#include "interner.hpp"
 
 namespace fs = std::filesystem;
 namespace rv = std::ranges::views;
@@ -24,15 +30,45 @@ namespace rs = std::ranges;
 
 namespace analyzer::function {
 
+// Имена файла и класса интернированы и сравниваются по id. Строки pmr при перемещении сохраняют ресурс,
+// из которого выделены, например арену файла
 struct Function {
-    std::string filename;
-    std::optional<std::string> class_name;
-    std::string name;
-    std::string ast;
+    interner::InternedString filename;
+    std::optional<interner::InternedString> class_name;
+    std::pmr::string name;
+    std::pmr::string ast;
+    // Строки исходника из File: метрики не перечитывают файл. Действительны, пока жив File, поэтому
+    // после вычисления метрик сбрасываются; пустой span — метрика читает файл сама
+    std::span<const std::pmr::string> source_lines;
+    // Строки определения с нуля, полуинтервал [first_line, end_line); декораторы не входят.
+    // У функций из кеша результатов оба нуля
+    std::size_t first_line = 0;
+    std::size_t end_line = 0;
+    // Имена вызываемых функций по порядку вызовов, с повторами; у obj.method() — method.
+    // Вызовы выражений вроде f()() и handlers[i]() имени не имеют и пропускаются. Пусто у функций из кеша
+    // и если FunctionExtractor::collect_callees выключен
+    std::pmr::vector<interner::InternedString> callees;
 };
 
+// Имя с классом через точку, например Alpha.second; у свободной функции — просто имя
+inline std::string QualifiedName(const Function &func) {
+    std::string name;
+    if (func.class_name)
+        name.append(func.class_name->View()).push_back('.');
+    name.append(func.name);
+    return name;
+}
+
 struct FunctionExtractor {
-    std::vector<Function> Get(const analyzer::file::File &file);
+    // Заполнять Function::callees; нужно только графу вызовов, поэтому по умолчанию выключено
+    bool collect_callees = false;
+
+    // Функции и их строки выделяются из resource. Бросает std::runtime_error на некорректном AST
+    std::pmr::vector<Function> Get(const analyzer::file::File &file,
+                                   std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+    // То же без исключений: некорректные координаты в AST возвращаются как ошибка файла
+    Expected<std::pmr::vector<Function>> TryGet(const analyzer::file::File &file,
+                                                std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
 private:
     struct Position {
@@ -52,10 +88,20 @@ private:
         Position end;
     };
 
-    FunctionNameLocation GetNameLocation(const std::string &function_ast);
-    std::string GetNameFromSource(const std::string &function_ast, const std::vector<std::string> &lines);
-    std::optional<ClassInfo> FindEnclosingClass(const std::string &ast, const FunctionNameLocation &func_loc);
-    std::string GetClassNameFromSource(const ClassInfo &class_info, const std::vector<std::string> &lines);
+    using SourceLines = std::pmr::vector<std::pmr::string>;
+
+    // coords — содержимое квадратных скобок вида "3, 4"
+    static Expected<Position> ParsePosition(std::string_view coords);
+
+    // Начало и конец узла function_definition по его первой строке в AST
+    Expected<std::pair<Position, Position>> GetDefinitionRange(std::string_view function_ast);
+    Expected<FunctionNameLocation> GetNameLocation(std::string_view function_ast);
+    std::string_view GetNameFromSource(const FunctionNameLocation &loc, const SourceLines &lines);
+    // Вызовы, имя которых не удалось разобрать, пропускаются: граф вызовов приблизителен и без них
+    std::pmr::vector<interner::InternedString> GetCallees(std::string_view function_ast, const SourceLines &lines,
+                                                          std::pmr::memory_resource *resource);
+    Expected<std::optional<ClassInfo>> FindEnclosingClass(std::string_view ast, const FunctionNameLocation &func_loc);
+    std::string_view GetClassNameFromSource(const ClassInfo &class_info, const SourceLines &lines);
 };
 
 }  // namespace analyzer::function
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.hpp"
+
+namespace analyzer::git {
+
+// Файл ревизии: путь от корня репозитория и id blob-а с его содержимым
+struct BlobEntry {
+    std::string path;
+    std::string object_id;
+};
+
+// Файлы ревизии rev (коммит, тег, ветка) с подходящими расширениями через git ls-tree -r -z;
+// рабочее дерево не читается
+Expected<std::vector<BlobEntry>> ListBlobs(const std::string &rev,
+                                           const std::vector<std::string> &extensions = {".py"},
+                                           const std::string &repository = ".");
+
+// Строки файла с нуля, полуинтервал [first, last)
+struct LineRange {
+    std::size_t first;
+    std::size_t last;
+};
+
+// Файл, изменённый относительно базовой ревизии. Пути относительно repository; base_object_id пуст
+// у файла, которого в базе не было. lines — изменённые строки новой версии по возрастанию
+struct FileChange {
+    std::string path;
+    std::string base_path;
+    std::string base_object_id;
+    std::vector<LineRange> lines;
+};
+
+// Файлы рабочего дерева с подходящими расширениями, изменённые относительно base, по ханкам git diff -U0.
+// Удаление строк отмечает строки по обе стороны от него; удалённые файлы и файлы без ханков пропускаются,
+// неотслеживаемые файлы git diff не видит
+Expected<std::vector<FileChange>> ChangedFiles(const std::string &base,
+                                               const std::vector<std::string> &extensions = {".py"},
+                                               const std::string &repository = ".");
+
+// Долгоживущий git cat-file --batch: содержимое объектов читается запросами к одному процессу,
+// без запуска git на каждый файл. Не потокобезопасен
+class CatFileBatch {
+public:
+    static Expected<std::unique_ptr<CatFileBatch>> Start(const std::string &repository = ".");
+    ~CatFileBatch();
+
+    CatFileBatch(const CatFileBatch &) = delete;
+    CatFileBatch &operator=(const CatFileBatch &) = delete;
+
+    Expected<std::string> Read(std::string_view object_id);
+
+private:
+    CatFileBatch(pid_t pid, int input, int output) : pid_(pid), input_(input), output_(output) {}
+
+    Expected<std::string> ReadLine();
+    Expected<std::string> ReadExact(std::size_t size);
+    bool Fill();
+
+    pid_t pid_;
+    int input_;   // stdin процесса git
+    int output_;  // stdout процесса git
+    std::string buffer_;
+    std::size_t buffer_pos_ = 0;
+};
+
+// Временный каталог, удаляется вместе с содержимым в деструкторе
+class TempDirectory {
+public:
+    static Expected<TempDirectory> Create(std::string_view prefix);
+    ~TempDirectory();
+
+    TempDirectory(TempDirectory &&other) noexcept : path_(std::move(other.path_)) { other.path_.clear(); }
+    TempDirectory &operator=(TempDirectory &&) = delete;
+
+    const std::filesystem::path &Path() const { return path_; }
+
+private:
+    explicit TempDirectory(std::filesystem::path path) : path_(std::move(path)) {}
+
+    std::filesystem::path path_;
+};
+
+}  // namespace analyzer::git
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "function.hpp"
+#include "metric.hpp"
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator {
+
+// Уровень группировки: KeyBuilder записывает ключ группы и возвращает false,
+// если функция в этот уровень не попадает (например, функция вне класса).
+// Ключ строится из id интернированных строк, поэтому поиск группы — хеширование одного целого.
+struct GroupingLevel {
+    using Key = std::uint64_t;
+    using KeyBuilder = std::function<bool(const function::Function &, Key &)>;
+    std::string name;
+    KeyBuilder build_key;
+};
+
+GroupingLevel GlobalLevel();
+GroupingLevel FileLevel();
+GroupingLevel ClassLevel();
+
+// Агрегирует метрики сразу на всех уровнях группировки за один проход по результатам анализа.
+// Состояние аккумуляторов хранится по значению в плоском векторе уровня: группа g, метрика m -> g * M + m.
+template <typename Accumulator>
+class GroupedAccumulator {
+    static_assert(std::is_base_of_v<IAccumulator, Accumulator>, "Accumulator must derive from IAccumulator");
+    static_assert(std::is_default_constructible_v<Accumulator>, "Accumulator must be default constructible");
+
+public:
+    struct Group {
+        GroupingLevel::Key key;
+        // Первая функция группы; указывает в переданный анализ. После Retract может быть nullptr,
+        // пока в группу не добавлена новая функция
+        const function::Function *representative;
+        std::size_t functions = 0;  // Число функций в группе; группа, ставшая пустой после Retract, остаётся
+    };
+
+    GroupedAccumulator(std::vector<std::string> metric_names, std::vector<GroupingLevel> levels)
+        : metric_names_(std::move(metric_names)) {
+        if (metric_names_.empty())
+            throw std::invalid_argument("GroupedAccumulator requires at least one metric");
+        for (std::size_t column = 0; column < metric_names_.size(); ++column) {
+            const auto id = metric::RegisterMetricName(metric_names_[column]);
+            if (id >= column_by_id_.size())
+                column_by_id_.resize(id + 1, kNoColumn);
+            column_by_id_[id] = column;
+        }
+        levels_.reserve(levels.size());
+        for (auto &level : levels) {
+            if (!level.build_key)
+                throw std::invalid_argument("Grouping level '" + level.name + "' has no key builder");
+            levels_.push_back(LevelState{.level = std::move(level)});
+        }
+    }
+
+    // Целочисленные значения каждого слота копятся в столбец и передаются аккумулятору одним
+    // AccumulateFunctionBatch после прохода; порядок значений в слоте тот же, что при построчном накоплении
+    void Accumulate(const auto &analysis) {
+        std::vector<std::pair<std::size_t, const metric::MetricResult *>> columns;
+        columns.reserve(metric_names_.size());
+        std::vector<std::vector<ValueColumn>> pending(levels_.size());
+        GroupingLevel::Key key = 0;
+
+        for (const auto &[func, results] : analysis) {
+            if (!CollectColumns(results, columns))
+                continue;
+
+            for (std::size_t level = 0; level < levels_.size(); ++level) {
+                auto &state = levels_[level];
+                if (!state.level.build_key(func, key))
+                    continue;
+                const auto group = FindOrAddGroup(state, key, &func);
+                if (!state.groups[group].representative)
+                    state.groups[group].representative = &func;
+                ++state.groups[group].functions;
+                pending[level].resize(state.slots.size());
+                for (const auto &[column, result] : columns) {
+                    const auto slot = group * metric_names_.size() + column;
+                    pending[level][slot].Append(state.slots[slot], &func, *result);
+                }
+            }
+        }
+
+        for (std::size_t level = 0; level < levels_.size(); ++level)
+            for (std::size_t slot = 0; slot < pending[level].size(); ++slot)
+                pending[level][slot].FlushInto(levels_[level].slots[slot]);
+    }
+
+    // Снимает функции, ранее переданные в Accumulate, тем же объектом analysis: обновление файла в долгом
+    // прогоне — Retract старых результатов и Accumulate новых. Аккумулятор должен поддерживать Retract
+    void Retract(const auto &analysis) {
+        std::vector<std::pair<std::size_t, const metric::MetricResult *>> columns;
+        columns.reserve(metric_names_.size());
+        GroupingLevel::Key key = 0;
+
+        for (const auto &[func, results] : analysis) {
+            if (!CollectColumns(results, columns))
+                continue;
+
+            for (auto &state : levels_) {
+                if (!state.level.build_key(func, key))
+                    continue;
+                const auto it = state.index.find(key);
+                if (it == state.index.end() || state.groups[it->second].functions == 0)
+                    throw std::invalid_argument("Cannot retract a function that was not accumulated");
+                auto &group = state.groups[it->second];
+                --group.functions;
+                if (group.representative == &func)
+                    group.representative = nullptr;
+                for (const auto &[column, result] : columns)
+                    state.slots[it->second * metric_names_.size() + column].Retract(*result);
+            }
+        }
+    }
+
+    // Сливает частичный результат другого потока; порядок групп как при последовательном проходе "this, затем other".
+    // Группы other, ставшие пустыми после Retract, пропускаются. Слияние с самим собой запрещено: FindOrAddGroup
+    // может переаллоцировать группы, по которым идёт цикл
+    void Merge(const GroupedAccumulator &other) {
+        if (&other == this)
+            throw std::invalid_argument("Cannot merge GroupedAccumulator with itself");
+        if (other.metric_names_ != metric_names_ || other.levels_.size() != levels_.size())
+            throw std::invalid_argument("Cannot merge GroupedAccumulator with different configuration");
+
+        const auto metrics = metric_names_.size();
+        for (std::size_t level = 0; level < levels_.size(); ++level) {
+            auto &state = levels_[level];
+            const auto &other_state = other.levels_[level];
+            for (std::size_t group = 0; group < other_state.groups.size(); ++group) {
+                const auto &other_group = other_state.groups[group];
+                if (other_group.functions == 0)
+                    continue;
+                const auto target = FindOrAddGroup(state, other_group.key, other_group.representative);
+                state.groups[target].functions += other_group.functions;
+                if (!state.groups[target].representative)
+                    state.groups[target].representative = other_group.representative;
+                for (std::size_t metric = 0; metric < metrics; ++metric)
+                    state.slots[target * metrics + metric].Merge(other_state.slots[group * metrics + metric]);
+            }
+        }
+    }
+
+    std::size_t LevelsCount() const { return levels_.size(); }
+
+    const GroupingLevel &GetLevel(std::size_t level) const { return levels_.at(level).level; }
+
+    const std::vector<Group> &GetGroups(std::size_t level) const { return levels_.at(level).groups; }
+
+    const std::vector<std::string> &GetMetricNames() const { return metric_names_; }
+
+    std::optional<std::size_t> FindGroup(std::size_t level, GroupingLevel::Key key) const {
+        const auto &index = levels_.at(level).index;
+        const auto it = index.find(key);
+        return it == index.end() ? std::nullopt : std::optional(it->second);
+    }
+
+    // Завершённая копия: сам аккумулятор остаётся открытым для Accumulate и Retract
+    Accumulator GetFinalizedCopy(std::size_t level, std::size_t group, std::size_t metric) const {
+        const auto &state = levels_.at(level);
+        if (group >= state.groups.size() || metric >= metric_names_.size())
+            throw std::out_of_range("GroupedAccumulator slot is out of range");
+        auto acc = state.slots[group * metric_names_.size() + metric];
+        acc.Finalize();
+        return acc;
+    }
+
+    const Accumulator &GetFinalizedAccumulator(std::size_t level, std::size_t group, std::size_t metric) {
+        auto &state = levels_.at(level);
+        if (group >= state.groups.size() || metric >= metric_names_.size())
+            throw std::out_of_range("GroupedAccumulator slot is out of range");
+        auto &acc = state.slots[group * metric_names_.size() + metric];
+        acc.Finalize();
+        return acc;
+    }
+
+    void Reset() {
+        for (auto &state : levels_) {
+            state.groups.clear();
+            state.index.clear();
+            state.slots.clear();
+        }
+    }
+
+private:
+    struct LevelState {
+        GroupingLevel level;
+        std::vector<Group> groups;
+        std::unordered_map<GroupingLevel::Key, std::size_t> index;
+        std::vector<Accumulator> slots;
+    };
+
+    static constexpr std::size_t kNoColumn = std::numeric_limits<std::size_t>::max();
+
+    std::size_t FindColumn(const metric::MetricResult &result) const {
+        const auto id = result.metric_id != metric::kUnknownMetricId
+                            ? result.metric_id
+                            : metric::ResolveMetricId(result).value_or(metric::kUnknownMetricId);
+        return id < column_by_id_.size() ? column_by_id_[id] : kNoColumn;
+    }
+
+    // Столбцы метрик функции, которые агрегирует этот аккумулятор; false, если таких нет
+    bool CollectColumns(const auto &results,
+                        std::vector<std::pair<std::size_t, const metric::MetricResult *>> &columns) const {
+        columns.clear();
+        for (const auto &result : results)
+            if (auto column = FindColumn(result); column != kNoColumn)
+                columns.emplace_back(column, &result);
+        return !columns.empty();
+    }
+
+    std::size_t FindOrAddGroup(LevelState &state, GroupingLevel::Key key, const function::Function *representative) {
+        if (auto it = state.index.find(key); it != state.index.end())
+            return it->second;
+        const auto group = state.groups.size();
+        state.index.emplace(key, group);
+        state.groups.push_back(Group{.key = key, .representative = representative});
+        state.slots.resize(state.slots.size() + metric_names_.size());
+        return group;
+    }
+
+    std::vector<std::string> metric_names_;
+    std::vector<std::size_t> column_by_id_;  // id метрики -> столбец в строке аккумуляторов группы
+    std::vector<LevelState> levels_;
+};
+
+}  // namespace analyzer::metric_accumulator
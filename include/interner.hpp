@@ -0,0 +1,61 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace analyzer::interner {
+
+using StringId = std::uint32_t;
+
+// Глобальный потокобезопасный пул строк. Каждая строка хранится один раз до конца программы,
+// поэтому id и string_view стабильны и их можно передавать между потоками.
+// Пул разбит на шарды по хешу строки, у каждого шарда свой мьютекс.
+StringId Intern(std::string_view value);
+std::optional<StringId> Find(std::string_view value);
+// Бросает std::out_of_range для неизвестного id
+std::string_view Lookup(StringId id);
+
+namespace detail {
+std::pair<StringId, std::string_view> InternWithView(std::string_view value);
+}  // namespace detail
+
+// Ключ из пары id, например (файл, класс)
+constexpr std::uint64_t CombineIds(StringId high, StringId low) { return (std::uint64_t{high} << 32) | low; }
+
+// Интернированная строка: сравнение и хеширование по id, текст доступен через View() без блокировок
+class InternedString {
+public:
+    InternedString() = default;
+
+    template <typename String>
+        requires std::convertible_to<const String &, std::string_view>
+    InternedString(const String &value) {
+        std::tie(id_, view_) = detail::InternWithView(value);
+    }
+
+    StringId Id() const { return id_; }
+    std::string_view View() const { return view_; }
+    bool empty() const { return view_.empty(); }
+
+    friend bool operator==(const InternedString &lhs, const InternedString &rhs) { return lhs.id_ == rhs.id_; }
+
+    friend std::ostream &operator<<(std::ostream &out, const InternedString &value) { return out << value.view_; }
+
+private:
+    StringId id_ = 0;  // id пустой строки
+    std::string_view view_;
+};
+
+}  // namespace analyzer::interner
+
+template <>
+struct std::hash<analyzer::interner::InternedString> {
+    std::size_t operator()(const analyzer::interner::InternedString &value) const noexcept { return value.Id(); }
+};
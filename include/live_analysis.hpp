@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "analyse.hpp"
+#include "grouped_accumulator.hpp"
+#include "metric.hpp"
+#include "metric_accumulator_impl/sum_average_accumulator.hpp"
+
+namespace analyzer {
+
+// Анализ, который держится в памяти между изменениями файлов (режим --watch). Результаты каждого файла
+// живут в своей арене. При обновлении файла его старые результаты снимаются со сводных метрик (Retract),
+// новые добавляются, и старая арена освобождается: обновление стоит разбора одного файла
+class LiveAnalysis {
+public:
+    using Aggregates = metric_accumulator::GroupedAccumulator<
+        metric_accumulator::metric_accumulator_impl::SumAverageAccumulator>;
+
+    // Уровни Aggregates
+    static constexpr std::size_t kGlobalLevel = 0;
+    static constexpr std::size_t kFileLevel = 1;
+    static constexpr std::size_t kClassLevel = 2;
+
+    struct FileResults {
+        FunctionAnalysis analysis;
+        AnalysisErrors errors;
+    };
+
+    LiveAnalysis(const analyzer::metric::MetricExtractor &metric_extractor, std::vector<std::string> aggregated_metrics,
+                 const AnalysisLimits &limits = {})
+        : metric_extractor_(metric_extractor),
+          limits_(limits),
+          aggregates_(std::move(aggregated_metrics),
+                      {metric_accumulator::GlobalLevel(), metric_accumulator::FileLevel(),
+                       metric_accumulator::ClassLevel()}) {}
+
+    // Первичный параллельный анализ набора файлов; уже известные файлы заменяются
+    void Load(const std::vector<std::string> &files, std::size_t jobs) {
+        FileArena arena;
+        AnalysisErrors errors;
+        const auto analysis = AnalyseFunctionsParallel(files, metric_extractor_, errors, jobs, &arena, limits_);
+
+        std::unordered_map<std::string_view, std::unique_ptr<FileState>> loaded;
+        for (const auto &file : files)
+            loaded.try_emplace(file, std::make_unique<FileState>());
+        for (const auto &entry : analysis) {
+            auto &state = *loaded.at(entry.first.filename.View());
+            state.results.analysis.push_back(detail::CopyEntry(entry, &state.arena));
+        }
+        for (auto &error : errors)
+            if (auto it = loaded.find(error.filename.View()); it != loaded.end())
+                it->second->results.errors.push_back(std::move(error));
+
+        for (auto &[file, state] : loaded)
+            Replace(std::string(file), std::move(state));
+    }
+
+    // Повторный анализ файла после изменения; файл, которого больше нет на диске, удаляется из состояния.
+    // false, если файл не был известен и его нет на диске
+    bool Update(const std::string &path) {
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(path, error)) {
+            if (!files_.contains(path))
+                return false;
+            Replace(path, nullptr);
+            return true;
+        }
+
+        auto state = std::make_unique<FileState>();
+        FileArena scratch;
+        state->results.analysis = AnalyseFile(path, metric_extractor_, &scratch, &state->arena,
+                                              state->results.errors, limits_.parse);
+        Replace(path, std::move(state));
+        return true;
+    }
+
+    // nullptr, если файл неизвестен
+    const FileResults *Find(const std::string &path) const {
+        const auto it = files_.find(path);
+        return it == files_.end() ? nullptr : &it->second->results;
+    }
+
+    // Файлы по возрастанию пути
+    template <typename Callback>
+    void ForEachFile(Callback &&callback) const {
+        for (const auto &[path, state] : files_)
+            callback(path, state->results);
+    }
+
+    std::size_t FilesCount() const { return files_.size(); }
+
+    // Открытые аккумуляторы; значения читаются через GetFinalizedCopy
+    const Aggregates &GetAggregates() const { return aggregates_; }
+
+private:
+    struct FileState {
+        FileArena arena;  // Объявлена первой: результаты уничтожаются раньше неё
+        FileResults results;
+    };
+
+    void Replace(const std::string &path, std::unique_ptr<FileState> state) {
+        auto it = files_.find(path);
+        if (it != files_.end())
+            aggregates_.Retract(it->second->results.analysis);
+        if (!state) {
+            if (it != files_.end())
+                files_.erase(it);
+            return;
+        }
+        aggregates_.Accumulate(state->results.analysis);
+        if (it != files_.end())
+            it->second = std::move(state);
+        else
+            files_.emplace(path, std::move(state));
+    }
+
+    const analyzer::metric::MetricExtractor &metric_extractor_;
+    AnalysisLimits limits_;
+    std::map<std::string, std::unique_ptr<FileState>> files_;
+    Aggregates aggregates_;
+};
+
+}  // namespace analyzer
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace analyzer::cache {
+
+// Таблица с вытеснением давно не использованных записей: при вставке сверх capacity удаляется запись,
+// к которой дольше всего не обращались через Find или InsertOrAssign. Нулевая capacity — без ограничения.
+// Не потокобезопасна: владелец держит свой мьютекс
+template <typename Key, typename Value>
+class LruMap {
+public:
+    explicit LruMap(std::size_t capacity = 0) : capacity_(capacity) {}
+
+    // nullptr, если записи нет; найденная запись становится самой свежей
+    const Value *Find(const Key &key) {
+        const auto it = index_.find(key);
+        if (it == index_.end())
+            return nullptr;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    // Возвращает сохранённое значение
+    const Value &InsertOrAssign(const Key &key, Value value) {
+        if (const auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+        if (capacity_ > 0 && entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+        return entries_.front().second;
+    }
+
+    std::size_t Size() const { return entries_.size(); }
+    std::size_t Capacity() const { return capacity_; }
+
+    // От самой свежей записи к самой старой
+    template <typename Callback>
+    void ForEach(Callback &&callback) const {
+        for (const auto &[key, value] : entries_)
+            callback(key, value);
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    std::size_t capacity_;
+    Entries entries_;
+    std::unordered_map<Key, typename Entries::iterator> index_;
+};
+
+}  // namespace analyzer::cache
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <any>
 #include <array>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -11,13 +12,22 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "error.hpp"
 #include "function.hpp"
+#include "interner.hpp"
 
 namespace fs = std::filesystem;
 namespace rv = std::ranges::views;
@@ -25,30 +35,89 @@ namespace rs = std::ranges;
 
 namespace analyzer::metric {
 
+using MetricId = std::uint32_t;
+inline constexpr MetricId kUnknownMetricId = std::numeric_limits<MetricId>::max();
+
+// Глобальный реестр имён метрик: при первой регистрации имя получает маленький плотный id
+MetricId RegisterMetricName(std::string_view metric_name);
+std::optional<MetricId> FindMetricId(std::string_view metric_name);
+
 struct MetricResult {
     using ValueType = std::variant<int, std::string>;
-    std::string metric_name;  // Название метрики
-    ValueType value;          // Значение метрики
+    interner::InternedString metric_name;    // Название метрики
+    MetricId metric_id = kUnknownMetricId;  // Id метрики в реестре, если результат получен через IMetric
+    ValueType value;                         // Значение метрики
+};
+
+// Id результата; для результатов, собранных вручную, ищет имя в реестре
+std::optional<MetricId> ResolveMetricId(const MetricResult &metric_result);
+
+// Метрика, которую не удалось вычислить для функции
+struct MetricError {
+    interner::InternedString metric_name;
+    Error error;
 };
 
 struct IMetric {
     virtual ~IMetric() = default;
+    Expected<MetricResult> TryCalculate(const function::Function &f) const {
+        const auto &info = Info();
+        auto value = CalculateImpl(f);
+        if (!value)
+            return std::unexpected(std::move(value.error()));
+        return MetricResult{.metric_name = info.name, .metric_id = info.id, .value = std::move(*value)};
+    }
+
+    // Бросает std::runtime_error, если метрика не вычисляется
     MetricResult Calculate(const function::Function &f) const {
-        return MetricResult{.metric_name = Name(), .value = CalculateImpl(f)};
+        auto result = TryCalculate(f);
+        if (!result)
+            throw std::runtime_error(std::string(MetricName().View()) + ": " + result.error().message);
+        return std::move(*result);
     }
 
+    MetricId Id() const { return Info().id; }
+    interner::InternedString MetricName() const { return Info().name; }
+
+    // Значение зависит только от AST функции без координат и общего отступа, а не от строк исходника и имён.
+    // Такие результаты мемоизируются по NormalizedAstHash (см. MetricMemo)
+    virtual bool IsStructural() const { return false; }
+
 protected:
-    virtual MetricResult::ValueType CalculateImpl(const function::Function &f) const = 0;
+    // Некорректный вход — ошибка в Expected, а не исключение: прогон продолжается со следующей функцией
+    virtual Expected<MetricResult::ValueType> CalculateImpl(const function::Function &f) const = 0;
     virtual std::string Name() const = 0;
+
+private:
+    struct MetricInfo {
+        interner::InternedString name;
+        MetricId id = kUnknownMetricId;
+    };
+
+    // Name() и регистрация в реестре выполняются один раз на экземпляр метрики
+    const MetricInfo &Info() const;
+
+    mutable std::once_flag info_once_;
+    mutable MetricInfo info_;
 };
 
-using MetricResults = std::vector<MetricResult>;
+using MetricResults = std::pmr::vector<MetricResult>;
+
+class MetricMemo;
 
 struct MetricExtractor {
     void RegisterMetric(std::unique_ptr<IMetric> metric);
 
-    MetricResults Get(const function::Function &func) const;
+    // Вектор результатов выделяется из resource. Бросает std::runtime_error на первой ошибке метрики
+    MetricResults Get(const function::Function &func,
+                      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
+    // Метрики с ошибкой пропускаются, а их ошибки дописываются в errors. С memo структурные метрики
+    // вычисляются один раз на нормализованное тело функции, остальные — для каждой функции
+    MetricResults Get(const function::Function &func, std::pmr::memory_resource *resource,
+                      std::vector<MetricError> &errors) const;
     std::vector<std::unique_ptr<IMetric>> metrics;
+    MetricMemo *memo = nullptr;    // Необязательна; должна пережить экстрактор
+    bool collect_callees = false;  // Собирать имена вызовов при разборе файлов для --call-graph
 };
 
 }  // namespace analyzer::metric
@@ -2,6 +2,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cassert>
 #include <any>
 #include <array>
 #include <cstdio>
@@ -12,6 +13,7 @@
 #include <functional>
 #include <iostream>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 #include <variant>
@@ -19,7 +21,8 @@
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
-#include <unordered_map>
+#include <typeindex>
+#include <typeinfo>
 
 #include "metric.hpp"
 
@@ -30,6 +33,21 @@ namespace analyzer::metric_accumulator {
 
 struct IAccumulator {
     virtual void Accumulate(const metric::MetricResult &metric_result) = 0;
+    // Для аккумуляторов, которым важна функция-источник значения; по умолчанию функция игнорируется
+    virtual void AccumulateFunctionResult(const function::Function &function,
+                                          const metric::MetricResult &metric_result);
+    // Пачка целочисленных значений одной метрики; по умолчанию каждое значение проходит через Accumulate.
+    // Числовые аккумуляторы переопределяют метод простыми циклами, которые компилятор векторизует
+    virtual void AccumulateBatch(std::span<const int> values);
+    // То же с функциями-источниками: functions[i] — источник values[i]. По умолчанию функции отбрасываются
+    // и вызывается AccumulateBatch; аккумулятор, переопределивший AccumulateFunctionResult, переопределяет и его
+    virtual void AccumulateFunctionBatch(std::span<const function::Function *const> functions,
+                                         std::span<const int> values);
+    // Вливает в себя состояние другого аккумулятора того же типа; результат совпадает с последовательным накоплением
+    virtual void Merge(const IAccumulator &other);
+    // Снимает ранее накопленное значение: обновление файла в долгом прогоне — снять старые значения, добавить новые.
+    // Поддерживают аккумуляторы с обратимым состоянием, остальные бросают std::logic_error
+    virtual void Retract(const metric::MetricResult &metric_result);
     virtual void Finalize() = 0;
     virtual void Reset() = 0;
     virtual ~IAccumulator() = default;
@@ -38,34 +56,107 @@ protected:
     bool is_finalized = false;
 };
 
+// Отложенные целочисленные значения одной метрики для пакетной передачи аккумулятору; functions пуст,
+// если функции-источники неизвестны
+struct ValueColumn {
+    std::vector<const function::Function *> functions;
+    std::vector<int> values;
+
+    // Добавляет значение; строковое значение сначала сбрасывает накопленное и передаётся сразу,
+    // поэтому аккумулятор видит значения метрики в том же порядке, что и при построчном накоплении
+    void Append(IAccumulator &accumulator, const function::Function *function, const metric::MetricResult &result);
+    // Передаёт накопленное одним AccumulateBatch или AccumulateFunctionBatch и очищает столбец
+    void FlushInto(IAccumulator &accumulator);
+};
+
+// Типизированная ссылка на аккумулятор, выдаётся при регистрации; тип проверяется один раз при регистрации
+template <typename Accumulator>
+struct AccumulatorHandle {
+    metric::MetricId metric_id;
+};
+
 struct MetricsAccumulator {
     template <typename Accumulator>
-    void RegisterAccumulator(const std::string &metric_name, std::unique_ptr<Accumulator> acc) {
+    AccumulatorHandle<Accumulator> RegisterAccumulator(const std::string &metric_name,
+                                                       std::unique_ptr<Accumulator> acc) {
         static_assert(std::is_base_of_v<IAccumulator, Accumulator>,
                       "Accumulator must derive from IAccumulator");
         if (!acc)
             throw std::invalid_argument("Accumulator pointer is null");
-        accumulators[metric_name] = std::shared_ptr<IAccumulator>(std::move(acc));
+        const auto id = metric::RegisterMetricName(metric_name);
+        if (id >= accumulators.size())
+            accumulators.resize(id + 1);
+        accumulators[id] = Slot{.accumulator = std::move(acc), .type = typeid(Accumulator)};
+        return AccumulatorHandle<Accumulator>{id};
+    }
+    template <typename Accumulator>
+    const Accumulator &GetFinalizedAccumulator(AccumulatorHandle<Accumulator> handle) const {
+        auto &slot = accumulators.at(handle.metric_id);
+        if (!slot.accumulator)
+            throw std::out_of_range("Accumulator for metric id " + std::to_string(handle.metric_id) + " not found");
+        assert(slot.type == typeid(Accumulator));
+        slot.accumulator->Finalize();
+        return static_cast<const Accumulator &>(*slot.accumulator);
     }
     template <typename Accumulator>
     const Accumulator &GetFinalizedAccumulator(const std::string &metric_name) const {
         static_assert(std::is_base_of_v<IAccumulator, Accumulator>,
                       "Accumulator must derive from IAccumulator");
-        auto it = accumulators.find(metric_name);
-        if (it == accumulators.end())
+        const auto id = metric::FindMetricId(metric_name);
+        if (!id || *id >= accumulators.size() || !accumulators[*id].accumulator)
             throw std::out_of_range("Accumulator for metric '" + metric_name + "' not found");
-        auto typed = std::dynamic_pointer_cast<Accumulator>(it->second);
-        if (!typed)
+        if (accumulators[*id].type != typeid(Accumulator))
             throw std::runtime_error("Accumulator type mismatch for metric '" + metric_name + "'");
-        typed->Finalize();
-        return *typed;
+        return GetFinalizedAccumulator(AccumulatorHandle<Accumulator>{*id});
     }
-    void AccumulateNextFunctionResults(const std::vector<metric::MetricResult> &metric_results) const;
+    void AccumulateNextFunctionResults(const metric::MetricResults &metric_results) const;
+    void AccumulateNextFunctionResults(const function::Function &function,
+                                       const metric::MetricResults &metric_results) const;
+
+    // Колоночный путь: целочисленные значения каждой метрики собираются в столбец и передаются аккумулятору
+    // одним вызовом AccumulateBatch. Функция-источник не передаётся, поэтому топ-K сюда не подходит
+    template <rs::input_range Range>
+    void AccumulateFunctionResultsBatch(Range &&results_per_function) const {
+        std::vector<ValueColumn> columns(accumulators.size());
+        for (const metric::MetricResults &metric_results : results_per_function)
+            for (const auto &result : metric_results)
+                AppendToColumn(nullptr, result, columns);
+        FlushColumns(columns);
+    }
+
+    // Колоночный путь с функциями-источниками: пары (функция, результаты) как в FunctionAnalysis,
+    // столбцы уходят аккумуляторам через AccumulateFunctionBatch
+    template <rs::input_range Range>
+    void AccumulateFunctionAnalysisBatch(Range &&analysis) const {
+        std::vector<ValueColumn> columns(accumulators.size());
+        for (const auto &[function, metric_results] : analysis)
+            for (const auto &result : metric_results)
+                AppendToColumn(&function, result, columns);
+        FlushColumns(columns);
+    }
+
+    // Набор метрик у other должен совпадать с текущим
+    void Merge(const MetricsAccumulator &other);
 
     void ResetAccumulators();
 
 private:
-    std::unordered_map<std::string, std::shared_ptr<IAccumulator>> accumulators;
+    metric::MetricId ResolveId(const metric::MetricResult &metric_result) const;
+    IAccumulator *FindAccumulator(const metric::MetricResult &metric_result) const;
+    void AppendToColumn(const function::Function *function, const metric::MetricResult &metric_result,
+                        std::vector<ValueColumn> &columns) const;
+    void FlushColumns(std::vector<ValueColumn> &columns) const;
+
+    struct Slot {
+        std::unique_ptr<IAccumulator> accumulator;
+        std::type_index type = typeid(void);
+    };
+
+    // Индекс — id метрики из реестра, пустые слоты соответствуют незарегистрированным метрикам
+    std::vector<Slot> accumulators;
 };
 
+// Попарно сливает частичные аккумуляторы (например, по одному на поток) деревом; результат в partials.front()
+void MergeTree(std::vector<MetricsAccumulator> &partials);
+
 }  // namespace analyzer::metric_accumulator
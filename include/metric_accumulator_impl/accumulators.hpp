@@ -3,4 +3,9 @@
 #include "../metric_accumulator.hpp"
 #include "average_accumulator.hpp"
 #include "categorical_accumulator.hpp"
+#include "histogram_accumulator.hpp"
+#include "hyperloglog_accumulator.hpp"
+#include "moments_accumulator.hpp"
+#include "quantile_accumulator.hpp"
 #include "sum_average_accumulator.hpp"
+#include "top_k_accumulator.hpp"
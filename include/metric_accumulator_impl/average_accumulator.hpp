@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -11,6 +12,7 @@
 #include <functional>
 #include <iostream>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 #include <variant>
@@ -23,6 +25,12 @@ namespace analyzer::metric_accumulator::metric_accumulator_impl {
 struct AverageAccumulator : public IAccumulator {
     void Accumulate(const metric::MetricResult &metric_result) override;
 
+    void AccumulateBatch(std::span<const int> values) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    void Retract(const metric::MetricResult &metric_result) override;
+
     void Finalize() override;
 
     void Reset();
@@ -30,8 +38,8 @@ struct AverageAccumulator : public IAccumulator {
     double Get() const;
 
 private:
-    int sum = 0;
-    int count = 0;
+    std::int64_t sum = 0;
+    std::int64_t count = 0;
     double average = 0;
 };
 
@@ -24,6 +24,8 @@ namespace analyzer::metric_accumulator::metric_accumulator_impl {
 struct CategoricalAccumulator : public IAccumulator {
     void Accumulate(const metric::MetricResult &metric_result) override;
 
+    void Merge(const IAccumulator &other) override;
+
     virtual void Finalize() override;
 
     virtual void Reset() override;
@@ -0,0 +1,79 @@
+#pragma once
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+// Гистограмма в духе HDR: значения меньше 2^sub_bucket_bits считаются точно, дальше каждый диапазон
+// [2^h, 2^(h+1)) делится на 2^sub_bucket_bits равных корзин. Относительная ширина корзины не больше
+// 2^-sub_bucket_bits. Счётчики лежат в плоском массиве фиксированного размера.
+struct HistogramAccumulator : public IAccumulator {
+    static constexpr unsigned kDefaultSubBucketBits = 3;
+    static constexpr unsigned kMaxSubBucketBits = 10;
+
+    struct Bucket {
+        int lower;
+        int upper;  // Включительно
+        std::uint64_t count;
+        auto operator<=>(const Bucket &) const = default;
+    };
+
+    struct CumulativeBucket {
+        int upper;
+        std::uint64_t count;  // Число значений, не превышающих upper
+        double fraction;
+        auto operator<=>(const CumulativeBucket &) const = default;
+    };
+
+    HistogramAccumulator();
+    explicit HistogramAccumulator(unsigned sub_bucket_bits);
+
+    void Accumulate(const metric::MetricResult &metric_result) override;
+
+    void AccumulateBatch(std::span<const int> values) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    virtual void Finalize() override;
+
+    virtual void Reset() override;
+
+    // Непустые корзины по возрастанию границ
+    const std::vector<Bucket> &Get() const;
+
+    const std::vector<CumulativeBucket> &GetCumulative() const;
+
+    std::uint64_t Count() const;
+
+    std::size_t BucketIndex(int value) const;
+
+private:
+    Bucket BucketBounds(std::size_t index) const;
+
+    unsigned sub_bucket_bits;
+    std::uint64_t count = 0;
+    std::vector<std::uint64_t> counters;
+    std::vector<Bucket> buckets;
+    std::vector<CumulativeBucket> cumulative;
+};
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
@@ -0,0 +1,63 @@
+#pragma once
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+// Оценка числа различных строковых значений метрики (HyperLogLog) на 2^precision однобайтовых регистрах,
+// стандартная ошибка около 1.04 / sqrt(2^precision). В гибридном режиме до exact_threshold различных
+// значений хранятся их 64-битные хеши и ответ точный, после порога аккумулятор переходит на регистры.
+struct HyperLogLogAccumulator : public IAccumulator {
+    static constexpr unsigned kDefaultPrecision = 12;
+    static constexpr unsigned kMinPrecision = 4;
+    static constexpr unsigned kMaxPrecision = 18;
+
+    HyperLogLogAccumulator();
+    explicit HyperLogLogAccumulator(unsigned precision, std::size_t exact_threshold = 0);
+
+    void Accumulate(const metric::MetricResult &metric_result) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    virtual void Finalize() override;
+
+    virtual void Reset() override;
+
+    std::uint64_t Get() const;
+
+    // true, пока аккумулятор не перешёл на регистры и ответ точный
+    bool IsExact() const;
+
+private:
+    void Add(std::uint64_t hash);
+    void AddToRegisters(std::uint64_t hash);
+    void SwitchToRegisters();
+    std::uint64_t Estimate() const;
+
+    unsigned precision;
+    std::size_t exact_threshold;
+    std::unordered_set<std::uint64_t> exact_hashes;
+    std::vector<std::uint8_t> registers;  // Пустой, пока действует точный режим
+    std::uint64_t estimate = 0;
+};
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
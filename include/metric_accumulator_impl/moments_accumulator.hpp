@@ -0,0 +1,70 @@
+#pragma once
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+// Сумма, минимум, максимум, среднее и дисперсия (генеральная) с 64-битной суммой.
+// Одиночные значения учитываются по Уэлфорду, пачки и частичные результаты сливаются по формуле Чана.
+struct MomentsAccumulator : public IAccumulator {
+    struct Moments {
+        std::int64_t count;
+        std::int64_t sum;
+        std::int64_t min;
+        std::int64_t max;
+        double mean;
+        double variance;
+        double stddev;
+        auto operator<=>(const Moments &) const = default;
+    };
+
+    void Accumulate(const metric::MetricResult &metric_result) override;
+
+    void AccumulateBatch(std::span<const int> values) override;
+
+    // Пачка значений одной метрики; циклы редукции написаны так, чтобы компилятор мог их векторизовать
+    void Accumulate(std::span<const std::int64_t> values);
+
+    void Merge(const IAccumulator &other) override;
+
+    virtual void Finalize() override;
+
+    virtual void Reset() override;
+
+    Moments Get() const;
+
+private:
+    // Общая редукция для пачек int и std::int64_t
+    template <typename Value>
+    void AccumulateValues(std::span<const Value> values);
+    void Combine(std::int64_t other_count, std::int64_t other_sum, std::int64_t other_min, std::int64_t other_max,
+                 double other_mean, double other_m2);
+
+    std::int64_t count = 0;
+    std::int64_t sum = 0;
+    std::int64_t min = 0;
+    std::int64_t max = 0;
+    double mean = 0;
+    double m2 = 0;  // Сумма квадратов отклонений от среднего
+    double variance = 0;
+};
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
@@ -0,0 +1,68 @@
+#pragma once
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+// Потоковая оценка квантилей (KLL-скетч). Память O(k), ранговая погрешность порядка 1.7 / k.
+// Пока значений меньше k, ответы точные.
+struct QuantileAccumulator : public IAccumulator {
+    static constexpr std::size_t kDefaultK = 200;
+    static constexpr std::size_t kMinK = 8;
+
+    QuantileAccumulator();
+    explicit QuantileAccumulator(std::size_t k);
+
+    void Accumulate(const metric::MetricResult &metric_result) override;
+
+    void AccumulateBatch(std::span<const int> values) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    virtual void Finalize() override;
+
+    virtual void Reset() override;
+
+    // q в диапазоне [0, 1]; возвращает наименьшее значение, ранг которого не меньше q * Count()
+    int Get(double q) const;
+
+    std::int64_t Count() const;
+
+    std::size_t RetainedItems() const;
+
+private:
+    void Insert(int value);
+    void Compress();
+    std::size_t Capacity(std::size_t level) const;
+
+    std::size_t k;
+    std::int64_t count = 0;
+    int min = 0;
+    int max = 0;
+    std::vector<std::vector<int>> compactors;  // Уровень h хранит значения с весом 2^h
+    std::minstd_rand random;
+    std::vector<std::pair<int, std::uint64_t>> cumulative;  // Значение и накопленный вес после Finalize
+};
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
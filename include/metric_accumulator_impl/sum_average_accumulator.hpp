@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -11,6 +12,7 @@
 #include <functional>
 #include <iostream>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 #include <variant>
@@ -22,12 +24,18 @@ namespace analyzer::metric_accumulator::metric_accumulator_impl {
 
 struct SumAverageAccumulator : public IAccumulator {
     struct SumAverage {
-        int sum;
+        std::int64_t sum;
         double average;
         auto operator<=>(const SumAverage &) const = default;
     };
     void Accumulate(const metric::MetricResult &metric_result) override;
 
+    void AccumulateBatch(std::span<const int> values) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    void Retract(const metric::MetricResult &metric_result) override;
+
     virtual void Finalize() override;
 
     virtual void Reset() override;
@@ -35,8 +43,8 @@ struct SumAverageAccumulator : public IAccumulator {
     SumAverage Get() const;
 
 private:
-    int sum = 0;
-    int count = 0;
+    std::int64_t sum = 0;
+    std::int64_t count = 0;
     double average = 0;
 };
 
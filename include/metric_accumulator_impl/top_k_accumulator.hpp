@@ -0,0 +1,72 @@
+#pragma once
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+// Хранит K функций с наибольшим значением метрики в ограниченной min-куче, память O(K).
+// При равных значениях выше стоит функция с меньшими (filename, qualified_name), поэтому результат
+// слияния частичных аккумуляторов совпадает с последовательным накоплением.
+struct TopKAccumulator : public IAccumulator {
+    static constexpr std::size_t kDefaultK = 50;
+
+    struct FunctionRef {
+        std::string filename;
+        std::string qualified_name;  // Класс.функция или просто имя функции
+        auto operator<=>(const FunctionRef &) const = default;
+    };
+
+    struct Entry {
+        int value;
+        FunctionRef function;
+        auto operator<=>(const Entry &) const = default;
+    };
+
+    TopKAccumulator();
+    explicit TopKAccumulator(std::size_t k);
+
+    // Без функции-источника значение не к чему привязать, поэтому бросает std::logic_error
+    void Accumulate(const metric::MetricResult &metric_result) override;
+
+    void AccumulateFunctionResult(const function::Function &function,
+                                  const metric::MetricResult &metric_result) override;
+
+    void AccumulateFunctionBatch(std::span<const function::Function *const> functions,
+                                 std::span<const int> values) override;
+
+    void Merge(const IAccumulator &other) override;
+
+    virtual void Finalize() override;
+
+    virtual void Reset() override;
+
+    // Записи по убыванию значения метрики
+    const std::vector<Entry> &Get() const;
+
+private:
+    bool MayAdmit(int value) const;
+    void Offer(Entry entry);
+
+    std::size_t k;
+    std::vector<Entry> heap;  // На вершине худшая из сохранённых записей
+};
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
@@ -21,8 +21,11 @@
 namespace analyzer::metric::metric_impl {
 
 struct CodeLinesCountMetric final : IMetric {
+    // Целочисленное значение без variant; Bind вызывает его напрямую
+    Expected<int> CalculateValue(const function::Function &f) const;
+
 protected:
-    MetricResult::ValueType CalculateImpl(const function::Function &f) const override;
+    Expected<MetricResult::ValueType> CalculateImpl(const function::Function &f) const override;
     std::string Name() const override;
 };
 
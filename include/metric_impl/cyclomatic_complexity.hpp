@@ -20,9 +20,14 @@
 
 namespace analyzer::metric::metric_impl {
 
-struct CyclomaticComplexityMetric : IMetric {
+struct CyclomaticComplexityMetric final : IMetric {
+    bool IsStructural() const override { return true; }
+
+    // Целочисленное значение без variant; Bind вызывает его напрямую
+    Expected<int> CalculateValue(const function::Function &f) const;
+
 protected:
-    MetricResult::ValueType CalculateImpl(const function::Function &f) const override;
+    Expected<MetricResult::ValueType> CalculateImpl(const function::Function &f) const override;
     std::string Name() const override;
 };
 
@@ -20,9 +20,9 @@
 
 namespace analyzer::metric::metric_impl {
 
-struct NamingStyleMetric : IMetric {
+struct NamingStyleMetric final : IMetric {
 protected:
-    MetricResult::ValueType CalculateImpl(const function::Function &f) const override;
+    Expected<MetricResult::ValueType> CalculateImpl(const function::Function &f) const override;
     std::string Name() const override;
 };
 
@@ -17,8 +17,13 @@
 namespace analyzer::metric::metric_impl {
 
 struct CountParametersMetric final : public IMetric {
+    bool IsStructural() const override { return true; }
+
+    // Целочисленное значение без variant; Bind вызывает его напрямую
+    Expected<int> CalculateValue(const function::Function &f) const;
+
 protected:
-    MetricResult::ValueType CalculateImpl(const function::Function &f) const override;
+    Expected<MetricResult::ValueType> CalculateImpl(const function::Function &f) const override;
     std::string Name() const override;
 };
 
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "lru_map.hpp"
+#include "metric.hpp"
+
+namespace analyzer::metric {
+
+inline constexpr std::uint64_t kAstHashSeed = 14695981039346656037ull;
+
+// FNV-1a AST функции без координат узлов "[строка, столбец] - [строка, столбец]" и с отступами относительно
+// первого дочернего узла: одно тело в разных файлах, на разных строках и на разной глубине вложенности
+// (метод и функция модуля) даёт один хеш. Имена идентификаторов в AST tree-sitter не попадают
+std::uint64_t NormalizedAstHash(std::string_view ast, std::uint64_t seed = kAstHashSeed);
+
+// Потокобезопасная мемоизация структурных метрик (IMetric::IsStructural): запись — их результаты в порядке
+// регистрации в экстракторе. Таблица разбита на шарды со своими мьютексами, поэтому воркеры, разбирающие
+// разные функции, почти не ждут друг друга. capacity (0 — без ограничения) делится между шардами поровну,
+// но не меньше записи на шард; в шарде вытесняется давно не использованная запись
+class MetricMemo {
+public:
+    using Entry = std::vector<MetricResult>;
+
+    explicit MetricMemo(std::size_t capacity = 0);
+
+    // nullptr, если записи нет
+    std::shared_ptr<const Entry> Find(std::uint64_t key);
+    void Store(std::uint64_t key, Entry results);
+
+    std::size_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+    std::size_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+    std::size_t Size() const;
+
+    // Все записи в неопределённом порядке, например для сохранения; шарды блокируются по очереди
+    template <typename Callback>
+    void ForEach(Callback &&callback) const {
+        for (const auto &shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            shard.entries.ForEach([&](std::uint64_t key, const std::shared_ptr<const Entry> &entry) {
+                callback(key, *entry);
+            });
+        }
+    }
+
+private:
+    static constexpr std::size_t kShards = 16;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        cache::LruMap<std::uint64_t, std::shared_ptr<const Entry>> entries;
+    };
+
+    // Старшие биты: младшие уже выбирают корзину внутри unordered_map шарда
+    Shard &ShardOf(std::uint64_t key) { return shards_[key >> 60]; }
+
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::size_t> hits_{0};
+    std::atomic<std::size_t> misses_{0};
+};
+
+}  // namespace analyzer::metric
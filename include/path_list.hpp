@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "error.hpp"
+#include "path_queue.hpp"
+
+namespace analyzer::input {
+
+// Читает список путей из дескриптора по мере поступления данных и сразу кладёт пути в очередь, поэтому
+// анализ начинается, пока источник (например, git ls-files) ещё пишет. Формат определяется первым
+// разделителем: '\0' (git ls-files -z, find -print0) или перевод строки. В построчном режиме пустые
+// строки пропускаются, завершающий '\r' отбрасывается. Возвращает число прочитанных путей;
+// очередь не закрывается
+Expected<std::size_t> ReadPathList(int fd, PathQueue &paths);
+
+// source — путь к файлу со списком или "-" для stdin
+Expected<std::size_t> ReadPathList(const std::string &source, PathQueue &paths);
+
+}  // namespace analyzer::input
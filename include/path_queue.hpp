@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace analyzer {
+
+// Путь и его номер в порядке поступления в очередь
+struct QueuedPath {
+    std::size_t index;
+    std::string path;
+};
+
+// Очередь путей между источником (обход каталогов, список файлов) и анализом: анализ начинается
+// с первых путей, пока источник ещё работает. Close() сообщает, что новых путей не будет
+class PathQueue {
+public:
+    void Push(std::string path) {
+        {
+            std::lock_guard lock(mutex_);
+            paths_.push_back(QueuedPath{pushed_++, std::move(path)});
+        }
+        ready_.notify_one();
+    }
+
+    void Close() {
+        {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    // Ждёт следующий путь; nullopt, когда очередь закрыта и пуста
+    std::optional<QueuedPath> Pop() {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return closed_ || !paths_.empty(); });
+        if (paths_.empty())
+            return std::nullopt;
+        auto path = std::move(paths_.front());
+        paths_.pop_front();
+        return path;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<QueuedPath> paths_;
+    std::size_t pushed_ = 0;
+    bool closed_ = false;
+};
+
+}  // namespace analyzer
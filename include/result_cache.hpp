@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lru_map.hpp"
+#include "metric.hpp"
+#include "metric_memo.hpp"
+
+namespace analyzer::cache {
+
+// Результаты функции без привязки к пути файла: один и тот же исходник под разными путями
+// и в разных ревизиях даёт одну запись. AST не хранится
+struct CachedFunction {
+    std::optional<std::string> class_name;
+    std::string name;
+    std::vector<metric::MetricResult> metrics;
+};
+
+struct CachedFile {
+    std::vector<CachedFunction> functions;
+};
+
+// Текстовый формат файла кеша с длинами строк; nullopt на повреждённых данных или другой версии формата
+std::string Serialize(const CachedFile &file);
+std::optional<CachedFile> Deserialize(std::string_view data);
+
+// Записи memo в одном файле формата Serialize: функция на запись, ключ — её имя в hex. Запись через временный
+// файл и rename; false, если записать не удалось
+bool SaveMemo(const metric::MetricMemo &memo, const std::filesystem::path &path);
+// Дописывает записи из path в memo; false, если файла нет или он повреждён, и тогда memo не меняется
+bool LoadMemo(const std::filesystem::path &path, metric::MetricMemo &memo);
+
+// Потокобезопасный кеш результатов по ключу, например id blob-а. Записи держатся в памяти и, если задан
+// directory, сохраняются в нём между запусками: <directory>/<первые 2 символа ключа>/<ключ>.
+// В памяти остаются не больше capacity записей (0 — без ограничения), вытесненные снова читаются с диска.
+// Ключ должен быть допустимым именем файла
+class ResultCache {
+public:
+    explicit ResultCache(std::filesystem::path directory = {}, std::size_t capacity = 0);
+
+    std::shared_ptr<const CachedFile> Find(const std::string &key);
+    void Store(const std::string &key, std::shared_ptr<const CachedFile> file);
+
+    std::size_t Hits() const;
+    std::size_t Misses() const;
+    // Записей в памяти
+    std::size_t Size() const;
+
+private:
+    std::filesystem::path PathOf(const std::string &key) const;
+
+    std::filesystem::path directory_;
+    mutable std::mutex mutex_;
+    LruMap<std::string, std::shared_ptr<const CachedFile>> entries_;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+}  // namespace analyzer::cache
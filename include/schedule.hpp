@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace analyzer::schedule {
+
+// Индексы задач по убыванию стоимости; при равной стоимости сохраняется исходный порядок
+std::vector<std::size_t> LongestFirstOrder(std::span<const std::uint64_t> costs);
+
+// Оценка стоимости разбора файла — размер в байтах; недоступный файл стоит 0
+std::uint64_t EstimateFileCost(const std::string &filename);
+
+struct ScheduleProfile {
+    std::size_t workers = 0;
+    std::chrono::nanoseconds makespan{0};    // От старта до завершения последней задачи
+    std::chrono::nanoseconds total_work{0};  // Сумма времён всех задач
+    std::chrono::nanoseconds longest_task{0};
+
+    // Нижняя граница makespan для данного числа воркеров: max(total_work / workers, longest_task)
+    std::chrono::nanoseconds Ideal() const;
+    // Ideal / makespan, 1 — идеальная балансировка
+    double Efficiency() const;
+};
+
+// Общий цикл воркеров: каждый берёт следующий элемент из next() и выполняет task(item, worker), пока next()
+// не вернёт nullopt. next() вызывается из разных потоков и может блокироваться, например на очереди путей.
+// worker < workers позволяет держать состояние воркера без синхронизации; воркер 0 — вызывающий поток.
+// Первое исключение из task останавливает раздачу и пробрасывается после остановки всех воркеров
+template <typename Next, typename Task>
+ScheduleProfile RunWorkers(std::size_t workers, Next &&next, Task &&task) {
+    using Clock = std::chrono::steady_clock;
+
+    workers = std::max<std::size_t>(workers, 1);
+    std::atomic<bool> stopped{false};
+    std::vector<std::chrono::nanoseconds> busy(workers);
+    std::vector<std::chrono::nanoseconds> longest(workers);
+    std::vector<std::exception_ptr> failures(workers);
+
+    auto work = [&](std::size_t worker) {
+        try {
+            while (!stopped.load(std::memory_order_relaxed)) {
+                auto item = next();
+                if (!item)
+                    break;
+                const auto task_start = Clock::now();
+                task(std::move(*item), worker);
+                const auto elapsed = Clock::now() - task_start;
+                busy[worker] += elapsed;
+                longest[worker] = std::max<std::chrono::nanoseconds>(longest[worker], elapsed);
+            }
+        } catch (...) {
+            failures[worker] = std::current_exception();
+            stopped.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    const auto start = Clock::now();
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(workers - 1);
+        for (std::size_t worker = 1; worker < workers; ++worker)
+            threads.emplace_back(work, worker);
+        work(0);
+    }
+
+    ScheduleProfile profile{.workers = workers, .makespan = Clock::now() - start};
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        profile.total_work += busy[worker];
+        profile.longest_task = std::max(profile.longest_task, longest[worker]);
+    }
+
+    for (const auto &failure : failures)
+        if (failure)
+            std::rethrow_exception(failure);
+    return profile;
+}
+
+// Longest-processing-time-first: свободный воркер берёт самую дорогую из оставшихся задач,
+// поэтому крупные файлы не достаются последними. task(index, worker) вызывается ровно один раз
+// для каждого индекса, кроме случая, когда одна из задач бросила исключение
+template <typename Task>
+ScheduleProfile RunLongestFirst(std::span<const std::uint64_t> costs, std::size_t workers, Task &&task) {
+    const auto order = LongestFirstOrder(costs);
+    std::atomic<std::size_t> next{0};
+    return RunWorkers(
+        workers,
+        [&]() -> std::optional<std::size_t> {
+            const auto i = next.fetch_add(1, std::memory_order_relaxed);
+            return i < order.size() ? std::optional(order[i]) : std::nullopt;
+        },
+        std::forward<Task>(task));
+}
+
+}  // namespace analyzer::schedule
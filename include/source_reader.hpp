@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "error.hpp"
+
+namespace analyzer::io {
+
+// Содержимое исходного файла целиком или ошибка чтения
+using Source = Expected<std::string>;
+
+// Читает файл целиком через open/fstat/pread/close
+Source ReadWholeFile(const std::string &path);
+
+// Пакетное чтение исходников: результат i соответствует paths[i]. Ошибка одного файла не мешает остальным
+struct IBatchReader {
+    virtual ~IBatchReader() = default;
+    virtual std::vector<Source> ReadBatch(std::span<const std::string> paths) = 0;
+    virtual std::string_view Name() const = 0;
+};
+
+enum class Backend {
+    kAuto,        // io_uring, если ядро его поддерживает, иначе пул потоков
+    kIoUring,     // openat/statx, read и close пачкой: три системных вызова на пачку файлов
+    kThreadPool,  // ReadWholeFile в threads потоках
+};
+
+// Для kIoUring бросает std::runtime_error, если io_uring недоступен (старое ядро, seccomp) или не умеет
+// openat, statx, read и close; kAuto в этих случаях выбирает пул потоков
+std::unique_ptr<IBatchReader> MakeBatchReader(Backend backend = Backend::kAuto, std::size_t threads = 4);
+
+// Читает файлы пачками в фоновом потоке в порядке order, опережая потребителей не более чем на window
+// файлов. Take(index) ждёт, пока файл paths[index] будет прочитан, и забирает его содержимое; каждый
+// файл из order нужно забрать ровно один раз, иначе чтение остановится, когда окно заполнится
+class Prefetcher {
+public:
+    static constexpr std::size_t kDefaultWindow = 256;
+
+    Prefetcher(std::span<const std::string> paths, std::vector<std::size_t> order,
+               std::unique_ptr<IBatchReader> reader, std::size_t window = kDefaultWindow);
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher &) = delete;
+    Prefetcher &operator=(const Prefetcher &) = delete;
+
+    Source Take(std::size_t index);
+    // Больше не начинает чтение новых пачек, например когда исчерпан бюджет времени; текущая пачка
+    // дочитывается. Take непрочитанного файла после Stop сразу возвращает ошибку kSkipped
+    void Stop();
+
+private:
+    void ReadLoop(std::stop_token stop);
+
+    std::span<const std::string> paths_;
+    std::vector<std::size_t> order_;
+    std::unique_ptr<IBatchReader> reader_;
+    std::size_t window_;
+
+    std::mutex mutex_;
+    std::condition_variable_any changed_;
+    std::vector<std::optional<Source>> sources_;
+    std::size_t read_ = 0;   // Сколько файлов из order_ прочитано
+    std::size_t taken_ = 0;  // Сколько забрано через Take
+    bool stopped_ = false;
+    std::jthread thread_;    // Объявлен последним: останавливается до разрушения остальных полей
+};
+
+}  // namespace analyzer::io
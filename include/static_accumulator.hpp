@@ -0,0 +1,161 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "error.hpp"
+#include "function.hpp"
+#include "metric.hpp"
+#include "metric_accumulator.hpp"
+
+namespace analyzer::metric_accumulator {
+
+namespace detail {
+
+// true, если Accumulator сам переопределяет AccumulateFunctionResult (например, топ-K)
+template <typename Accumulator>
+inline constexpr bool kOverridesFunctionResult =
+    !std::is_same_v<decltype(&Accumulator::AccumulateFunctionResult),
+                    void (IAccumulator::*)(const function::Function &, const metric::MetricResult &)>;
+
+template <typename Accumulator>
+inline constexpr bool kOverridesBatch =
+    !std::is_same_v<decltype(&Accumulator::AccumulateBatch), void (IAccumulator::*)(std::span<const int>)>;
+
+template <typename Accumulator>
+inline constexpr bool kOverridesFunctionBatch =
+    !std::is_same_v<decltype(&Accumulator::AccumulateFunctionBatch),
+                    void (IAccumulator::*)(std::span<const function::Function *const>, std::span<const int>)>;
+
+// Метрика, которая отдаёт целое значение без variant через CalculateValue
+template <typename Metric>
+concept IntMetric = requires(const Metric &metric, const function::Function &function) {
+    { metric.CalculateValue(function) } -> std::same_as<Expected<int>>;
+};
+
+// Квалифицированные вызовы не идут через vtable: тип аккумулятора известен на этапе компиляции
+template <typename Accumulator>
+void AccumulateStatic(Accumulator &acc, const function::Function &function, const metric::MetricResult &result) {
+    if constexpr (kOverridesFunctionResult<Accumulator>)
+        acc.Accumulator::AccumulateFunctionResult(function, result);
+    else
+        acc.Accumulator::Accumulate(result);
+}
+
+// Целое значение передаётся пачкой из одного элемента, минуя MetricResult и проверку альтернативы variant;
+// аккумулятор без пачечного метода получает MetricResult
+template <typename Accumulator>
+void AccumulateValue(Accumulator &acc, const function::Function &function, int value) {
+    if constexpr (kOverridesFunctionBatch<Accumulator>) {
+        const function::Function *source = &function;
+        acc.Accumulator::AccumulateFunctionBatch({&source, 1}, {&value, 1});
+    } else if constexpr (kOverridesBatch<Accumulator>) {
+        acc.Accumulator::AccumulateBatch({&value, 1});
+    } else {
+        AccumulateStatic(acc, function, metric::MetricResult{.value = value});
+    }
+}
+
+}  // namespace detail
+
+// Связывает метрику с набором аккумуляторов на этапе компиляции, например
+// Bind<CyclomaticComplexityMetric, SumAverageAccumulator, QuantileAccumulator, TopKAccumulator>.
+// Аккумуляторы хранятся по значению в кортеже и обновляются сразу после вычисления метрики; значение
+// целочисленной метрики (IntMetric) передаётся им как int. Для конфигурации во время выполнения остаётся
+// MetricsAccumulator.
+template <typename Metric, typename... Accumulators>
+class Bind {
+    static_assert(std::is_base_of_v<metric::IMetric, Metric>, "Metric must derive from IMetric");
+    static_assert((std::is_base_of_v<IAccumulator, Accumulators> && ...), "Accumulators must derive from IAccumulator");
+    static_assert(sizeof...(Accumulators) > 0, "Bind requires at least one accumulator");
+
+public:
+    Bind() = default;
+    explicit Bind(Accumulators... accumulators) : accumulators_(std::move(accumulators)...) {}
+
+    // Бросает std::runtime_error, если метрика не вычисляется
+    void Evaluate(const function::Function &function) {
+        if constexpr (detail::IntMetric<Metric>) {
+            const auto value = metric_.CalculateValue(function);
+            if (!value)
+                throw std::runtime_error(std::string(metric_.MetricName().View()) + ": " + value.error().message);
+            std::apply([&](auto &...acc) { (detail::AccumulateValue(acc, function, *value), ...); }, accumulators_);
+        } else {
+            const auto result = metric_.Calculate(function);
+            std::apply([&](auto &...acc) { (detail::AccumulateStatic(acc, function, result), ...); }, accumulators_);
+        }
+    }
+
+    template <typename Accumulator>
+    Accumulator &GetAccumulator() {
+        return std::get<Accumulator>(accumulators_);
+    }
+
+    template <typename Accumulator>
+    const Accumulator &GetFinalizedAccumulator() {
+        auto &acc = std::get<Accumulator>(accumulators_);
+        acc.Accumulator::Finalize();
+        return acc;
+    }
+
+    void Merge(const Bind &other) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(accumulators_).Merge(std::get<I>(other.accumulators_)), ...);
+        }(std::index_sequence_for<Accumulators...>{});
+    }
+
+    void Reset() {
+        std::apply([](auto &...acc) { (acc.Reset(), ...); }, accumulators_);
+    }
+
+    const Metric &GetMetric() const { return metric_; }
+
+private:
+    Metric metric_;
+    std::tuple<Accumulators...> accumulators_;
+};
+
+// Набор привязок метрик; одно Evaluate на функцию вычисляет все метрики и обновляет все аккумуляторы
+template <typename... Binds>
+class StaticMetricsAccumulator {
+public:
+    void Evaluate(const function::Function &function) {
+        std::apply([&](auto &...bind) { (bind.Evaluate(function), ...); }, binds_);
+    }
+
+    void EvaluateAll(const auto &functions) {
+        for (const auto &function : functions)
+            Evaluate(function);
+    }
+
+    template <std::size_t I>
+    auto &Get() {
+        return std::get<I>(binds_);
+    }
+
+    template <typename BindType>
+    BindType &Get() {
+        return std::get<BindType>(binds_);
+    }
+
+    void Merge(const StaticMetricsAccumulator &other) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(binds_).Merge(std::get<I>(other.binds_)), ...);
+        }(std::index_sequence_for<Binds...>{});
+    }
+
+    void Reset() {
+        std::apply([](auto &...bind) { (bind.Reset(), ...); }, binds_);
+    }
+
+private:
+    std::tuple<Binds...> binds_;
+};
+
+}  // namespace analyzer::metric_accumulator
@@ -1,15 +1,17 @@
 #pragma once
 
 #include <charconv>
-#include <stdexcept>
 #include <string>
 #include <string_view>
 
-inline int ToInt(std::string_view value) {
+#include "error.hpp"
+
+inline analyzer::Expected<int> ToInt(std::string_view value) {
     int result{};
     auto [parse_end_ptr, error_code] = std::from_chars(value.begin(), value.end(), result);
     if (error_code != std::errc{} || parse_end_ptr != value.data() + value.size()) {
-        throw std::invalid_argument("Cannot convert '" + std::string(value) + "' to integral");
+        return analyzer::MakeError(analyzer::ErrorCode::kParse,
+                                   "Cannot convert '" + std::string(value) + "' to integral");
     }
     return result;
 }
@@ -1,8 +1,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -11,24 +14,44 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <print>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "analyse.hpp"
+#include "analysis_daemon.hpp"
+#include "call_graph.hpp"
 #include "cmd_options.hpp"
+#include "daemon_protocol.hpp"
+#include "directory_walker.hpp"
+#include "error.hpp"
 #include "file.hpp"
+#include "file_watcher.hpp"
 #include "function.hpp"
+#include "grouped_accumulator.hpp"
+#include "live_analysis.hpp"
 #include "metric.hpp"
 #include "metric_accumulator.hpp"
 #include "metric_accumulator_impl/accumulators.hpp"
 #include "metric_impl/metrics.hpp"
+#include "metric_memo.hpp"
+#include "path_list.hpp"
+#include "path_queue.hpp"
+#include "result_cache.hpp"
+#include "schedule.hpp"
 
 namespace {
 namespace rv = std::ranges::views;
@@ -36,6 +59,15 @@ namespace rs = std::ranges;
 
 using SumAverageAccumulator = analyzer::metric_accumulator::metric_accumulator_impl::SumAverageAccumulator;
 using SumAverageStats = SumAverageAccumulator::SumAverage;
+using GroupedSumAverageAccumulator = analyzer::metric_accumulator::GroupedAccumulator<SumAverageAccumulator>;
+using QuantileAccumulator = analyzer::metric_accumulator::metric_accumulator_impl::QuantileAccumulator;
+using GroupedQuantileAccumulator = analyzer::metric_accumulator::GroupedAccumulator<QuantileAccumulator>;
+using TopKAccumulator = analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+
+// Порядок уровней совпадает с порядком в AggregateMetrics и AggregatePercentiles
+constexpr std::size_t kGlobalLevel = 0;
+constexpr std::size_t kFileLevel = 1;
+constexpr std::size_t kClassLevel = 2;
 
 struct AggregatedMetric {
     std::string metric_name;
@@ -45,6 +77,10 @@ struct AggregatedMetric {
 constexpr std::array<std::string_view, 3> kAggregatedMetricNames = {
     "code_lines_count", "cyclomatic_complexity", "parameters_count"};
 
+constexpr std::array<std::string_view, 2> kPercentileMetricNames = {"code_lines_count", "cyclomatic_complexity"};
+constexpr std::array<std::pair<std::string_view, double>, 3> kPercentiles = {
+    {{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}}};
+
 std::string FormatMetricValue(const analyzer::metric::MetricResult &metric) {
     return std::visit(
         [](const auto &value) -> std::string {
@@ -63,27 +99,40 @@ std::string FormatAverage(double value) {
     return stream.str();
 }
 
-analyzer::metric_accumulator::MetricsAccumulator BuildSumAverageAccumulator() {
-    analyzer::metric_accumulator::MetricsAccumulator accumulator;
-    rs::for_each(kAggregatedMetricNames, [&](std::string_view metric_name) {
-        accumulator.RegisterAccumulator(std::string(metric_name), std::make_unique<SumAverageAccumulator>());
-    });
+// С --call-graph к сводным метрикам добавляются метрики графа вызовов: сумма unreferenced — число таких функций
+GroupedSumAverageAccumulator AggregateMetrics(const analyzer::FunctionAnalysis &analysis, bool with_call_graph) {
+    auto metric_names = kAggregatedMetricNames
+                        | rv::transform([](std::string_view metric_name) { return std::string(metric_name); })
+                        | rs::to<std::vector>();
+    if (with_call_graph)
+        metric_names.insert(metric_names.end(),
+                            {std::string(analyzer::calls::kFanInMetric), std::string(analyzer::calls::kFanOutMetric),
+                             std::string(analyzer::calls::kUnreferencedMetric)});
+    GroupedSumAverageAccumulator accumulator(
+        std::move(metric_names),
+        {analyzer::metric_accumulator::GlobalLevel(), analyzer::metric_accumulator::FileLevel(),
+         analyzer::metric_accumulator::ClassLevel()});
+    accumulator.Accumulate(analysis);
+    return accumulator;
+}
+
+GroupedQuantileAccumulator AggregatePercentiles(const analyzer::FunctionAnalysis &analysis) {
+    GroupedQuantileAccumulator accumulator(
+        kPercentileMetricNames | rv::transform([](std::string_view metric_name) { return std::string(metric_name); })
+            | rs::to<std::vector>(),
+        {analyzer::metric_accumulator::GlobalLevel(), analyzer::metric_accumulator::FileLevel()});
+    accumulator.Accumulate(analysis);
     return accumulator;
 }
 
-std::vector<AggregatedMetric> AggregateMetrics(const analyzer::FunctionAnalysis &analysis) {
-    auto accumulator = BuildSumAverageAccumulator();
-    analyzer::AccumulateFunctionAnalysis(analysis, accumulator);
-    auto aggregated =
-        kAggregatedMetricNames
-        | rv::transform([&](std::string_view metric_name) {
-              const auto &acc =
-                  accumulator.GetFinalizedAccumulator<SumAverageAccumulator>(std::string(metric_name));
-              return AggregatedMetric{std::string(metric_name), acc.Get()};
-          })
-        | rs::to<std::vector>();
-    accumulator.ResetAccumulators();
-    return aggregated;
+std::vector<AggregatedMetric> CollectAggregatedMetrics(GroupedSumAverageAccumulator &accumulator, std::size_t level,
+                                                       std::size_t group) {
+    return rv::iota(std::size_t{0}, accumulator.GetMetricNames().size())
+           | rv::transform([&](std::size_t metric) {
+                 const auto &acc = accumulator.GetFinalizedAccumulator(level, group, metric);
+                 return AggregatedMetric{accumulator.GetMetricNames()[metric], acc.Get()};
+             })
+           | rs::to<std::vector>();
 }
 
 void PrintAggregatedMetrics(std::string_view indent, const std::vector<AggregatedMetric> &metrics) {
@@ -93,6 +142,38 @@ void PrintAggregatedMetrics(std::string_view indent, const std::vector<Aggregate
     });
 }
 
+void PrintAggregatedGroup(std::string_view indent, GroupedSumAverageAccumulator &accumulator, std::size_t level,
+                          std::size_t group) {
+    PrintAggregatedMetrics(indent, CollectAggregatedMetrics(accumulator, level, group));
+}
+
+void PrintAggregatedGroup(std::string_view indent, GroupedQuantileAccumulator &accumulator, std::size_t level,
+                          std::size_t group) {
+    for (std::size_t metric = 0; metric < accumulator.GetMetricNames().size(); ++metric) {
+        const auto &acc = accumulator.GetFinalizedAccumulator(level, group, metric);
+        std::cout << indent << accumulator.GetMetricNames()[metric] << ':';
+        for (auto [label, q] : kPercentiles)
+            std::cout << ' ' << label << '=' << acc.Get(q);
+        std::cout << '\n';
+    }
+}
+
+void PrintMostComplexFunctions(const analyzer::FunctionAnalysis &analysis, std::size_t count) {
+    if (analysis.empty() || count == 0)
+        return;
+
+    analyzer::metric_accumulator::MetricsAccumulator accumulator;
+    const auto handle =
+        accumulator.RegisterAccumulator("cyclomatic_complexity", std::make_unique<TopKAccumulator>(count));
+    analyzer::AccumulateFunctionAnalysisBatch(analysis, accumulator);
+
+    std::cout << "\nСамые сложные функции (cyclomatic_complexity):\n";
+    rs::for_each(accumulator.GetFinalizedAccumulator(handle).Get(), [](const TopKAccumulator::Entry &entry) {
+        std::cout << "  " << entry.value << "  " << entry.function.filename << " :: " << entry.function.qualified_name
+                  << '\n';
+    });
+}
+
 void RunDebugSnippet() {
     try {
         analyzer::file::File file("files/sample.py");
@@ -153,30 +234,448 @@ void PrintGroupedAnalysis(std::string_view title, const analyzer::GroupedFunctio
     });
 }
 
-void PrintAggregatedSummary(std::string_view title, const analyzer::FunctionAnalysis &analysis) {
-    if (analysis.empty())
+template <typename GroupedAccumulator>
+void PrintAggregatedSummary(std::string_view title, GroupedAccumulator &accumulator) {
+    if (accumulator.GetGroups(kGlobalLevel).empty())
         return;
 
     std::cout << '\n' << title << ":\n";
-    PrintAggregatedMetrics("  ", AggregateMetrics(analysis));
+    PrintAggregatedGroup("  ", accumulator, kGlobalLevel, 0);
 }
 
-template <typename HeaderFormatter>
-void PrintGroupedAggregations(std::string_view title, const analyzer::GroupedFunctionAnalysis &grouped,
+template <typename GroupedAccumulator, typename HeaderFormatter>
+void PrintGroupedAggregations(std::string_view title, GroupedAccumulator &accumulator, std::size_t level,
                               HeaderFormatter &&header_formatter) {
-    if (grouped.empty())
+    // Группы, опустевшие после Retract, не печатаются
+    const auto &groups = accumulator.GetGroups(level);
+    const auto printable = [&](std::size_t group) {
+        return groups[group].functions > 0 && groups[group].representative != nullptr;
+    };
+    if (rs::none_of(rv::iota(std::size_t{0}, groups.size()), printable))
         return;
 
     std::cout << '\n' << title << ":\n";
-    rs::for_each(grouped, [&](const analyzer::FunctionAnalysis &group) {
-        if (group.empty())
-            return;
+    for (std::size_t group = 0; group < groups.size(); ++group) {
+        if (!printable(group))
+            continue;
+        std::cout << "  " << header_formatter(*groups[group].representative) << '\n';
+        PrintAggregatedGroup("    ", accumulator, level, group);
+    }
+}
 
-        std::cout << "  " << header_formatter(group.front().first) << '\n';
-        PrintAggregatedMetrics("    ", AggregateMetrics(group));
+void PrintAnalysisErrors(const analyzer::AnalysisErrors &errors) {
+    if (errors.empty())
+        return;
+
+    std::cout << "\nОшибки анализа (" << errors.size() << "):\n";
+    rs::for_each(errors, [](const analyzer::AnalysisError &error) {
+        std::cout << "  [" << analyzer::ToString(error.error.code) << "] " << error.filename;
+        if (!error.function.empty())
+            std::cout << " :: " << error.function;
+        if (!error.metric_name.empty())
+            std::cout << " (" << error.metric_name << ')';
+        std::cout << ": " << error.error.message << '\n';
     });
 }
 
+void PrintScheduleProfile(const analyzer::schedule::ScheduleProfile &profile) {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    std::cout << "\nПрофиль планирования (" << profile.workers << " воркеров):\n";
+    std::cout << "  makespan: " << FormatAverage(Milliseconds(profile.makespan).count()) << " мс\n";
+    std::cout << "  идеал: " << FormatAverage(Milliseconds(profile.Ideal()).count()) << " мс\n";
+    std::cout << "  суммарная работа: " << FormatAverage(Milliseconds(profile.total_work).count()) << " мс\n";
+    std::cout << "  самый долгий файл: " << FormatAverage(Milliseconds(profile.longest_task).count()) << " мс\n";
+    std::cout << "  эффективность: " << FormatAverage(profile.Efficiency() * 100.0) << "%\n";
+}
+
+// Файлы, списки путей и обход каталогов пишут в paths; очередь закрывается в конце
+void PushInputPaths(const analyzer::cmd::ProgramOptions &options, analyzer::PathQueue &paths,
+                    analyzer::AnalysisErrors &input_errors) {
+    for (const auto &file : options.GetFiles())
+        paths.Push(file);
+    try {
+        for (const auto &list : options.GetFileLists())
+            if (auto read = analyzer::input::ReadPathList(list, paths); !read)
+                input_errors.push_back({.filename = list, .error = std::move(read.error())});
+
+        auto walk_errors = analyzer::walk::Walk(options.GetDirectories(),
+                                                {.exclude = options.GetExcludePatterns(),
+                                                 .read_gitignore = options.GitignoreEnabled(),
+                                                 .threads = options.GetJobs()},
+                                                paths);
+        for (auto &walk_error : walk_errors)
+            input_errors.push_back({.filename = walk_error.path, .error = std::move(walk_error.error)});
+    } catch (const std::exception &e) {
+        input_errors.push_back({.error = {analyzer::ErrorCode::kIo, e.what()}});
+    }
+    paths.Close();
+}
+
+// С --git-rev файлы берутся из базы объектов git. Без каталогов и списков путей файлы известны заранее
+// и планируются от больших к меньшим. Иначе
+// источники пишут в очередь в отдельном потоке, а анализ начинается с первых путей. Результаты обхода
+// каталогов сортируются по пути, чтобы отчёт не зависел от порядка, в котором потоки нашли файлы
+analyzer::FunctionAnalysis AnalyseInputs(const analyzer::cmd::ProgramOptions &options,
+                                         const analyzer::metric::MetricExtractor &metric_extractor,
+                                         analyzer::AnalysisErrors &errors, std::pmr::memory_resource *resource,
+                                         const analyzer::AnalysisLimits &limits,
+                                         analyzer::schedule::ScheduleProfile &profile) {
+    if (!options.GetGitRevision().empty()) {
+        analyzer::cache::ResultCache cache(options.GetCacheDirectory(), options.GetCacheEntries());
+        return analyzer::AnalyseRevision(".", options.GetGitRevision(), metric_extractor, errors,
+                                         options.GetJobs(), resource, limits, &cache, &profile);
+    }
+    if (options.GetDirectories().empty() && options.GetFileLists().empty())
+        return analyzer::AnalyseFunctionsParallel(options.GetFiles(), metric_extractor, errors, options.GetJobs(),
+                                                  resource, limits, &profile);
+
+    analyzer::PathQueue paths;
+    analyzer::AnalysisErrors input_errors;
+    std::jthread producer([&] { PushInputPaths(options, paths, input_errors); });
+    auto analysis = analyzer::AnalyseFunctionsStreaming(paths, metric_extractor, errors, options.GetJobs(),
+                                                        resource, limits, &profile);
+    producer.join();
+
+    errors.insert(errors.end(), std::make_move_iterator(input_errors.begin()),
+                  std::make_move_iterator(input_errors.end()));
+    if (!options.GetDirectories().empty()) {
+        rs::stable_sort(analysis, {}, [](const analyzer::FunctionAnalysisEntry &entry) {
+            return entry.first.filename.View();
+        });
+        rs::stable_sort(errors, {}, [](const analyzer::AnalysisError &error) { return error.filename.View(); });
+    }
+    return analysis;
+}
+
+// С --changed-since в отчёт попадают только изменённые функции; base_index сопоставляет их с базовой ревизией
+analyzer::FunctionAnalysis AnalyseChangedFunctions(const analyzer::cmd::ProgramOptions &options,
+                                                   const analyzer::metric::MetricExtractor &metric_extractor,
+                                                   analyzer::AnalysisErrors &errors,
+                                                   std::pmr::memory_resource *resource,
+                                                   const analyzer::AnalysisLimits &limits,
+                                                   analyzer::schedule::ScheduleProfile &profile,
+                                                   analyzer::ChangeAnalysis &changes) {
+    analyzer::cache::ResultCache cache(options.GetCacheDirectory(), options.GetCacheEntries());
+    changes = analyzer::AnalyseChanges(".", options.GetChangedSince(), metric_extractor, errors, options.GetJobs(),
+                                       resource, limits, &cache, &profile);
+    return std::move(changes.changed);
+}
+
+void PrintMetricDeltas(const analyzer::FunctionAnalysis &changed, const analyzer::ChangeAnalysis &changes,
+                       std::string_view base_rev) {
+    std::cout << "\nИзменения метрик относительно " << base_rev << ":\n";
+    if (changed.empty()) {
+        std::cout << "  Изменённых функций нет.\n";
+        return;
+    }
+
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        const auto &[func, metrics] = changed[i];
+        const auto *base = changes.base_index[i] ? &changes.base[*changes.base_index[i]].second : nullptr;
+        std::cout << "  " << func.filename << " :: " << analyzer::function::QualifiedName(func)
+                  << (base ? "\n" : " (новая функция)\n");
+
+        rs::for_each(metrics, [&](const analyzer::metric::MetricResult &metric) {
+            std::cout << "    " << metric.metric_name << ": ";
+            const analyzer::metric::MetricResult *previous = nullptr;
+            if (base) {
+                const auto it = rs::find(*base, metric.metric_name, &analyzer::metric::MetricResult::metric_name);
+                previous = it == base->end() ? nullptr : &*it;
+            }
+            if (!previous) {
+                std::cout << FormatMetricValue(metric) << '\n';
+                return;
+            }
+            std::cout << FormatMetricValue(*previous) << " -> " << FormatMetricValue(metric);
+            const auto *before = std::get_if<int>(&previous->value);
+            const auto *after = std::get_if<int>(&metric.value);
+            if (before && after)
+                std::cout << " (" << (*after >= *before ? "+" : "") << *after - *before << ')';
+            std::cout << '\n';
+        });
+    }
+}
+
+std::string NormalizePath(const std::string &path) {
+    return std::filesystem::path(path).lexically_normal().string();
+}
+
+// Входные файлы режимов --watch и --clones; пути нормализованы так же, как пути из событий inotify
+std::vector<std::string> CollectWatchInputs(const analyzer::cmd::ProgramOptions &options,
+                                            analyzer::AnalysisErrors &input_errors) {
+    analyzer::PathQueue paths;
+    PushInputPaths(options, paths, input_errors);
+    std::vector<std::string> files;
+    while (auto queued = paths.Pop())
+        files.push_back(NormalizePath(queued->path));
+    return files;
+}
+
+std::vector<SumAverageStats> GlobalAggregates(const analyzer::LiveAnalysis &live) {
+    const auto &aggregates = live.GetAggregates();
+    return rv::iota(std::size_t{0}, aggregates.GetMetricNames().size()) | rv::transform([&](std::size_t metric) {
+               return aggregates.GetGroups(analyzer::LiveAnalysis::kGlobalLevel).empty()
+                          ? SumAverageStats{}
+                          : aggregates.GetFinalizedCopy(analyzer::LiveAnalysis::kGlobalLevel, 0, metric).Get();
+           })
+           | rs::to<std::vector>();
+}
+
+void PrintAggregateDeltas(std::string_view indent, const std::vector<std::string> &metric_names,
+                          const std::vector<SumAverageStats> &before, const std::vector<SumAverageStats> &after) {
+    for (std::size_t metric = 0; metric < metric_names.size(); ++metric) {
+        std::cout << indent << metric_names[metric] << ": sum=" << after[metric].sum;
+        if (const auto delta = after[metric].sum - before[metric].sum; delta != 0)
+            std::cout << " (" << (delta > 0 ? "+" : "") << delta << ')';
+        std::cout << ", avg=" << FormatAverage(after[metric].average) << '\n';
+    }
+}
+
+void PrintWatchUpdate(const analyzer::LiveAnalysis &live, const std::string &path,
+                      const std::vector<SumAverageStats> &before, std::chrono::steady_clock::duration elapsed) {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto *results = live.Find(path);
+    std::cout << '\n' << path << (results ? ": обновлён за " : ": удалён за ")
+              << FormatAverage(Milliseconds(elapsed).count()) << " мс\n";
+    if (results) {
+        rs::for_each(results->analysis, [](const analyzer::FunctionAnalysisEntry &entry) {
+            PrintFunctionMetrics(entry, "  ", false);
+        });
+        PrintAnalysisErrors(results->errors);
+    }
+    std::cout << "Сводные метрики по всем функциям:\n";
+    PrintAggregateDeltas("  ", live.GetAggregates().GetMetricNames(), before, GlobalAggregates(live));
+    std::cout << std::flush;
+}
+
+// --watch: результаты и сводные метрики держатся в памяти, после сохранения файла разбирается только он,
+// а сводные метрики обновляются снятием старых значений и добавлением новых. Новые файлы в каталогах
+// проверяются по --exclude, но не по .gitignore. Работает до прерывания
+int RunWatch(const analyzer::cmd::ProgramOptions &options, const analyzer::metric::MetricExtractor &metric_extractor,
+             const analyzer::AnalysisLimits &limits) {
+    analyzer::LiveAnalysis live(
+        metric_extractor,
+        kAggregatedMetricNames | rv::transform([](std::string_view metric_name) { return std::string(metric_name); })
+            | rs::to<std::vector>(),
+        limits);
+    analyzer::AnalysisErrors errors;
+    live.Load(CollectWatchInputs(options, errors), options.GetJobs());
+    live.ForEachFile([&](const std::string &, const analyzer::LiveAnalysis::FileResults &results) {
+        errors.insert(errors.end(), results.errors.begin(), results.errors.end());
+    });
+
+    const auto initial = GlobalAggregates(live);
+    std::cout << "Файлов: " << live.FilesCount() << "\nСводные метрики по всем функциям:\n";
+    PrintAggregateDeltas("  ", live.GetAggregates().GetMetricNames(), initial, initial);
+    PrintAnalysisErrors(errors);
+
+    auto watcher = analyzer::watch::Watcher::Create();
+    if (!watcher) {
+        std::cerr << "Ошибка: " << watcher.error().message << '\n';
+        return EXIT_FAILURE;
+    }
+    const auto roots = options.GetDirectories() | rv::transform(NormalizePath) | rs::to<std::vector>();
+    std::vector<std::pair<std::string, bool>> directories;
+    rs::transform(roots, std::back_inserter(directories),
+                  [](const std::string &root) { return std::pair{root, true}; });
+    // Файлы вне корней обхода (явные и из списков): наблюдение за их каталогами без подкаталогов
+    live.ForEachFile([&](const std::string &path, const analyzer::LiveAnalysis::FileResults &) {
+        const auto parent = std::filesystem::path(path).parent_path();
+        directories.emplace_back(parent.empty() ? "." : parent.string(), false);
+    });
+    rs::sort(directories);
+    directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+    for (const auto &[directory, recursive] : directories) {
+        if (auto watched = (*watcher)->WatchDirectory(directory, recursive); !watched) {
+            std::cerr << "Ошибка: " << watched.error().message << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    analyzer::walk::IgnoreRules exclude;
+    for (const auto &pattern : options.GetExcludePatterns())
+        exclude.Add(pattern);
+    const auto is_input = [&](const std::string &path) {
+        if (live.Find(path))
+            return true;
+        if (!path.ends_with(".py"))
+            return false;
+        return rs::any_of(roots, [&](const std::string &root) {
+            const auto relative = std::filesystem::path(path).lexically_relative(root);
+            if (relative.empty() || *relative.begin() == "..")
+                return false;
+            // Исключённый каталог исключает и всё внутри
+            std::filesystem::path prefix;
+            for (const auto &part : relative) {
+                prefix /= part;
+                if (exclude.IsIgnored(prefix.generic_string(), prefix != relative))
+                    return false;
+            }
+            return true;
+        });
+    };
+
+    std::cout << "\nОжидание изменений, Ctrl+C для выхода\n" << std::flush;
+    for (;;) {
+        auto changes = (*watcher)->Wait();
+        if (!changes) {
+            std::cerr << "Ошибка: " << changes.error().message << '\n';
+            return EXIT_FAILURE;
+        }
+        for (const auto &warning : changes->warnings)
+            std::cerr << "Предупреждение: " << warning.message << '\n';
+
+        if (changes->overflowed) {
+            // Часть событий потеряна: входы собираются заново, исчезнувшие файлы удаляются
+            const auto before = GlobalAggregates(live);
+            const auto start = std::chrono::steady_clock::now();
+            analyzer::AnalysisErrors reload_errors;
+            const auto files = CollectWatchInputs(options, reload_errors);
+            live.Load(files, options.GetJobs());
+            std::vector<std::string> known;
+            live.ForEachFile([&](const std::string &path, const auto &) { known.push_back(path); });
+            for (const auto &path : known)
+                if (rs::find(files, path) == files.end())
+                    live.Update(path);
+            PrintWatchUpdate(live, "*", before, std::chrono::steady_clock::now() - start);
+            PrintAnalysisErrors(reload_errors);
+            continue;
+        }
+
+        // Файлы удалённых и унесённых каталогов: ядро сообщает только о самом каталоге
+        std::vector<std::string> updated;
+        for (const auto &directory : changes->removed_directories | rv::transform(NormalizePath)) {
+            live.ForEachFile([&](const std::string &path, const analyzer::LiveAnalysis::FileResults &) {
+                const auto relative = std::filesystem::path(path).lexically_relative(directory);
+                if (!relative.empty() && *relative.begin() != "..")
+                    updated.push_back(path);
+            });
+        }
+        rs::transform(changes->paths, std::back_inserter(updated), NormalizePath);
+        std::unordered_set<std::string> seen;
+        for (const auto &path : updated) {
+            if (!seen.insert(path).second || !is_input(path))
+                continue;
+            const auto before = GlobalAggregates(live);
+            const auto start = std::chrono::steady_clock::now();
+            if (live.Update(path))
+                PrintWatchUpdate(live, path, before, std::chrono::steady_clock::now() - start);
+        }
+    }
+}
+
+// --connect: пути и буфер из stdin уходят работающему демону, а его ответ превращается в обычный анализ.
+// Демон читает файлы в своём рабочем каталоге, поэтому пути отправляются абсолютными, а в отчёте остаются
+// такими, как их передали. Без демона прогон завершается ошибкой
+analyzer::FunctionAnalysis AnalyseViaDaemon(const analyzer::cmd::ProgramOptions &options,
+                                            analyzer::AnalysisErrors &errors, std::pmr::memory_resource *resource) {
+    analyzer::PathQueue paths;
+    PushInputPaths(options, paths, errors);
+    std::vector<std::string> names;
+    while (auto queued = paths.Pop())
+        names.push_back(std::move(queued->path));
+    if (!options.GetDirectories().empty())
+        rs::stable_sort(names);
+
+    analyzer::daemon::Request request;
+    for (const auto &name : names)
+        request.items.push_back({.name = std::filesystem::absolute(name).string(), .content = std::nullopt});
+    if (!options.GetStdinName().empty()) {
+        names.push_back(options.GetStdinName());
+        request.items.push_back({.name = options.GetStdinName(),
+                                 .content = std::string(std::istreambuf_iterator<char>(std::cin), {})});
+    }
+
+    auto response = analyzer::daemon::Call(options.GetConnectSocket(), request);
+    if (!response)
+        throw std::runtime_error(response.error().message);
+
+    analyzer::FunctionAnalysis analysis;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        const analyzer::interner::InternedString filename(names[i]);
+        auto &item = response->items[i];
+        analyzer::detail::AppendCachedFile(item.result, filename, resource, analysis);
+        rs::transform(item.errors, std::back_inserter(errors), [&](analyzer::daemon::ErrorRecord &error) {
+            return analyzer::AnalysisError{.filename = filename,
+                                           .function = std::move(error.function),
+                                           .metric_name = error.metric_name,
+                                           .error = {error.code, std::move(error.message)}};
+        });
+    }
+    return analysis;
+}
+
+// Демон, которого останавливают SIGINT и SIGTERM; Stop безопасен в обработчике сигнала
+std::atomic<analyzer::daemon::AnalysisDaemon *> running_daemon = nullptr;
+
+void StopRunningDaemon(int) {
+    if (auto *daemon = running_daemon.load())
+        daemon->Stop();
+}
+
+// --daemon: метрики и кеш результатов живут между запросами, клиенты обслуживаются до SIGINT или SIGTERM,
+// после чего файл сокета удаляется. С --cache-dir кеш переживает и перезапуск демона
+int RunDaemon(const analyzer::cmd::ProgramOptions &options, const analyzer::metric::MetricExtractor &metric_extractor,
+              const analyzer::AnalysisLimits &limits) {
+    analyzer::cache::ResultCache cache(options.GetCacheDirectory(), options.GetCacheEntries());
+    analyzer::daemon::AnalysisDaemon daemon(metric_extractor, cache, options.GetJobs(), limits.parse);
+    if (auto listening = daemon.Listen(options.GetDaemonSocket()); !listening) {
+        std::cerr << "Ошибка: " << listening.error().message << '\n';
+        return EXIT_FAILURE;
+    }
+
+    running_daemon = &daemon;
+    std::signal(SIGINT, StopRunningDaemon);
+    std::signal(SIGTERM, StopRunningDaemon);
+    std::cout << "Демон слушает " << options.GetDaemonSocket() << ", воркеров: " << options.GetJobs() << '\n'
+              << std::flush;
+    const auto served = daemon.Serve();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    running_daemon = nullptr;
+
+    std::cout << "Кеш: попаданий " << cache.Hits() << ", промахов " << cache.Misses() << '\n';
+    if (!served) {
+        std::cerr << "Ошибка: " << served.error().message << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Файл перезаписывается, только если в прогоне появились новые записи
+void SaveMemoFile(const analyzer::cmd::ProgramOptions &options, const analyzer::metric::MetricMemo &memo) {
+    if (options.GetMemoFile().empty() || memo.Misses() == 0)
+        return;
+    if (!analyzer::cache::SaveMemo(memo, options.GetMemoFile()))
+        std::cerr << "Ошибка: не удалось сохранить " << options.GetMemoFile() << '\n';
+}
+
+// --clones: вместо метрик печатаются классы одинаковых поддеревьев, строки с единицы
+int RunClones(const analyzer::cmd::ProgramOptions &options, const analyzer::AnalysisLimits &limits) {
+    analyzer::AnalysisErrors errors;
+    const auto files = CollectWatchInputs(options, errors);
+    analyzer::schedule::ScheduleProfile profile;
+    const auto classes = analyzer::FindClones(files,
+                                              {.min_nodes = options.GetCloneMinNodes(),
+                                               .normalize_identifiers = options.CloneNormalizeIdentifiers()},
+                                              errors, options.GetJobs(), limits, &profile);
+
+    std::cout << "Клоны (" << classes.size() << "):\n";
+    for (const auto &clone : classes) {
+        std::cout << "  " << clone.locations.front().node_type << ", узлов: " << clone.nodes
+                  << ", копий: " << clone.locations.size() << '\n';
+        // Конец поддерева — позиция после него: [5, 0] означает, что последняя строка пятая
+        for (const auto &location : clone.locations)
+            std::cout << "    " << location.filename << ':' << location.start.line + 1 << '-'
+                      << std::max(location.start.line + 1, location.end.line + (location.end.column > 0 ? 1 : 0))
+                      << '\n';
+    }
+    PrintAnalysisErrors(errors);
+    if (options.ProfileEnabled())
+        PrintScheduleProfile(profile);
+    return EXIT_SUCCESS;
+}
+
 bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
     return lhs.size() == rhs.size() &&
            std::ranges::equal(lhs, rhs, [](char l, char r) {
@@ -198,41 +697,83 @@ int main(int argc, char *argv[]) {
     metric_extractor.RegisterMetric(std::make_unique<analyzer::metric::metric_impl::CodeLinesCountMetric>());
     metric_extractor.RegisterMetric(std::make_unique<analyzer::metric::metric_impl::CyclomaticComplexityMetric>());
     metric_extractor.RegisterMetric(std::make_unique<analyzer::metric::metric_impl::CountParametersMetric>());
+    // Одинаковые тела функций (вендоренный и сгенерированный код) не пересчитывают структурные метрики
+    analyzer::metric::MetricMemo memo(options.GetMemoEntries());
+    metric_extractor.memo = &memo;
+    metric_extractor.collect_callees = options.CallGraphEnabled();
+    if (!options.GetMemoFile().empty())
+        analyzer::cache::LoadMemo(options.GetMemoFile(), memo);
 
     try {
-        const auto &files = options.GetFiles();
-        auto analysis = analyzer::AnalyseFunctions(files, metric_extractor);
+        // Строки функций и результаты метрик нужны до конца отчёта и освобождаются одним шагом
+        std::pmr::monotonic_buffer_resource analysis_arena;
+        // Файлы с ошибками, таймаутом или вне бюджета пропускаются, прогон продолжается;
+        // ошибки печатаются в конце отчёта
+        analyzer::AnalysisErrors errors;
+        const analyzer::AnalysisLimits limits{
+            .parse = {.timeout = options.GetParseTimeout(), .max_output_bytes = options.GetMaxAstBytes()},
+            .budget = options.GetTimeBudget()};
+        if (options.WatchEnabled())
+            return RunWatch(options, metric_extractor, limits);
+        if (options.ClonesEnabled())
+            return RunClones(options, limits);
+        if (!options.GetDaemonSocket().empty()) {
+            const int code = RunDaemon(options, metric_extractor, limits);
+            SaveMemoFile(options, memo);
+            return code;
+        }
+        analyzer::schedule::ScheduleProfile profile;
+        analyzer::ChangeAnalysis changes;
+        analyzer::FunctionAnalysis analysis;
+        if (!options.GetConnectSocket().empty())
+            analysis = AnalyseViaDaemon(options, errors, &analysis_arena);
+        else if (!options.GetChangedSince().empty())
+            analysis = AnalyseChangedFunctions(options, metric_extractor, errors, &analysis_arena, limits, profile,
+                                               changes);
+        else
+            analysis = AnalyseInputs(options, metric_extractor, errors, &analysis_arena, limits, profile);
+        if (options.CallGraphEnabled())
+            analyzer::AppendCallGraphMetrics(analysis);
 
         PrintAnalysisSummary(analysis);
 
-        auto grouped_by_file = analyzer::SplitByFiles(analysis);
-        PrintGroupedAnalysis("Метрики по файлам", grouped_by_file,
-                             [](const analyzer::function::Function &func) { return "Файл: " + func.filename; });
-
-        auto grouped_by_class = analyzer::SplitByClasses(analysis);
-        PrintGroupedAnalysis("Метрики по классам", grouped_by_class, [](const analyzer::function::Function &func) {
+        const auto file_header = [](const analyzer::function::Function &func) {
+            return "Файл: " + std::string(func.filename.View());
+        };
+        const auto class_header = [](const analyzer::function::Function &func) {
             std::string header = "Класс: ";
             if (func.class_name)
-                header += *func.class_name;
+                header += func.class_name->View();
             else
                 header += "<без имени>";
-            header += " (файл " + func.filename + ')';
+            header.append(" (файл ").append(func.filename.View()).push_back(')');
             return header;
-        });
+        };
 
-        PrintAggregatedSummary("Сводные метрики по всем функциям", analysis);
-        PrintGroupedAggregations("Сводные метрики по файлам", grouped_by_file,
-                                 [](const analyzer::function::Function &func) { return "Файл: " + func.filename; });
-        PrintGroupedAggregations(
-            "Сводные метрики по классам", grouped_by_class, [](const analyzer::function::Function &func) {
-                std::string header = "Класс: ";
-                if (func.class_name)
-                    header += *func.class_name;
-                else
-                    header += "<без имени>";
-                header += " (файл " + func.filename + ')';
-                return header;
-            });
+        auto grouped_by_file = analyzer::SplitByFiles(analysis);
+        PrintGroupedAnalysis("Метрики по файлам", grouped_by_file, file_header);
+
+        auto grouped_by_class = analyzer::SplitByClasses(analysis);
+        PrintGroupedAnalysis("Метрики по классам", grouped_by_class, class_header);
+
+        auto aggregated = AggregateMetrics(analysis, options.CallGraphEnabled());
+        PrintAggregatedSummary("Сводные метрики по всем функциям", aggregated);
+        PrintGroupedAggregations("Сводные метрики по файлам", aggregated, kFileLevel, file_header);
+        PrintGroupedAggregations("Сводные метрики по классам", aggregated, kClassLevel, class_header);
+
+        auto percentiles = AggregatePercentiles(analysis);
+        PrintAggregatedSummary("Перцентили по всем функциям", percentiles);
+        PrintGroupedAggregations("Перцентили по файлам", percentiles, kFileLevel, file_header);
+
+        PrintMostComplexFunctions(analysis, options.GetTopCount());
+        if (!options.GetChangedSince().empty())
+            PrintMetricDeltas(analysis, changes, options.GetChangedSince());
+        PrintAnalysisErrors(errors);
+        if (options.ProfileEnabled()) {
+            PrintScheduleProfile(profile);
+            std::cout << "  мемоизация метрик: попаданий " << memo.Hits() << ", промахов " << memo.Misses() << '\n';
+        }
+        SaveMemoFile(options, memo);
 
         return EXIT_SUCCESS;
     } catch (const std::exception &e) {
@@ -0,0 +1,302 @@
+#include "analysis_daemon.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <latch>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "analyse.hpp"
+
+namespace analyzer::daemon {
+
+namespace {
+
+Error SocketError(const std::string &what) { return Error{ErrorCode::kIo, what + ": " + std::strerror(errno)}; }
+
+git::TempDirectory CreateBufferDirectory() {
+    auto directory = git::TempDirectory::Create("analyzerd-");
+    if (!directory)
+        throw std::runtime_error(directory.error().message);
+    return std::move(*directory);
+}
+
+// Id содержимого для ключа кеша: FNV-1a и размер. Путь в ключ не входит, поэтому буфер редактора
+// и сохранённый файл с тем же текстом дают одну запись
+std::string ContentId(std::string_view content) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char ch : content)
+        hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+    std::ostringstream id;
+    id << std::hex << std::setw(16) << std::setfill('0') << hash << '-' << std::dec << content.size();
+    return id.str();
+}
+
+sockaddr_un SocketAddress(const std::string &socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    return address;
+}
+
+// Файл сокета на пути: удаляется, только если это сокет, который никто не слушает
+Expected<void> RemoveStaleSocket(const std::string &socket_path) {
+    struct stat info {};
+    if (lstat(socket_path.c_str(), &info) < 0)
+        return errno == ENOENT ? Expected<void>{} : std::unexpected(SocketError("Failed to stat " + socket_path));
+    if (!S_ISSOCK(info.st_mode))
+        return MakeError(ErrorCode::kIo, socket_path + " exists and is not a socket");
+
+    const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0)
+        return std::unexpected(SocketError("Failed to create socket"));
+    const auto address = SocketAddress(socket_path);
+    const bool alive = connect(probe, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+    close(probe);
+    if (alive)
+        return MakeError(ErrorCode::kIo, "Another daemon is listening on " + socket_path);
+    if (unlink(socket_path.c_str()) < 0)
+        return std::unexpected(SocketError("Failed to remove stale socket " + socket_path));
+    return {};
+}
+
+}  // namespace
+
+AnalysisDaemon::AnalysisDaemon(const analyzer::metric::MetricExtractor &metric_extractor, cache::ResultCache &cache,
+                               std::size_t workers, const file::ParseLimits &limits)
+    : metric_extractor_(metric_extractor),
+      cache_(cache),
+      limits_(limits),
+      buffers_(CreateBufferDirectory()),
+      scratch_(std::max<std::size_t>(workers, 1)) {
+    if (pipe2(wake_pipe_, O_CLOEXEC | O_NONBLOCK) < 0)
+        throw std::runtime_error("Failed to create pipe: " + std::string(std::strerror(errno)));
+    workers_.reserve(scratch_.size());
+    for (std::size_t worker = 0; worker < scratch_.size(); ++worker)
+        workers_.emplace_back([this, worker] { WorkerLoop(worker); });
+}
+
+AnalysisDaemon::~AnalysisDaemon() {
+    ReapConnections(true);
+    {
+        std::lock_guard lock(tasks_mutex_);
+        stopping_workers_ = true;
+    }
+    tasks_ready_.notify_all();
+    workers_.clear();
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+}
+
+Expected<void> AnalysisDaemon::Listen(const std::string &socket_path) {
+    if (socket_path.size() >= sizeof(sockaddr_un::sun_path))
+        return MakeError(ErrorCode::kIo, "Socket path is too long: " + socket_path);
+    if (auto removed = RemoveStaleSocket(socket_path); !removed)
+        return removed;
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return std::unexpected(SocketError("Failed to create socket"));
+    const auto address = SocketAddress(socket_path);
+    if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) {
+        auto error = SocketError("Failed to bind " + socket_path);
+        close(fd);
+        return std::unexpected(std::move(error));
+    }
+    // Демон читает любые файлы с правами владельца: чужим пользователям сокет недоступен
+    if (chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) < 0 || listen(fd, SOMAXCONN) < 0) {
+        auto error = SocketError("Failed to listen on " + socket_path);
+        close(fd);
+        unlink(socket_path.c_str());
+        return std::unexpected(std::move(error));
+    }
+    listen_fd_ = fd;
+    socket_path_ = socket_path;
+    return {};
+}
+
+Expected<void> AnalysisDaemon::Serve() {
+    std::array<pollfd, 2> descriptors{pollfd{.fd = listen_fd_, .events = POLLIN, .revents = 0},
+                                      pollfd{.fd = wake_pipe_[0], .events = POLLIN, .revents = 0}};
+    Expected<void> result;
+    for (;;) {
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            result = std::unexpected(SocketError("Failed to wait for clients"));
+            break;
+        }
+        if (descriptors[1].revents != 0)
+            break;
+        if (descriptors[0].revents == 0)
+            continue;
+
+        const int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN)
+                continue;
+            result = std::unexpected(SocketError("Failed to accept a client"));
+            break;
+        }
+        ReapConnections(false);
+        std::lock_guard lock(connections_mutex_);
+        auto &connection = connections_.emplace_back(client);
+        connection.thread = std::jthread([this, &connection] { ServeConnection(connection); });
+    }
+
+    ReapConnections(true);
+    char drained;
+    while (read(wake_pipe_[0], &drained, 1) > 0) {
+    }
+    return result;
+}
+
+void AnalysisDaemon::Stop() {
+    const char wake = 1;
+    [[maybe_unused]] const auto written = write(wake_pipe_[1], &wake, 1);
+}
+
+Response AnalysisDaemon::Handle(const Request &request) {
+    Response response;
+    response.items.resize(request.items.size());
+    std::latch done(static_cast<std::ptrdiff_t>(request.items.size()));
+    for (std::size_t i = 0; i < request.items.size(); ++i) {
+        Submit([&, i](std::size_t worker) {
+            auto &result = response.items[i];
+            try {
+                AnalyseItem(request.items[i], result, &scratch_[worker]);
+            } catch (const std::exception &e) {
+                result = ItemResult{.result = {}, .errors = {ErrorRecord{.code = ErrorCode::kIo, .message = e.what()}}};
+            }
+            scratch_[worker].release();
+            done.count_down();
+        });
+    }
+    done.wait();
+    return response;
+}
+
+void AnalysisDaemon::Submit(Task task) {
+    {
+        std::lock_guard lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    tasks_ready_.notify_one();
+}
+
+void AnalysisDaemon::WorkerLoop(std::size_t worker) {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock lock(tasks_mutex_);
+            tasks_ready_.wait(lock, [&] { return stopping_workers_ || !tasks_.empty(); });
+            if (tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task(worker);
+    }
+}
+
+void AnalysisDaemon::AnalyseItem(const RequestItem &item, ItemResult &result, std::pmr::memory_resource *scratch) {
+    io::Source source = item.content ? io::Source(*item.content) : io::ReadWholeFile(item.name);
+    if (!source) {
+        result.errors.push_back(ErrorRecord{.code = source.error().code, .message = std::move(source.error().message)});
+        return;
+    }
+
+    const auto key = detail::RevisionCacheKey(ContentId(*source), metric_extractor_);
+    if (auto cached = cache_.Find(key)) {
+        result.result = *cached;
+        return;
+    }
+
+    // Буфер редактора пишется во временный файл с тем же расширением: по нему tree-sitter выбирает язык
+    std::string parse_path = item.name;
+    if (item.content) {
+        parse_path = (buffers_.Path() / ("buffer-" + std::to_string(next_buffer_++) +
+                                         std::filesystem::path(item.name).extension().string()))
+                         .string();
+        if (!(std::ofstream(parse_path, std::ios::binary) << *source)) {
+            result.errors.push_back(ErrorRecord{.code = ErrorCode::kIo, .message = "Failed to write " + parse_path});
+            return;
+        }
+    }
+    auto file = file::File::Open(parse_path, std::move(source), scratch, limits_);
+    if (item.content)
+        std::filesystem::remove(parse_path);
+    if (!file) {
+        result.errors.push_back(ErrorRecord{.code = file.error().code, .message = std::move(file.error().message)});
+        return;
+    }
+
+    AnalysisErrors errors;
+    const auto analysis = detail::AnalyseOpenedFile(*file, metric_extractor_, scratch, errors);
+    auto cached = std::make_shared<const cache::CachedFile>(detail::ToCachedFile(analysis));
+    if (errors.empty())
+        cache_.Store(key, cached);
+    result.result = *cached;
+    for (auto &error : errors)
+        result.errors.push_back(ErrorRecord{.function = std::move(error.function),
+                                            .metric_name = std::string(error.metric_name.View()),
+                                            .code = error.error.code,
+                                            .message = std::move(error.error.message)});
+}
+
+void AnalysisDaemon::ServeConnection(Connection &connection) {
+    for (;;) {
+        auto frame = ReadFrame(connection.fd);
+        if (!frame || !*frame)
+            break;
+        const auto request = DecodeRequest(**frame);
+        // Повреждённый запрос: отвечать нечем, клиент увидит закрытое соединение
+        if (!request || !WriteFrame(connection.fd, EncodeResponse(Handle(*request))))
+            break;
+    }
+    connection.finished = true;
+}
+
+void AnalysisDaemon::ReapConnections(bool all) {
+    std::list<Connection> finished;
+    {
+        std::lock_guard lock(connections_mutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            auto next = std::next(it);
+            if (all)
+                shutdown(it->fd, SHUT_RDWR);  // Будит поток, ждущий следующий запрос
+            if (all || it->finished)
+                finished.splice(finished.end(), connections_, it);
+            it = next;
+        }
+    }
+    for (auto &connection : finished) {
+        if (connection.thread.joinable())
+            connection.thread.join();
+        close(connection.fd);
+    }
+}
+
+}  // namespace analyzer::daemon
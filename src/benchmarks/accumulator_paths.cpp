@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "function.hpp"
+#include "metric.hpp"
+#include "metric_accumulator.hpp"
+#include "metric_accumulator_impl/accumulators.hpp"
+#include "static_accumulator.hpp"
+
+// Сравнивает накопление через IAccumulator (MetricsAccumulator) и через Bind с аккумуляторами в кортеже.
+// Метрика синтетическая, чтобы в замер не попадали tree-sitter и чтение файлов.
+
+namespace {
+
+using analyzer::metric_accumulator::Bind;
+using analyzer::metric_accumulator::MetricsAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::QuantileAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::SumAverageAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+
+struct AstSizeMetric final : analyzer::metric::IMetric {
+    analyzer::Expected<int> CalculateValue(const analyzer::function::Function &f) const {
+        return static_cast<int>(f.ast.size());
+    }
+
+protected:
+    analyzer::Expected<analyzer::metric::MetricResult::ValueType> CalculateImpl(
+        const analyzer::function::Function &f) const override {
+        return *CalculateValue(f);
+    }
+
+    std::string Name() const override { return "benchmark_ast_size"; }
+};
+
+std::vector<analyzer::function::Function> MakeFunctions(std::size_t count) {
+    std::vector<analyzer::function::Function> functions;
+    functions.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        functions.push_back({.filename = "benchmark.py",
+                             .class_name = std::nullopt,
+                             .name = std::pmr::string("function_" + std::to_string(i)),
+                             .ast = std::pmr::string((i * 7919) % 509, 'x')});
+    return functions;
+}
+
+template <typename Body>
+double MeasureNsPerFunction(std::size_t count, Body &&body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count);
+}
+
+double RunRuntimePath(const std::vector<analyzer::function::Function> &functions, int &checksum) {
+    analyzer::metric::MetricExtractor extractor;
+    extractor.RegisterMetric(std::make_unique<AstSizeMetric>());
+    // MetricsAccumulator держит один аккумулятор на метрику, поэтому три набора
+    MetricsAccumulator sums;
+    MetricsAccumulator quantiles;
+    MetricsAccumulator tops;
+    const auto sum_handle = sums.RegisterAccumulator("benchmark_ast_size", std::make_unique<SumAverageAccumulator>());
+    const auto quantile_handle =
+        quantiles.RegisterAccumulator("benchmark_ast_size", std::make_unique<QuantileAccumulator>());
+    const auto top_handle = tops.RegisterAccumulator("benchmark_ast_size", std::make_unique<TopKAccumulator>());
+
+    const auto ns = MeasureNsPerFunction(functions.size(), [&] {
+        for (const auto &function : functions) {
+            const auto results = extractor.Get(function);
+            sums.AccumulateNextFunctionResults(function, results);
+            quantiles.AccumulateNextFunctionResults(function, results);
+            tops.AccumulateNextFunctionResults(function, results);
+        }
+    });
+    checksum = static_cast<int>(sums.GetFinalizedAccumulator(sum_handle).Get().sum) +
+               quantiles.GetFinalizedAccumulator(quantile_handle).Get(0.9) +
+               tops.GetFinalizedAccumulator(top_handle).Get().front().value;
+    return ns;
+}
+
+double RunStaticPath(const std::vector<analyzer::function::Function> &functions, int &checksum) {
+    Bind<AstSizeMetric, SumAverageAccumulator, QuantileAccumulator, TopKAccumulator> bind;
+
+    const auto ns = MeasureNsPerFunction(functions.size(), [&] {
+        for (const auto &function : functions)
+            bind.Evaluate(function);
+    });
+    checksum = static_cast<int>(bind.GetFinalizedAccumulator<SumAverageAccumulator>().Get().sum) +
+               bind.GetFinalizedAccumulator<QuantileAccumulator>().Get(0.9) +
+               bind.GetFinalizedAccumulator<TopKAccumulator>().Get().front().value;
+    return ns;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    if (count == 0) {
+        std::cerr << "Usage: " << argv[0] << " [functions count > 0]\n";
+        return EXIT_FAILURE;
+    }
+    const auto functions = MakeFunctions(count);
+
+    int runtime_checksum = 0;
+    int static_checksum = 0;
+    const auto runtime_ns = RunRuntimePath(functions, runtime_checksum);
+    const auto static_ns = RunStaticPath(functions, static_checksum);
+
+    std::cout << std::fixed << std::setprecision(1) << "functions: " << count << '\n'
+              << "runtime (IAccumulator): " << runtime_ns << " ns/function\n"
+              << "static (Bind):          " << static_ns << " ns/function\n"
+              << "speedup: " << runtime_ns / static_ns << "x\n";
+
+    if (runtime_checksum != static_checksum) {
+        std::cerr << "Checksum mismatch: " << runtime_checksum << " vs " << static_checksum << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
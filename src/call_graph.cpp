@@ -0,0 +1,57 @@
+#include "call_graph.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "interner.hpp"
+
+namespace analyzer::calls {
+
+CallGraph::CallGraph(std::span<const function::Function *const> functions) : fan_in_(functions.size()) {
+    if (functions.size() > std::numeric_limits<FunctionIndex>::max())
+        throw std::length_error("Too many functions for a call graph");
+
+    // Кандидаты по id имени, по возрастанию индекса
+    std::unordered_map<interner::StringId, std::vector<FunctionIndex>> by_name;
+    for (std::size_t i = 0; i < functions.size(); ++i)
+        by_name[interner::Intern(functions[i]->name)].push_back(static_cast<FunctionIndex>(i));
+
+    offsets_.reserve(functions.size() + 1);
+    offsets_.push_back(0);
+    std::vector<interner::StringId> names;
+    std::vector<FunctionIndex> row;
+    for (std::size_t caller = 0; caller < functions.size(); ++caller) {
+        const auto &func = *functions[caller];
+        names.clear();
+        for (const auto &callee : func.callees)
+            names.push_back(callee.Id());
+        std::ranges::sort(names);
+        names.erase(std::ranges::unique(names).begin(), names.end());
+
+        row.clear();
+        for (const auto name : names) {
+            const auto candidates = by_name.find(name);
+            if (candidates == by_name.end())
+                continue;
+            const auto same_file = [&](FunctionIndex target) { return functions[target]->filename == func.filename; };
+            const bool local = std::ranges::any_of(candidates->second, same_file);
+            for (const auto target : candidates->second)
+                if (target != caller && (!local || same_file(target)))
+                    row.push_back(target);
+        }
+        std::ranges::sort(row);
+        row.erase(std::ranges::unique(row).begin(), row.end());
+
+        for (const auto target : row)
+            ++fan_in_[target];
+        targets_.insert(targets_.end(), row.begin(), row.end());
+        offsets_.push_back(targets_.size());
+    }
+}
+
+}  // namespace analyzer::calls
@@ -0,0 +1,317 @@
+#include "clone_detector.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace analyzer::clones {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+std::uint64_t MixBytes(std::uint64_t hash, std::string_view bytes) {
+    for (char ch : bytes)
+        hash = (hash ^ static_cast<unsigned char>(ch)) * kFnvPrime;
+    return hash;
+}
+
+std::uint64_t MixValue(std::uint64_t hash, std::uint64_t value) { return (hash ^ value) * kFnvPrime; }
+
+// splitmix64: FNV плохо перемешивает старшие биты, а по ним выбирается шард
+std::uint64_t Finalize(std::uint64_t hash) {
+    hash += 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+// Текст листа по его координатам; строки исходника без перевода строки
+std::uint64_t MixSourceText(std::uint64_t hash, std::span<const std::pmr::string> lines, SourcePosition start,
+                            SourcePosition end) {
+    for (std::size_t line = start.line; line <= end.line && line < lines.size(); ++line) {
+        const std::string_view text = lines[line];
+        const auto from = line == start.line ? std::min(start.column, text.size()) : 0;
+        const auto to = line == end.line ? std::min(end.column, text.size()) : text.size();
+        if (line != start.line)
+            hash = MixValue(hash, '\n');
+        if (from < to)
+            hash = MixBytes(hash, text.substr(from, to - from));
+    }
+    return hash;
+}
+
+struct Candidate {
+    std::uint64_t hash;
+    std::uint64_t parent_hash = 0;
+    std::size_t nodes;
+    std::string_view type;
+    SourcePosition start;
+    SourcePosition end;
+};
+
+// Однопроходный разбор текста AST tree-sitter: "(тип [r, c] - [r, c] поле: (ребёнок ...) ...)"
+class SubtreeHasher {
+public:
+    SubtreeHasher(std::string_view ast, std::span<const std::pmr::string> lines, const CloneOptions &options)
+        : ast_(ast), lines_(lines), options_(options) {}
+
+    Expected<std::vector<Candidate>> Run() {
+        std::string_view field;
+        while (SkipSpaces()) {
+            const char ch = ast_[pos_];
+            if (ch == '(') {
+                ++pos_;
+                Open(field);
+                field = {};
+            } else if (ch == ')') {
+                ++pos_;
+                if (stack_.empty())
+                    return Malformed("unbalanced ')'");
+                Close();
+            } else if (ch == '[') {
+                if (stack_.empty() || !ReadRange(stack_.back()))
+                    return Malformed("bad position");
+            } else if (ch == '"' || ch == '\'') {
+                // Текст пропущенного токена: (MISSING ")" [r, c] - [r, c])
+                const auto token = ReadQuoted();
+                if (!token || stack_.empty())
+                    return Malformed("bad quoted token");
+                stack_.back().hash = MixBytes(stack_.back().hash, *token);
+            } else {
+                const auto token = ReadToken();
+                if (token.ends_with(':'))
+                    field = token;
+                else if (!stack_.empty())
+                    stack_.back().hash = MixBytes(MixValue(stack_.back().hash, ' '), token);
+                else
+                    return Malformed("text outside of a node");
+            }
+        }
+        if (!stack_.empty())
+            return Malformed("unclosed node");
+        return std::move(candidates_);
+    }
+
+private:
+    struct Frame {
+        std::uint64_t hash;
+        std::size_t nodes = 1;
+        std::size_t children = 0;
+        std::string_view type;
+        std::string_view field;
+        SourcePosition start;
+        SourcePosition end;
+        std::size_t awaiting_start;
+    };
+
+    std::unexpected<Error> Malformed(std::string_view what) const {
+        return MakeError(ErrorCode::kParse,
+                         "Malformed AST at offset " + std::to_string(pos_) + ": " + std::string(what));
+    }
+
+    bool SkipSpaces() {
+        while (pos_ < ast_.size() && std::isspace(static_cast<unsigned char>(ast_[pos_])))
+            ++pos_;
+        return pos_ < ast_.size();
+    }
+
+    std::string_view ReadToken() {
+        const auto start = pos_;
+        while (pos_ < ast_.size() && !std::isspace(static_cast<unsigned char>(ast_[pos_])) && ast_[pos_] != '(' &&
+               ast_[pos_] != ')' && ast_[pos_] != '[')
+            ++pos_;
+        if (pos_ == start)
+            ++pos_;  // Одиночный неизвестный символ: не зацикливаемся
+        return ast_.substr(start, pos_ - start);
+    }
+
+    std::optional<std::string_view> ReadQuoted() {
+        const char quote = ast_[pos_];
+        const auto start = pos_++;
+        for (; pos_ < ast_.size(); ++pos_) {
+            if (ast_[pos_] == '\\')
+                ++pos_;
+            else if (ast_[pos_] == quote)
+                return ast_.substr(start, ++pos_ - start);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::size_t> ReadNumber() {
+        SkipSpaces();
+        std::size_t value = 0;
+        const auto [end, error] = std::from_chars(ast_.data() + pos_, ast_.data() + ast_.size(), value);
+        if (error != std::errc{})
+            return std::nullopt;
+        pos_ = static_cast<std::size_t>(end - ast_.data());
+        return value;
+    }
+
+    bool Expect(char ch) {
+        SkipSpaces();
+        if (pos_ >= ast_.size() || ast_[pos_] != ch)
+            return false;
+        ++pos_;
+        return true;
+    }
+
+    std::optional<SourcePosition> ReadPosition() {
+        if (!Expect('['))
+            return std::nullopt;
+        const auto line = ReadNumber();
+        if (!line || !Expect(','))
+            return std::nullopt;
+        const auto column = ReadNumber();
+        if (!column || !Expect(']'))
+            return std::nullopt;
+        return SourcePosition{*line, *column};
+    }
+
+    bool ReadRange(Frame &frame) {
+        const auto start = ReadPosition();
+        if (!start || !Expect('-'))
+            return false;
+        const auto end = ReadPosition();
+        if (!end)
+            return false;
+        frame.start = *start;
+        frame.end = *end;
+        return true;
+    }
+
+    void Open(std::string_view field) {
+        const auto type = ReadToken();
+        stack_.push_back(Frame{.hash = MixBytes(kFnvOffset, type),
+                               .type = type,
+                               .field = field,
+                               .awaiting_start = awaiting_.size()});
+    }
+
+    void Close() {
+        auto frame = stack_.back();
+        stack_.pop_back();
+        if (frame.children == 0 && !(options_.normalize_identifiers && frame.type == "identifier"))
+            frame.hash = MixSourceText(MixValue(frame.hash, 0), lines_, frame.start, frame.end);
+        const auto hash = Finalize(MixValue(frame.hash, frame.nodes));
+
+        // Дети, ждущие хеша родителя, — это как раз кандидаты среди прямых детей узла
+        for (auto i = frame.awaiting_start; i < awaiting_.size(); ++i)
+            candidates_[awaiting_[i]].parent_hash = hash;
+        awaiting_.resize(frame.awaiting_start);
+        if (frame.nodes >= options_.min_nodes) {
+            awaiting_.push_back(candidates_.size());
+            candidates_.push_back(
+                {.hash = hash, .nodes = frame.nodes, .type = frame.type, .start = frame.start, .end = frame.end});
+        }
+
+        if (stack_.empty())
+            return;
+        // Поле входит в хеш родителя, а не ребёнка: одно и то же поддерево в разных ролях остаётся клоном
+        auto &parent = stack_.back();
+        parent.hash = MixValue(MixBytes(MixValue(parent.hash, '('), frame.field), hash);
+        parent.nodes += frame.nodes;
+        ++parent.children;
+    }
+
+    std::string_view ast_;
+    std::span<const std::pmr::string> lines_;
+    const CloneOptions &options_;
+    std::size_t pos_ = 0;
+    std::vector<Frame> stack_;
+    std::vector<Candidate> candidates_;
+    std::vector<std::size_t> awaiting_;  // Кандидаты, чей родитель ещё не закрыт
+};
+
+}  // namespace
+
+Expected<void> CloneIndex::AddFile(const file::File &file) {
+    return AddTree(file.name, file.ast, file.source_lines);
+}
+
+Expected<void> CloneIndex::AddTree(const std::string &filename, std::string_view ast,
+                                   std::span<const std::pmr::string> source_lines) {
+    auto candidates = SubtreeHasher(ast, source_lines, options_).Run();
+    if (!candidates)
+        return std::unexpected(std::move(candidates.error()));
+
+    // Один захват мьютекса на шард за файл
+    const interner::InternedString interned_filename(filename);
+    std::array<std::vector<const Candidate *>, kShards> by_shard;
+    for (const auto &candidate : *candidates)
+        by_shard[ShardOf(candidate.hash)].push_back(&candidate);
+    for (std::size_t shard = 0; shard < kShards; ++shard) {
+        if (by_shard[shard].empty())
+            continue;
+        std::lock_guard lock(shards_[shard].mutex);
+        for (const auto *candidate : by_shard[shard])
+            shards_[shard].buckets[candidate->hash].push_back(
+                Occurrence{.parent_hash = candidate->parent_hash,
+                           .nodes = candidate->nodes,
+                           .location = {.filename = interned_filename,
+                                        .node_type = interner::InternedString(candidate->type),
+                                        .start = candidate->start,
+                                        .end = candidate->end}});
+    }
+    return {};
+}
+
+std::vector<CloneClass> CloneIndex::Classes() const {
+    const auto repeated = [&](std::uint64_t hash) {
+        const auto &shard = shards_[ShardOf(hash)];
+        std::lock_guard lock(shard.mutex);
+        const auto it = shard.buckets.find(hash);
+        return it != shard.buckets.end() && it->second.size() > 1;
+    };
+
+    std::vector<CloneClass> classes;
+    for (const auto &shard : shards_) {
+        std::vector<std::pair<std::uint64_t, const std::vector<Occurrence> *>> buckets;
+        {
+            std::lock_guard lock(shard.mutex);
+            for (const auto &[hash, occurrences] : shard.buckets)
+                if (occurrences.size() > 1)
+                    buckets.emplace_back(hash, &occurrences);
+        }
+        for (const auto &[hash, occurrences] : buckets) {
+            // Все копии внутри копий одного и того же родителя: сообщается родительский класс
+            const auto parent = occurrences->front().parent_hash;
+            const bool nested = parent != 0 && std::ranges::all_of(*occurrences, [&](const Occurrence &occurrence) {
+                                    return occurrence.parent_hash == parent;
+                                });
+            if (nested && repeated(parent))
+                continue;
+
+            CloneClass clone{.hash = hash, .nodes = occurrences->front().nodes, .locations = {}};
+            for (const auto &occurrence : *occurrences)
+                clone.locations.push_back(occurrence.location);
+            std::ranges::sort(clone.locations, {}, [](const CloneLocation &location) {
+                return std::tuple(location.filename.View(), location.start);
+            });
+            classes.push_back(std::move(clone));
+        }
+    }
+
+    std::ranges::sort(classes, [](const CloneClass &lhs, const CloneClass &rhs) {
+        const auto key = [](const CloneClass &clone) {
+            const auto &first = clone.locations.front();
+            return std::tuple(-static_cast<std::ptrdiff_t>(clone.nodes),
+                              -static_cast<std::ptrdiff_t>(clone.locations.size()), first.filename.View(), first.start);
+        };
+        return key(lhs) < key(rhs);
+    });
+    return classes;
+}
+
+}  // namespace analyzer::clones
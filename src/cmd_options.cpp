@@ -1,9 +1,14 @@
 #include "cmd_options.hpp"
 
+#include <algorithm>
 #include <exception>
+#include <filesystem>
 #include <iostream>
 #include <print>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
@@ -14,21 +19,97 @@ namespace po = boost::program_options;
 ProgramOptions::ProgramOptions() : desc_("Allowed options") {
     desc_.add_options()
         ("help,h", "Display help message")
-        ("file,f", po::value<std::vector<std::string>>(&files_)->required()->multitoken(),
-         "List of files to process (required)")
+        ("file,f", po::value<std::vector<std::string>>(&files_)->multitoken(),
+         "List of files to process")
+        ("dir,d", po::value<std::vector<std::string>>(&directories_)->multitoken(),
+         "Directories to scan recursively for .py files; positional arguments may also be directories")
+        ("exclude", po::value<std::vector<std::string>>(&exclude_)->multitoken(),
+         "Gitignore-style patterns excluded from directory scans")
+        ("files-from", po::value<std::vector<std::string>>(&file_lists_)->multitoken(),
+         "Read paths from a file ('-' for stdin), newline- or NUL-separated; a positional @file does the same")
+        ("git-rev", po::value<std::string>(&git_revision_),
+         "Analyse .py files of a git revision straight from the object database instead of the working tree")
+        ("changed-since", po::value<std::string>(&changed_since_),
+         "Analyse only functions touched by git diff against this revision and report metric deltas")
+        ("cache-dir", po::value<std::string>(&cache_directory_),
+         "Directory for cached per-file results reused across runs (used with --git-rev, --changed-since and --daemon)")
+        ("memo-file", po::value<std::string>(&memo_file_),
+         "File that keeps memoized structural metrics of function bodies between runs")
+        ("cache-entries", po::value<std::size_t>(&cache_entries_)->default_value(4096),
+         "Most per-file results kept in memory by the result cache, least recently used first out (0 means no limit)")
+        ("memo-entries", po::value<std::size_t>(&memo_entries_)->default_value(1 << 20),
+         "Most function bodies kept in the structural metric memo (0 means no limit)")
+        ("no-gitignore", po::bool_switch(&ignore_gitignore_)->default_value(false),
+         "Do not read .gitignore files during directory scans")
+        ("top,t", po::value<std::size_t>(&top_count_)->default_value(10),
+         "Number of most complex functions to report (0 disables the report)")
+        ("parse-timeout", po::value<std::size_t>(&parse_timeout_ms_)->default_value(0),
+         "Kill tree-sitter and skip the file after this many milliseconds (0 means no limit)")
+        ("max-ast-bytes", po::value<std::size_t>(&max_ast_bytes_)->default_value(0),
+         "Skip files whose tree-sitter output exceeds this many bytes (0 means no limit)")
+        ("time-budget", po::value<std::size_t>(&time_budget_ms_)->default_value(0),
+         "Stop starting new files after this many milliseconds and report partial results (0 means no limit)")
+        ("jobs,j", po::value<std::size_t>(&jobs_)->default_value(0),
+         "Number of files analysed in parallel (0 uses all hardware threads)")
+        ("profile", po::bool_switch(&profile_enabled_)->default_value(false),
+         "Report parallel makespan against its ideal lower bound")
+        ("watch", po::bool_switch(&watch_enabled_)->default_value(false),
+         "Keep results in memory and re-analyse files as they change until interrupted")
+        ("clones", po::bool_switch(&clones_enabled_)->default_value(false),
+         "Report classes of structurally identical AST subtrees instead of metrics")
+        ("clone-min-nodes", po::value<std::size_t>(&clone_min_nodes_)->default_value(30),
+         "Smallest subtree, in AST nodes, reported by --clones")
+        ("clone-normalize-identifiers", po::bool_switch(&clone_normalize_identifiers_)->default_value(false),
+         "With --clones, treat subtrees that differ only in identifier names as clones")
+        ("call-graph", po::bool_switch(&call_graph_enabled_)->default_value(false),
+         "Add fan_in, fan_out and unreferenced metrics from calls between all analysed functions")
+        ("daemon", po::value<std::string>(&daemon_socket_),
+         "Serve analysis requests on this Unix socket, keeping caches warm between requests")
+        ("connect", po::value<std::string>(&connect_socket_),
+         "Send files and directories to a daemon listening on this Unix socket instead of analysing in-process")
+        ("stdin-name", po::value<std::string>(&stdin_name_),
+         "With --connect, also send stdin as an unsaved editor buffer reported under this name")
         ("ANALYZER_DEBUG", po::bool_switch(&debug_enabled_)->default_value(false),
          "Enable debug output");
 }
 
 ProgramOptions::~ProgramOptions() = default;
 
+void ProgramOptions::AddInputPaths(const std::vector<std::string> &paths) {
+    for (const auto &path : paths) {
+        if (path.size() > 1 && path.front() == '@') {
+            file_lists_.push_back(path.substr(1));
+            continue;
+        }
+        std::error_code error;
+        if (std::filesystem::is_directory(path, error))
+            directories_.push_back(path);
+        else
+            files_.push_back(path);
+    }
+}
+
 bool ProgramOptions::Parse(int argc, char *argv[]) {
     help_requested_ = false;
     debug_enabled_ = false;
+    profile_enabled_ = false;
+    watch_enabled_ = false;
+    clones_enabled_ = false;
+    clone_normalize_identifiers_ = false;
+    call_graph_enabled_ = false;
+    ignore_gitignore_ = false;
 
     try {
+        std::vector<std::string> inputs;
+        po::options_description hidden;
+        hidden.add_options()("input", po::value<std::vector<std::string>>(&inputs));
+        po::options_description all;
+        all.add(desc_).add(hidden);
+        po::positional_options_description positional;
+        positional.add("input", -1);
+
         po::variables_map vm;
-        po::store(po::command_line_parser(argc, argv).options(desc_).run(), vm);
+        po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
 
         if (vm.count("help")) {
             help_requested_ = true;
@@ -37,9 +118,62 @@ bool ProgramOptions::Parse(int argc, char *argv[]) {
         }
 
         po::notify(vm);
+        AddInputPaths(inputs);
+
+        if (jobs_ == 0)
+            jobs_ = std::max(1u, std::thread::hardware_concurrency());
+
+        const bool has_paths = !files_.empty() || !directories_.empty() || !file_lists_.empty();
+        if (!daemon_socket_.empty()) {
+            if (has_paths || !git_revision_.empty() || !changed_since_.empty() || watch_enabled_ || clones_enabled_ ||
+                call_graph_enabled_ || !connect_socket_.empty() || !stdin_name_.empty()) {
+                std::cerr << "Error: --daemon takes requests from clients and cannot be combined with inputs\n";
+                desc_.print(std::cout);
+                return false;
+            }
+            return true;
+        }
+
+        if (!stdin_name_.empty() && connect_socket_.empty()) {
+            std::cerr << "Error: --stdin-name needs --connect\n";
+            desc_.print(std::cout);
+            return false;
+        }
+        if (!connect_socket_.empty() &&
+            (!git_revision_.empty() || !changed_since_.empty() || watch_enabled_ || clones_enabled_)) {
+            std::cerr << "Error: --connect sends files and directories only\n";
+            desc_.print(std::cout);
+            return false;
+        }
+
+        const int sources = (has_paths ? 1 : 0) + (git_revision_.empty() ? 0 : 1) + (changed_since_.empty() ? 0 : 1);
+        if (sources > 1) {
+            std::cerr << "Error: files or directories, --git-rev and --changed-since cannot be combined\n";
+            desc_.print(std::cout);
+            return false;
+        }
+
+        if (watch_enabled_ && !has_paths) {
+            std::cerr << "Error: --watch needs files or directories\n";
+            desc_.print(std::cout);
+            return false;
+        }
+
+        if (clones_enabled_ && (!has_paths || watch_enabled_)) {
+            std::cerr << "Error: --clones needs files or directories and cannot be combined with --watch\n";
+            desc_.print(std::cout);
+            return false;
+        }
+
+        // Имена вызовов есть только у функций, разобранных в этом процессе, а не взятых из кеша
+        if (call_graph_enabled_ && (!has_paths || watch_enabled_ || clones_enabled_ || !connect_socket_.empty())) {
+            std::cerr << "Error: --call-graph needs files or directories analysed in-process\n";
+            desc_.print(std::cout);
+            return false;
+        }
 
-        if (files_.empty()) {
-            std::cerr << "Error: At least one file must be specified\n";
+        if (sources == 0 && stdin_name_.empty()) {
+            std::cerr << "Error: At least one file, directory, --git-rev or --changed-since must be specified\n";
             desc_.print(std::cout);
             return false;
         }
@@ -0,0 +1,381 @@
+#include "daemon_protocol.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace analyzer::daemon {
+
+namespace {
+
+constexpr std::uint8_t kProtocolVersion = 1;
+// Ответ по крупному проекту на порядки меньше; предел защищает демон от мусора в поле длины
+constexpr std::uint32_t kMaxFrameSize = 256u << 20;
+
+constexpr std::uint8_t kIntValue = 0;
+constexpr std::uint8_t kStringValue = 1;
+
+class Writer {
+public:
+    void U8(std::uint8_t value) { data_.push_back(static_cast<char>(value)); }
+
+    void U32(std::uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8)
+            U8(static_cast<std::uint8_t>(value >> shift));
+    }
+
+    void String(std::string_view value) {
+        U32(static_cast<std::uint32_t>(value.size()));
+        data_.append(value);
+    }
+
+    std::string Take() { return std::move(data_); }
+
+private:
+    std::string data_;
+};
+
+// Чтение с проверкой границ: после первой неудачи все чтения возвращают nullopt
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    std::optional<std::uint8_t> U8() {
+        if (data_.empty())
+            return std::nullopt;
+        const auto value = static_cast<std::uint8_t>(data_.front());
+        data_.remove_prefix(1);
+        return value;
+    }
+
+    std::optional<std::uint32_t> U32() {
+        if (data_.size() < 4)
+            return std::nullopt;
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(data_[i])) << (8 * i);
+        data_.remove_prefix(4);
+        return value;
+    }
+
+    std::optional<std::string> String() {
+        const auto size = U32();
+        if (!size || data_.size() < *size)
+            return std::nullopt;
+        std::string value(data_.substr(0, *size));
+        data_.remove_prefix(*size);
+        return value;
+    }
+
+    // Число элементов, каждый из которых занимает хотя бы min_size байт: не даёт зарезервировать лишнее
+    std::optional<std::uint32_t> Count(std::size_t min_size) {
+        const auto count = U32();
+        if (!count || *count > data_.size() / min_size)
+            return std::nullopt;
+        return count;
+    }
+
+    bool AtEnd() const { return data_.empty(); }
+
+private:
+    std::string_view data_;
+};
+
+void WriteMetric(Writer &writer, const metric::MetricResult &result) {
+    writer.String(result.metric_name.View());
+    if (const auto *number = std::get_if<int>(&result.value)) {
+        writer.U8(kIntValue);
+        writer.U32(static_cast<std::uint32_t>(*number));
+    } else {
+        writer.U8(kStringValue);
+        writer.String(std::get<std::string>(result.value));
+    }
+}
+
+std::optional<metric::MetricResult> ReadMetric(Reader &reader) {
+    auto name = reader.String();
+    const auto type = name ? reader.U8() : std::nullopt;
+    if (!type)
+        return std::nullopt;
+
+    metric::MetricResult::ValueType value;
+    if (*type == kIntValue) {
+        const auto number = reader.U32();
+        if (!number)
+            return std::nullopt;
+        value = static_cast<int>(*number);
+    } else if (*type == kStringValue) {
+        auto text = reader.String();
+        if (!text)
+            return std::nullopt;
+        value = std::move(*text);
+    } else {
+        return std::nullopt;
+    }
+
+    metric::MetricResult result{.metric_name = *name, .value = std::move(value)};
+    result.metric_id = metric::FindMetricId(*name).value_or(metric::kUnknownMetricId);
+    return result;
+}
+
+std::optional<cache::CachedFunction> ReadFunction(Reader &reader) {
+    const auto has_class = reader.U8();
+    if (!has_class || *has_class > 1)
+        return std::nullopt;
+    cache::CachedFunction function;
+    if (*has_class) {
+        function.class_name = reader.String();
+        if (!function.class_name)
+            return std::nullopt;
+    }
+    auto name = reader.String();
+    const auto metric_count = name ? reader.Count(6) : std::nullopt;
+    if (!metric_count)
+        return std::nullopt;
+    function.name = std::move(*name);
+
+    function.metrics.reserve(*metric_count);
+    for (std::uint32_t i = 0; i < *metric_count; ++i) {
+        auto metric = ReadMetric(reader);
+        if (!metric)
+            return std::nullopt;
+        function.metrics.push_back(std::move(*metric));
+    }
+    return function;
+}
+
+std::optional<ErrorRecord> ReadError(Reader &reader) {
+    auto function = reader.String();
+    auto metric_name = function ? reader.String() : std::nullopt;
+    const auto code = metric_name ? reader.U8() : std::nullopt;
+    auto message = code ? reader.String() : std::nullopt;
+    if (!message || *code > static_cast<std::uint8_t>(ErrorCode::kSkipped))
+        return std::nullopt;
+    return ErrorRecord{.function = std::move(*function),
+                       .metric_name = std::move(*metric_name),
+                       .code = static_cast<ErrorCode>(*code),
+                       .message = std::move(*message)};
+}
+
+std::optional<ItemResult> ReadItem(Reader &reader) {
+    const auto function_count = reader.Count(9);
+    if (!function_count)
+        return std::nullopt;
+    ItemResult item;
+    item.result.functions.reserve(*function_count);
+    for (std::uint32_t i = 0; i < *function_count; ++i) {
+        auto function = ReadFunction(reader);
+        if (!function)
+            return std::nullopt;
+        item.result.functions.push_back(std::move(*function));
+    }
+
+    const auto error_count = reader.Count(13);
+    if (!error_count)
+        return std::nullopt;
+    for (std::uint32_t i = 0; i < *error_count; ++i) {
+        auto error = ReadError(reader);
+        if (!error)
+            return std::nullopt;
+        item.errors.push_back(std::move(*error));
+    }
+    return item;
+}
+
+Error SocketError(const std::string &what) { return Error{ErrorCode::kIo, what + ": " + std::strerror(errno)}; }
+
+// Ровно size байт; false — соединение закрыто до первого байта
+Expected<bool> ReadExactly(int fd, char *data, std::size_t size) {
+    for (std::size_t done = 0; done < size;) {
+        const auto count = read(fd, data + done, size - done);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return std::unexpected(SocketError("Failed to read from socket"));
+        if (count == 0) {
+            if (done == 0)
+                return false;
+            return MakeError(ErrorCode::kIo, "Connection closed in the middle of a frame");
+        }
+        done += static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string EncodeRequest(const Request &request) {
+    Writer writer;
+    writer.U8(kProtocolVersion);
+    writer.U32(static_cast<std::uint32_t>(request.items.size()));
+    for (const auto &item : request.items) {
+        writer.U8(item.content ? 1 : 0);
+        writer.String(item.name);
+        if (item.content)
+            writer.String(*item.content);
+    }
+    return writer.Take();
+}
+
+std::string EncodeResponse(const Response &response) {
+    Writer writer;
+    writer.U8(kProtocolVersion);
+    writer.U32(static_cast<std::uint32_t>(response.items.size()));
+    for (const auto &item : response.items) {
+        writer.U32(static_cast<std::uint32_t>(item.result.functions.size()));
+        for (const auto &function : item.result.functions) {
+            writer.U8(function.class_name ? 1 : 0);
+            if (function.class_name)
+                writer.String(*function.class_name);
+            writer.String(function.name);
+            writer.U32(static_cast<std::uint32_t>(function.metrics.size()));
+            for (const auto &metric : function.metrics)
+                WriteMetric(writer, metric);
+        }
+        writer.U32(static_cast<std::uint32_t>(item.errors.size()));
+        for (const auto &error : item.errors) {
+            writer.String(error.function);
+            writer.String(error.metric_name);
+            writer.U8(static_cast<std::uint8_t>(error.code));
+            writer.String(error.message);
+        }
+    }
+    return writer.Take();
+}
+
+std::optional<Request> DecodeRequest(std::string_view payload) {
+    Reader reader(payload);
+    if (reader.U8() != kProtocolVersion)
+        return std::nullopt;
+    const auto count = reader.Count(5);
+    if (!count)
+        return std::nullopt;
+
+    Request request;
+    request.items.reserve(*count);
+    for (std::uint32_t i = 0; i < *count; ++i) {
+        const auto has_content = reader.U8();
+        if (!has_content || *has_content > 1)
+            return std::nullopt;
+        auto name = reader.String();
+        if (!name)
+            return std::nullopt;
+        RequestItem item{.name = std::move(*name), .content = std::nullopt};
+        if (*has_content) {
+            item.content = reader.String();
+            if (!item.content)
+                return std::nullopt;
+        }
+        request.items.push_back(std::move(item));
+    }
+    if (!reader.AtEnd())
+        return std::nullopt;
+    return request;
+}
+
+std::optional<Response> DecodeResponse(std::string_view payload) {
+    Reader reader(payload);
+    if (reader.U8() != kProtocolVersion)
+        return std::nullopt;
+    const auto count = reader.Count(8);
+    if (!count)
+        return std::nullopt;
+
+    Response response;
+    response.items.reserve(*count);
+    for (std::uint32_t i = 0; i < *count; ++i) {
+        auto item = ReadItem(reader);
+        if (!item)
+            return std::nullopt;
+        response.items.push_back(std::move(*item));
+    }
+    if (!reader.AtEnd())
+        return std::nullopt;
+    return response;
+}
+
+Expected<std::optional<std::string>> ReadFrame(int fd) {
+    std::array<char, 4> header;
+    auto started = ReadExactly(fd, header.data(), header.size());
+    if (!started)
+        return std::unexpected(std::move(started.error()));
+    if (!*started)
+        return std::nullopt;
+
+    std::uint32_t size = 0;
+    for (int i = 0; i < 4; ++i)
+        size |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(header[i])) << (8 * i);
+    if (size > kMaxFrameSize)
+        return MakeError(ErrorCode::kTooLarge, "Frame of " + std::to_string(size) + " bytes exceeds the limit");
+
+    std::string payload(size, '\0');
+    auto read = ReadExactly(fd, payload.data(), payload.size());
+    if (!read)
+        return std::unexpected(std::move(read.error()));
+    if (!*read)
+        return MakeError(ErrorCode::kIo, "Connection closed in the middle of a frame");
+    return payload;
+}
+
+Expected<void> WriteFrame(int fd, std::string_view payload) {
+    if (payload.size() > kMaxFrameSize)
+        return MakeError(ErrorCode::kTooLarge,
+                         "Frame of " + std::to_string(payload.size()) + " bytes exceeds the limit");
+
+    Writer header;
+    header.U32(static_cast<std::uint32_t>(payload.size()));
+    const auto frame = header.Take().append(payload);
+    for (std::size_t done = 0; done < frame.size();) {
+        // MSG_NOSIGNAL: клиент, отключившийся до ответа, не должен убить демон через SIGPIPE
+        const auto count = send(fd, frame.data() + done, frame.size() - done, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return std::unexpected(SocketError("Failed to write to socket"));
+        done += static_cast<std::size_t>(count);
+    }
+    return {};
+}
+
+Expected<Response> Call(const std::string &socket_path, const Request &request) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+        return MakeError(ErrorCode::kIo, "Socket path is too long: " + socket_path);
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return std::unexpected(SocketError("Failed to create socket"));
+    const auto result = [&]() -> Expected<Response> {
+        if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+            return std::unexpected(SocketError("Failed to connect to " + socket_path));
+        if (auto written = WriteFrame(fd, EncodeRequest(request)); !written)
+            return std::unexpected(std::move(written.error()));
+        auto frame = ReadFrame(fd);
+        if (!frame)
+            return std::unexpected(std::move(frame.error()));
+        if (!*frame)
+            return MakeError(ErrorCode::kIo, "Daemon closed the connection without a response");
+        auto response = DecodeResponse(**frame);
+        if (!response || response->items.size() != request.items.size())
+            return MakeError(ErrorCode::kParse, "Malformed response from daemon");
+        return std::move(*response);
+    }();
+    close(fd);
+    return result;
+}
+
+}  // namespace analyzer::daemon
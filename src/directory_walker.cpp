@@ -0,0 +1,341 @@
+#include "directory_walker.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "schedule.hpp"
+
+namespace analyzer::walk {
+
+namespace {
+
+// Класс символов [...] с началом в pattern[0]; возвращает длину класса или 0, если скобка не закрыта
+std::size_t MatchClass(std::string_view pattern, char ch, bool &matched) {
+    std::size_t pos = 1;
+    const bool negated = pos < pattern.size() && (pattern[pos] == '!' || pattern[pos] == '^');
+    if (negated)
+        ++pos;
+
+    bool found = false;
+    for (bool first = true; pos < pattern.size() && (first || pattern[pos] != ']'); first = false) {
+        const char low = pattern[pos];
+        if (pos + 2 < pattern.size() && pattern[pos + 1] == '-' && pattern[pos + 2] != ']') {
+            found = found || (low <= ch && ch <= pattern[pos + 2]);
+            pos += 3;
+        } else {
+            found = found || low == ch;
+            ++pos;
+        }
+    }
+    if (pos >= pattern.size())
+        return 0;
+
+    matched = found != negated && ch != '/';
+    return pos + 1;
+}
+
+std::string_view Basename(std::string_view path) {
+    const auto slash = path.rfind('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+std::string JoinPath(std::string_view directory, std::string_view name) {
+    std::string path(directory);
+    if (!path.empty() && path.back() != '/')
+        path.push_back('/');
+    path.append(name);
+    return path;
+}
+
+bool HasExtension(std::string_view name, const std::vector<std::string> &extensions) {
+    return extensions.empty() || std::ranges::any_of(extensions, [name](const std::string &extension) {
+               return name.size() > extension.size() && name.ends_with(extension);
+           });
+}
+
+Error IoError(std::string_view what, std::string_view path) {
+    return Error{ErrorCode::kIo, std::string(what) + " " + std::string(path) + ": " + std::strerror(errno)};
+}
+
+// Содержимое файла name в каталоге directory_fd; nullopt, если файла нет или он не читается
+std::optional<std::string> ReadAt(int directory_fd, const char *name) {
+    const int fd = openat(directory_fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return std::nullopt;
+
+    std::string content;
+    std::array<char, 4096> buffer;
+    for (;;) {
+        const ssize_t count = read(fd, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        content.append(buffer.data(), static_cast<std::size_t>(count));
+    }
+    close(fd);
+    return content;
+}
+
+struct PendingDirectory {
+    std::string path;
+    std::string relative;  // Относительно корня обхода, "" для корня
+    std::shared_ptr<const IgnoreRules> rules;
+};
+
+// Общая очередь каталогов. Обход закончен, когда очередь пуста и ни один воркер не читает каталог:
+// только тогда новых каталогов появиться не может
+class ParallelWalk {
+public:
+    ParallelWalk(const WalkOptions &options, PathQueue &paths) : options_(options), paths_(paths) {}
+
+    void Enqueue(PendingDirectory directory) {
+        {
+            std::lock_guard lock(mutex_);
+            pending_.push_back(std::move(directory));
+        }
+        ready_.notify_one();
+    }
+
+    void AddError(std::string path, Error error) {
+        std::lock_guard lock(mutex_);
+        errors_.push_back(WalkError{std::move(path), std::move(error)});
+    }
+
+    std::vector<WalkError> Run() {
+        schedule::RunWorkers(
+            options_.threads, [this] { return Next(); },
+            [this](PendingDirectory directory, std::size_t) {
+                try {
+                    Process(directory);
+                } catch (const std::exception &e) {
+                    AddError(directory.path, Error{ErrorCode::kIo, e.what()});
+                }
+                Done();
+            });
+        return std::move(errors_);
+    }
+
+private:
+    std::optional<PendingDirectory> Next() {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return !pending_.empty() || active_ == 0; });
+        if (pending_.empty())
+            return std::nullopt;
+        auto directory = std::move(pending_.front());
+        pending_.pop_front();
+        ++active_;
+        return directory;
+    }
+
+    void Done() {
+        std::lock_guard lock(mutex_);
+        if (--active_ == 0 && pending_.empty())
+            ready_.notify_all();
+    }
+
+    void Process(const PendingDirectory &directory) {
+        const int fd = open(directory.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            AddError(directory.path, IoError("Can't open directory", directory.path));
+            return;
+        }
+        // readdir читает записи пачками через getdents64, а вложенные объекты проверяются через fstatat от fd
+        DIR *stream = fdopendir(fd);
+        if (!stream) {
+            AddError(directory.path, IoError("Can't read directory", directory.path));
+            close(fd);
+            return;
+        }
+
+        auto rules = directory.rules;
+        if (options_.read_gitignore) {
+            if (const auto gitignore = ReadAt(fd, ".gitignore")) {
+                auto local = std::make_shared<IgnoreRules>(*rules);
+                local->AddFile(*gitignore, directory.relative);
+                rules = std::move(local);
+            }
+        }
+
+        while (const dirent *entry = readdir(stream)) {
+            const std::string_view name = entry->d_name;
+            if (name == "." || name == "..")
+                continue;
+
+            bool is_directory = entry->d_type == DT_DIR;
+            bool is_file = entry->d_type == DT_REG;
+            if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+                // Ссылки на файлы разрешаются, на каталоги — нет, чтобы обход не зациклился
+                struct stat info {};
+                const int flags = entry->d_type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW;
+                if (fstatat(fd, entry->d_name, &info, flags) != 0)
+                    continue;
+                is_directory = entry->d_type == DT_UNKNOWN && S_ISDIR(info.st_mode);
+                is_file = S_ISREG(info.st_mode);
+            }
+
+            auto relative = directory.relative.empty() ? std::string(name) : JoinPath(directory.relative, name);
+            if (is_directory) {
+                if (name != ".git" && !rules->IsIgnored(relative, true))
+                    Enqueue(PendingDirectory{JoinPath(directory.path, name), std::move(relative), rules});
+            } else if (is_file && HasExtension(name, options_.extensions) && !rules->IsIgnored(relative, false)) {
+                paths_.Push(JoinPath(directory.path, name));
+            }
+        }
+        closedir(stream);
+    }
+
+    const WalkOptions &options_;
+    PathQueue &paths_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<PendingDirectory> pending_;
+    std::size_t active_ = 0;
+    std::vector<WalkError> errors_;
+};
+
+}  // namespace
+
+bool GlobMatch(std::string_view pattern, std::string_view text) {
+    while (!pattern.empty()) {
+        if (pattern.starts_with("**")) {
+            pattern.remove_prefix(2);
+            if (pattern.starts_with('/')) {
+                // "**/" — ноль или больше каталогов
+                pattern.remove_prefix(1);
+                for (std::size_t i = 0; i <= text.size(); ++i)
+                    if ((i == 0 || text[i - 1] == '/') && GlobMatch(pattern, text.substr(i)))
+                        return true;
+                return false;
+            }
+            for (std::size_t i = 0; i <= text.size(); ++i)
+                if (GlobMatch(pattern, text.substr(i)))
+                    return true;
+            return false;
+        }
+
+        if (pattern.front() == '*') {
+            pattern.remove_prefix(1);
+            for (std::size_t i = 0; i <= text.size(); ++i) {
+                if (GlobMatch(pattern, text.substr(i)))
+                    return true;
+                if (i < text.size() && text[i] == '/')
+                    break;
+            }
+            return false;
+        }
+
+        if (text.empty())
+            return false;
+
+        std::size_t consumed = 1;
+        if (pattern.front() == '?') {
+            if (text.front() == '/')
+                return false;
+        } else if (pattern.front() == '[') {
+            bool matched = false;
+            consumed = MatchClass(pattern, text.front(), matched);
+            if (consumed == 0) {
+                consumed = 1;
+                matched = text.front() == '[';
+            }
+            if (!matched)
+                return false;
+        } else {
+            if (pattern.front() == '\\' && pattern.size() > 1)
+                pattern.remove_prefix(1);
+            if (pattern.front() != text.front())
+                return false;
+        }
+        pattern.remove_prefix(consumed);
+        text.remove_prefix(1);
+    }
+    return text.empty();
+}
+
+void IgnoreRules::Add(std::string_view pattern, std::string_view base) {
+    while (!pattern.empty() && (pattern.back() == ' ' || pattern.back() == '\r'))
+        pattern.remove_suffix(1);
+    if (pattern.empty() || pattern.starts_with('#'))
+        return;
+
+    Rule rule{.base = std::string(base)};
+    if (pattern.starts_with('!')) {
+        rule.negated = true;
+        pattern.remove_prefix(1);
+    } else if (pattern.starts_with("\\!") || pattern.starts_with("\\#")) {
+        pattern.remove_prefix(1);
+    }
+    if (pattern.ends_with('/')) {
+        rule.directory_only = true;
+        pattern.remove_suffix(1);
+    }
+    rule.anchored = pattern.starts_with('/') || pattern.find('/') != std::string_view::npos;
+    if (pattern.starts_with('/'))
+        pattern.remove_prefix(1);
+    if (pattern.empty())
+        return;
+
+    rule.pattern = std::string(pattern);
+    rules_.push_back(std::move(rule));
+}
+
+void IgnoreRules::AddFile(std::string_view content, std::string_view base) {
+    for (auto line : content | std::views::split('\n'))
+        Add(std::string_view(line.begin(), line.end()), base);
+}
+
+bool IgnoreRules::IsIgnored(std::string_view relative, bool is_directory) const {
+    for (const auto &rule : rules_ | std::views::reverse) {
+        if (rule.directory_only && !is_directory)
+            continue;
+
+        auto scoped = relative;
+        if (!rule.base.empty()) {
+            if (!scoped.starts_with(rule.base) || scoped.size() <= rule.base.size() || scoped[rule.base.size()] != '/')
+                continue;
+            scoped.remove_prefix(rule.base.size() + 1);
+        }
+        if (GlobMatch(rule.pattern, rule.anchored ? scoped : Basename(scoped)))
+            return !rule.negated;
+    }
+    return false;
+}
+
+std::vector<WalkError> Walk(const std::vector<std::string> &roots, const WalkOptions &options, PathQueue &paths) {
+    auto rules = std::make_shared<IgnoreRules>();
+    std::ranges::for_each(options.exclude, [&](const std::string &pattern) { rules->Add(pattern); });
+
+    ParallelWalk walk(options, paths);
+    for (const auto &root : roots) {
+        struct stat info {};
+        if (stat(root.c_str(), &info) != 0)
+            walk.AddError(root, IoError("Can't access", root));
+        else if (S_ISDIR(info.st_mode))
+            walk.Enqueue(PendingDirectory{root, "", rules});
+        else
+            paths.Push(root);
+    }
+    return walk.Run();
+}
+
+}  // namespace analyzer::walk
@@ -1,11 +1,29 @@
 #include "file.hpp"
 
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ranges>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace analyzer::file {
@@ -13,59 +31,152 @@ namespace analyzer::file {
 namespace rv = std::ranges::views;
 namespace rs = std::ranges;
 
-File::File(const std::string &filename) : name{filename} {
-    std::ifstream file(name);
+namespace {
 
-    if (!file.is_open()) {
-        throw std::invalid_argument("Can't open file " + filename);
-    }
-    ast = GetAst(filename);
-    source_lines = ReadSourceFile(file);
+File Unwrap(Expected<File> file) {
+    if (!file)
+        throw std::runtime_error(file.error().message);
+    return std::move(*file);
+}
+
+}  // namespace
+
+File::File(const std::string &filename, std::pmr::memory_resource *resource)
+    : File(Unwrap(Open(filename, resource))) {}
+
+File::File(std::pmr::memory_resource *resource) : ast{resource}, source_lines{resource} {}
+
+Expected<File> File::Open(const std::string &filename, std::pmr::memory_resource *resource,
+                          const ParseLimits &limits) {
+    return Open(filename, io::ReadWholeFile(filename), resource, limits);
+}
+
+Expected<File> File::Open(const std::string &filename, io::Source source, std::pmr::memory_resource *resource,
+                          const ParseLimits &limits) {
+    if (!source)
+        return std::unexpected(std::move(source.error()));
+
+    auto ast = GetAst(filename, limits, resource);
+    if (!ast)
+        return std::unexpected(std::move(ast.error()));
+
+    File file(resource);
+    file.name = filename;
+    file.ast = std::move(*ast);
+    file.source_lines = SplitSourceLines(*source, resource);
+    return file;
 }
 
-std::vector<std::string> File::ReadSourceFile(std::ifstream &file) {
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+// Как построчное чтение через std::getline: завершающий перевод строки не даёт пустой последней строки
+std::pmr::vector<std::pmr::string> File::SplitSourceLines(std::string_view source,
+                                                          std::pmr::memory_resource *resource) {
+    std::pmr::vector<std::pmr::string> lines(resource);
+    lines.reserve(static_cast<std::size_t>(rs::count(source, '\n')) + 1);
+    while (!source.empty()) {
+        const auto end = std::min(source.find('\n'), source.size());
+        lines.emplace_back(source.substr(0, end));
+        source.remove_prefix(std::min(end + 1, source.size()));
     }
     return lines;
 }
 
-std::string File::GetAst(const std::string &filename) try {
-    std::string full_cmd = File::command_prefix + filename + " 2>&1";
-    std::string result;
-    std::array<char, 256> buffer;
-
-    using PipePtr = std::unique_ptr<FILE, decltype([](FILE *pipe) {
-                                        if (!pipe)
-                                            return;
-
-                                        int status = pclose(pipe);
-                                        if (WIFEXITED(status)) {
-                                            int exit_status = WEXITSTATUS(status);
-                                            if (exit_status != 0) {
-                                                throw std::runtime_error("Command failed with exit code " +
-                                                                         std::to_string(exit_status));
-                                            }
-                                        } else {
-                                            throw std::runtime_error("Command terminated abnormally");
-                                        }
-                                    })>;
-
-    FILE *raw_pipe = popen(full_cmd.c_str(), "r");
-    if (!raw_pipe) {
-        throw std::runtime_error("Failed to execute command: " + std::string(std::strerror(errno)));
+Expected<std::pmr::string> File::GetAst(const std::string &filename, const ParseLimits &limits,
+                                        std::pmr::memory_resource *resource) {
+    std::vector<char *> argv;
+    for (const auto &argument : File::command)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(const_cast<char *>(filename.c_str()));
+    argv.push_back(nullptr);
+    std::pmr::string result(resource);
+    std::array<char, 4096> buffer;
+
+    std::array<int, 2> fds;
+    if (pipe2(fds.data(), O_CLOEXEC) != 0)
+        return MakeError(ErrorCode::kToolFailed, "Failed to create pipe for " + filename + ": " + std::strerror(errno));
+
+    // Своя группа процессов, чтобы при таймауте убить и tree-sitter, и запущенные им процессы
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+
+    pid_t pid = 0;
+    const int spawn_error = posix_spawnp(&pid, argv[0], &actions, &attributes, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(fds[1]);
+    if (spawn_error != 0) {
+        close(fds[0]);
+        return MakeError(ErrorCode::kToolFailed,
+                         "Failed to execute tree-sitter for " + filename + ": " + std::strerror(spawn_error));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + limits.timeout;
+    pollfd pipe_fd{.fd = fds[0], .events = POLLIN, .revents = 0};
+    std::optional<Error> failure;
+    for (;;) {
+        int wait_ms = -1;
+        if (limits.timeout.count() > 0) {
+            // Вверх: таймаут не срабатывает раньше дедлайна
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                failure = Error{ErrorCode::kTimeout, "tree-sitter exceeded " + std::to_string(limits.timeout.count()) +
+                                                         " ms on " + filename};
+                break;
+            }
+            wait_ms = static_cast<int>(std::min<std::chrono::milliseconds::rep>(left.count(), INT_MAX));
+        }
+
+        const int ready = poll(&pipe_fd, 1, wait_ms);
+        if (ready == 0 || (ready < 0 && errno == EINTR))
+            continue;
+        if (ready < 0) {
+            failure = Error{ErrorCode::kToolFailed, "poll failed on " + filename + ": " + std::strerror(errno)};
+            break;
+        }
+
+        const ssize_t count = read(fds[0], buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0) {
+            failure = Error{ErrorCode::kToolFailed, "read failed on " + filename + ": " + std::strerror(errno)};
+            break;
+        }
+        if (count == 0)
+            break;
+
+        result.append(buffer.data(), static_cast<std::size_t>(count));
+        if (limits.max_output_bytes > 0 && result.size() > limits.max_output_bytes) {
+            failure = Error{ErrorCode::kTooLarge, "tree-sitter output exceeded " +
+                                                      std::to_string(limits.max_output_bytes) + " bytes on " +
+                                                      filename};
+            break;
+        }
+    }
+    close(fds[0]);
+
+    if (failure) {
+        kill(-pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return std::unexpected(std::move(*failure));
     }
-    PipePtr pipe(raw_pipe);
 
-    while (fgets(buffer.data(), buffer.size(), pipe.get())) {
-        result += buffer.data();
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return MakeError(ErrorCode::kToolFailed, "waitpid failed on " + filename + ": " + std::strerror(errno));
     }
+    if (!WIFEXITED(status))
+        return MakeError(ErrorCode::kToolFailed, "tree-sitter terminated abnormally on " + filename);
+    if (const int exit_status = WEXITSTATUS(status); exit_status != 0)
+        return MakeError(ErrorCode::kToolFailed,
+                         "tree-sitter failed on " + filename + " with exit code " + std::to_string(exit_status));
 
     return result;
-} catch (const std::exception &e) {
-    throw std::runtime_error("Error while getting ast from " + filename);
 }
 
 }  // namespace analyzer::file
@@ -0,0 +1,177 @@
+#include "file_watcher.hpp"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace analyzer::watch {
+
+namespace {
+
+constexpr std::uint32_t kDirectoryEvents =
+    IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+Error WatchError(const std::string &what) { return Error{ErrorCode::kIo, what + ": " + std::strerror(errno)}; }
+
+// Файлы уже существующего каталога, например перенесённого в наблюдаемое дерево целиком
+void CollectFiles(const std::filesystem::path &directory, std::vector<std::string> &paths) {
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end;
+         it.increment(error)) {
+        if (it->is_directory(error) && it->path().filename() == ".git")
+            it.disable_recursion_pending();
+        else if (it->is_regular_file(error))
+            paths.push_back(it->path().string());
+    }
+}
+
+// path — сам directory или путь внутри него
+bool IsUnder(std::string_view path, std::string_view directory) {
+    return path.starts_with(directory) && (path.size() == directory.size() || path[directory.size()] == '/');
+}
+
+bool Exists(const std::string &path) {
+    std::error_code error;
+    return std::filesystem::exists(path, error);
+}
+
+}  // namespace
+
+Expected<std::unique_ptr<Watcher>> Watcher::Create() {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return std::unexpected(WatchError("Failed to initialise inotify"));
+    return std::unique_ptr<Watcher>(new Watcher(fd));
+}
+
+Watcher::~Watcher() { close(fd_); }
+
+Expected<void> Watcher::WatchDirectory(const std::string &directory, bool recursive) {
+    const int wd = inotify_add_watch(fd_, directory.c_str(), kDirectoryEvents);
+    if (wd < 0)
+        return std::unexpected(WatchError("Failed to watch " + directory));
+    directories_.insert_or_assign(wd, WatchedDirectory{.path = directory, .recursive = recursive});
+    if (!recursive)
+        return {};
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_symlink(error) || !entry.is_directory(error) || entry.path().filename() == ".git")
+            continue;
+        if (auto watched = WatchDirectory(entry.path().string(), true); !watched && Exists(entry.path()))
+            return watched;
+    }
+    return {};
+}
+
+void Watcher::Unwatch(const std::string &directory) {
+    std::erase_if(directories_, [&](const auto &watched) {
+        if (!IsUnder(watched.second.path, directory))
+            return false;
+        inotify_rm_watch(fd_, watched.first);
+        return true;
+    });
+}
+
+Expected<Changes> Watcher::Wait(std::chrono::milliseconds settle) {
+    Changes changes;
+    auto first = ReadEvents(-1, changes);
+    if (!first)
+        return std::unexpected(std::move(first.error()));
+
+    const auto deadline = std::chrono::steady_clock::now() + settle;
+    for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now()) {
+        const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        auto more = ReadEvents(static_cast<int>(left.count()), changes);
+        if (!more)
+            return std::unexpected(std::move(more.error()));
+    }
+
+    std::unordered_set<std::string> seen;
+    std::erase_if(changes.paths, [&](const std::string &path) { return !seen.insert(path).second; });
+    seen.clear();
+    std::erase_if(changes.removed_directories, [&](const std::string &path) { return !seen.insert(path).second; });
+    return changes;
+}
+
+Expected<bool> Watcher::ReadEvents(int timeout_ms, Changes &changes) {
+    pollfd descriptor{.fd = fd_, .events = POLLIN, .revents = 0};
+    const int ready = poll(&descriptor, 1, timeout_ms);
+    if (ready < 0 && errno != EINTR)
+        return std::unexpected(WatchError("Failed to wait for inotify events"));
+    if (ready <= 0)
+        return false;
+
+    alignas(inotify_event) std::array<char, 65536> buffer;
+    for (;;) {
+        const auto count = read(fd_, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0 && errno == EAGAIN)
+            return true;
+        if (count <= 0)
+            return std::unexpected(WatchError("Failed to read inotify events"));
+
+        for (std::size_t offset = 0; offset < static_cast<std::size_t>(count);) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changes.overflowed = true;
+                continue;
+            }
+            const auto found = directories_.find(event->wd);
+            if (found == directories_.end())
+                continue;
+            if (event->mask & IN_IGNORED) {
+                directories_.erase(found);
+                continue;
+            }
+            // Копия: наблюдения ниже добавляются и снимаются
+            const auto directory = found->second;
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                // Для подкаталога то же придёт событием родителя, для корня наблюдения — только так
+                changes.removed_directories.push_back(directory.path);
+                Unwatch(directory.path);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+
+            const auto path = (std::filesystem::path(directory.path) / event->name).string();
+            if (!(event->mask & IN_ISDIR)) {
+                changes.paths.push_back(path);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                // Наблюдения унесённого каталога остались бы со старыми путями; при переносе внутри дерева
+                // каталог заново добавится по IN_MOVED_TO
+                changes.removed_directories.push_back(path);
+                Unwatch(path);
+            } else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && directory.recursive &&
+                       std::string_view(event->name) != ".git") {
+                // Файлы могли появиться до того, как наблюдение за новым каталогом началось.
+                // Исчезнувший каталог не ошибка, а исчерпанный лимит наблюдений не должен останавливать слежение
+                if (auto watched = WatchDirectory(path, true); !watched && Exists(path))
+                    changes.warnings.push_back(std::move(watched.error()));
+                CollectFiles(path, changes.paths);
+            }
+        }
+    }
+}
+
+}  // namespace analyzer::watch
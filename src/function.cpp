@@ -11,10 +11,13 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -27,11 +30,42 @@ namespace rs = std::ranges;
 
 namespace analyzer::function {
 
-std::vector<Function> FunctionExtractor::Get(const analyzer::file::File &file) {
-    std::vector<Function> functions;
+namespace {
+
+// Позиция "(identifier" поля attribute у узла "(attribute ...": последнее имя в цепочке a.b.c
+size_t FindAttributeName(std::string_view attribute_ast) {
+    size_t name = std::string_view::npos;
+    size_t depth = 0;
+    for (size_t i = 0; i < attribute_ast.size(); ++i) {
+        if (attribute_ast[i] == '(') {
+            if (depth == 1 && attribute_ast.substr(0, i).ends_with("attribute: ") &&
+                attribute_ast.substr(i).starts_with("(identifier"))
+                name = i;
+            ++depth;
+        } else if (attribute_ast[i] == ')' && --depth == 0) {
+            break;
+        }
+    }
+    return name;
+}
+
+}  // namespace
+
+std::pmr::vector<Function> FunctionExtractor::Get(const analyzer::file::File &file,
+                                                  std::pmr::memory_resource *resource) {
+    auto functions = TryGet(file, resource);
+    if (!functions)
+        throw std::runtime_error(functions.error().message);
+    return std::move(*functions);
+}
+
+Expected<std::pmr::vector<Function>> FunctionExtractor::TryGet(const analyzer::file::File &file,
+                                                               std::pmr::memory_resource *resource) {
+    std::pmr::vector<Function> functions(resource);
     size_t start = 0;
-    const std::string marker = "(function_definition";
-    const std::string &ast = file.ast;
+    constexpr std::string_view marker = "(function_definition";
+    const std::string_view ast = file.ast;
+    const interner::InternedString filename(file.name);
 
     while ((start = ast.find(marker, start)) != std::string::npos) {
         size_t open_braces = 1;
@@ -47,26 +81,81 @@ std::vector<Function> FunctionExtractor::Get(const analyzer::file::File &file) {
 
         auto func_ast = ast.substr(start, end - start);
         auto name_loc = GetNameLocation(func_ast);
-        std::string func_name = GetNameFromSource(func_ast, file.source_lines);
-
-        Function func{.filename = file.name, .class_name = std::nullopt, .name = func_name, .ast = func_ast};
-
-        auto class_info = FindEnclosingClass(ast, name_loc);
-        if (class_info) {
-            func.class_name = GetClassNameFromSource(*class_info, file.source_lines);
+        if (!name_loc)
+            return std::unexpected(std::move(name_loc.error()));
+        auto func_name = GetNameFromSource(*name_loc, file.source_lines);
+        auto range = GetDefinitionRange(func_ast);
+        if (!range)
+            return std::unexpected(std::move(range.error()));
+        // Конец узла — позиция после последнего символа; нулевой столбец означает конец предыдущей строки
+        const auto [def_start, def_end] = *range;
+        const size_t end_line = def_end.col == 0 && def_end.line > def_start.line ? def_end.line : def_end.line + 1;
+
+        Function func{.filename = filename,
+                      .class_name = std::nullopt,
+                      .name = std::pmr::string(func_name, resource),
+                      .ast = std::pmr::string(func_ast, resource),
+                      .source_lines = file.source_lines,
+                      .first_line = def_start.line,
+                      .end_line = end_line};
+
+        if (collect_callees)
+            func.callees = GetCallees(func_ast, file.source_lines, resource);
+
+        auto class_info = FindEnclosingClass(ast, *name_loc);
+        if (!class_info)
+            return std::unexpected(std::move(class_info.error()));
+        if (*class_info) {
+            func.class_name = GetClassNameFromSource(**class_info, file.source_lines);
         }
 
-        functions.push_back(func);
+        functions.push_back(std::move(func));
         start = end;
     }
 
     return functions;
 }
 
-FunctionExtractor::FunctionNameLocation FunctionExtractor::GetNameLocation(const std::string &function_ast) {
+Expected<FunctionExtractor::Position> FunctionExtractor::ParsePosition(std::string_view coords) {
+    size_t comma = coords.find(',');
+    if (comma == std::string_view::npos)
+        return MakeError(ErrorCode::kParse, "Malformed AST position '" + std::string(coords) + "'");
+    size_t column_pos = coords.find_first_not_of(" \t", comma + 1);
+    if (column_pos == std::string_view::npos)
+        column_pos = comma + 1;
+
+    auto line = ToInt(coords.substr(0, comma));
+    if (!line)
+        return std::unexpected(std::move(line.error()));
+    auto col = ToInt(coords.substr(column_pos));
+    if (!col)
+        return std::unexpected(std::move(col.error()));
+    return Position{static_cast<size_t>(*line), static_cast<size_t>(*col)};
+}
+
+Expected<std::pair<FunctionExtractor::Position, FunctionExtractor::Position>>
+FunctionExtractor::GetDefinitionRange(std::string_view function_ast) {
+    // "(function_definition [3, 0] - [5, 12]"
+    const size_t start_open = function_ast.find('[');
+    const size_t start_close = function_ast.find(']', start_open);
+    const size_t end_open = function_ast.find('[', start_close);
+    const size_t end_close = function_ast.find(']', end_open);
+    if (end_close == std::string_view::npos)
+        return MakeError(ErrorCode::kParse, "Function definition without position in AST");
+
+    auto start = ParsePosition(function_ast.substr(start_open + 1, start_close - start_open - 1));
+    if (!start)
+        return std::unexpected(std::move(start.error()));
+    auto end = ParsePosition(function_ast.substr(end_open + 1, end_close - end_open - 1));
+    if (!end)
+        return std::unexpected(std::move(end.error()));
+    return std::pair{*start, *end};
+}
+
+Expected<FunctionExtractor::FunctionNameLocation> FunctionExtractor::GetNameLocation(std::string_view function_ast) {
     size_t id_pos = function_ast.find("(identifier");
     if (id_pos == std::string::npos)
-        return {};
+        return FunctionNameLocation{};
 
     size_t coord_start = function_ast.find('[', id_pos);
     size_t coord_end = function_ast.find(']', coord_start);
@@ -74,12 +163,9 @@ FunctionExtractor::FunctionNameLocation FunctionExtractor::GetNameLocation(const
     coords.remove_prefix(coord_start + 1);
     coords = coords.substr(0, coord_end - coord_start - 1);
 
-    size_t comma = coords.find(',');
-    size_t column_pos = coords.find_first_not_of(" \t", comma + 1);
-    if (column_pos == std::string_view::npos)
-        column_pos = comma + 1;
-    Position start{static_cast<size_t>(ToInt(coords.substr(0, comma))),
-                   static_cast<size_t>(ToInt(coords.substr(column_pos)))};
+    auto start = ParsePosition(coords);
+    if (!start)
+        return std::unexpected(std::move(start.error()));
 
     size_t dash = function_ast.find('[', coord_end);
     size_t end_bracket = function_ast.find(']', dash);
@@ -87,33 +173,68 @@ FunctionExtractor::FunctionNameLocation FunctionExtractor::GetNameLocation(const
     end_coords.remove_prefix(dash + 1);
     end_coords = end_coords.substr(0, end_bracket - dash - 1);
 
-    comma = end_coords.find(',');
-    size_t end_column_pos = end_coords.find_first_not_of(" \t", comma + 1);
-    if (end_column_pos == std::string_view::npos)
-        end_column_pos = comma + 1;
-    Position end{static_cast<size_t>(ToInt(end_coords.substr(0, comma))),
-                 static_cast<size_t>(ToInt(end_coords.substr(end_column_pos)))};
+    auto end = ParsePosition(end_coords);
+    if (!end)
+        return std::unexpected(std::move(end.error()));
 
-    return {start, end, ""};
+    return FunctionNameLocation{*start, *end, ""};
 }
 
-std::string FunctionExtractor::GetNameFromSource(const std::string &function_ast,
-                                                 const std::vector<std::string> &lines) {
-    auto loc = GetNameLocation(function_ast);
+std::string_view FunctionExtractor::GetNameFromSource(const FunctionNameLocation &loc, const SourceLines &lines) {
     if (loc.start.line >= lines.size())
         return "unknown";
 
-    const std::string &target_line = lines[loc.start.line];
+    const std::string_view target_line = lines[loc.start.line];
     if (loc.start.col >= target_line.size())
         return "unknown";
 
     return target_line.substr(loc.start.col, loc.end.col - loc.start.col);
 }
 
-std::optional<FunctionExtractor::ClassInfo>
-FunctionExtractor::FindEnclosingClass(const std::string &ast, const FunctionNameLocation &func_loc) {
+std::pmr::vector<interner::InternedString> FunctionExtractor::GetCallees(std::string_view function_ast,
+                                                                        const SourceLines &lines,
+                                                                        std::pmr::memory_resource *resource) {
+    std::pmr::vector<interner::InternedString> callees(resource);
+    constexpr std::string_view call_marker = "(call [";
+    constexpr std::string_view field_marker = "function: (";
+
+    for (size_t pos = function_ast.find(call_marker); pos != std::string_view::npos;
+         pos = function_ast.find(call_marker, pos + call_marker.size())) {
+        // "(call [3, 4] - [3, 9]\n  function: (identifier ..." — поле function идёт первым
+        const size_t start_close = function_ast.find(']', pos);
+        const size_t end_close = function_ast.find(']', start_close + 1);
+        if (start_close == std::string_view::npos || end_close == std::string_view::npos)
+            break;
+        const size_t field = function_ast.find_first_not_of(" \t\r\n", end_close + 1);
+        if (field == std::string_view::npos || !function_ast.substr(field).starts_with(field_marker))
+            continue;
+
+        auto callee = function_ast.substr(field + field_marker.size() - 1);
+        if (callee.starts_with("(attribute")) {
+            const size_t name = FindAttributeName(callee);
+            if (name == std::string_view::npos)
+                continue;
+            callee.remove_prefix(name);
+        } else if (!callee.starts_with("(identifier")) {
+            continue;
+        }
+
+        const auto location = GetNameLocation(callee);
+        if (!location)
+            continue;
+        const auto &[start, end, name] = *location;
+        if (start.line != end.line || start.line >= lines.size() || start.col >= end.col ||
+            end.col > lines[start.line].size())
+            continue;
+        callees.emplace_back(std::string_view(lines[start.line]).substr(start.col, end.col - start.col));
+    }
+    return callees;
+}
+
+Expected<std::optional<FunctionExtractor::ClassInfo>>
+FunctionExtractor::FindEnclosingClass(std::string_view ast, const FunctionNameLocation &func_loc) {
     size_t class_pos = 0;
-    const std::string class_marker = "(class_definition";
+    constexpr std::string_view class_marker = "(class_definition";
     std::optional<ClassInfo> last_enclosing_class;
 
     while ((class_pos = ast.find(class_marker, class_pos)) != std::string::npos) {
@@ -123,12 +244,10 @@ FunctionExtractor::FindEnclosingClass(const std::string &ast, const FunctionName
         coords.remove_prefix(coord_start + 1);
         coords = coords.substr(0, coord_end - coord_start - 1);
 
-        size_t comma = coords.find(',');
-        size_t class_column_pos = coords.find_first_not_of(" \t", comma + 1);
-        if (class_column_pos == std::string_view::npos)
-            class_column_pos = comma + 1;
-        Position class_start{static_cast<size_t>(ToInt(coords.substr(0, comma))),
-                             static_cast<size_t>(ToInt(coords.substr(class_column_pos)))};
+        auto parsed_start = ParsePosition(coords);
+        if (!parsed_start)
+            return std::unexpected(std::move(parsed_start.error()));
+        const Position class_start = *parsed_start;
 
         size_t dash = ast.find('-', coord_end);
         size_t second_coord_start = ast.find('[', dash);
@@ -137,12 +256,10 @@ FunctionExtractor::FindEnclosingClass(const std::string &ast, const FunctionName
         end_coords.remove_prefix(second_coord_start + 1);
         end_coords = end_coords.substr(0, second_coord_end - second_coord_start - 1);
 
-        comma = end_coords.find(',');
-        size_t class_end_column_pos = end_coords.find_first_not_of(" \t", comma + 1);
-        if (class_end_column_pos == std::string_view::npos)
-            class_end_column_pos = comma + 1;
-        Position class_end{static_cast<size_t>(ToInt(end_coords.substr(0, comma))),
-                           static_cast<size_t>(ToInt(end_coords.substr(class_end_column_pos)))};
+        auto parsed_end = ParsePosition(end_coords);
+        if (!parsed_end)
+            return std::unexpected(std::move(parsed_end.error()));
+        const Position class_end = *parsed_end;
 
         if (func_loc.start.line > class_start.line ||
             (func_loc.start.line == class_start.line && func_loc.start.col >= class_start.col)) {
@@ -154,7 +271,7 @@ FunctionExtractor::FindEnclosingClass(const std::string &ast, const FunctionName
                     if (id_start != std::string::npos) {
                         size_t id_coord_start = ast.find('[', id_start);
                         size_t id_coord_end = ast.find(']', id_coord_start);
-                        std::string id_coords = ast.substr(id_coord_start + 1, id_coord_end - id_coord_start - 1);
+                        std::string_view id_coords = ast.substr(id_coord_start + 1, id_coord_end - id_coord_start - 1);
 
                         ClassInfo class_info;
                         class_info.start = class_start;
@@ -171,12 +288,11 @@ FunctionExtractor::FindEnclosingClass(const std::string &ast, const FunctionName
     return last_enclosing_class;
 }
 
-std::string FunctionExtractor::GetClassNameFromSource(const ClassInfo &class_info,
-                                                      const std::vector<std::string> &lines) {
+std::string_view FunctionExtractor::GetClassNameFromSource(const ClassInfo &class_info, const SourceLines &lines) {
     if (class_info.start.line >= lines.size())
         return "unknown";
 
-    const std::string &class_line = lines[class_info.start.line];
+    const std::string_view class_line = lines[class_info.start.line];
 
     size_t class_pos = class_line.find("class");
     if (class_pos == std::string::npos)
@@ -0,0 +1,400 @@
+#include "git_source.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace analyzer::git {
+
+namespace {
+
+struct Process {
+    pid_t pid = -1;
+    int input = -1;   // Пишем в stdin процесса; -1, если stdin не нужен
+    int output = -1;  // Читаем stdout процесса
+};
+
+Error GitError(std::string message) { return Error{ErrorCode::kToolFailed, std::move(message)}; }
+
+// Пишет data в pipe целиком. SIGPIPE на время записи блокируется в этом потоке, а сигнал, порождённый
+// записью в закрытый pipe, снимается до восстановления маски: завершившийся git даёт EPIPE, а не убивает процесс
+Expected<void> WriteToPipe(int fd, std::string_view data) {
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    sigset_t pending;
+    sigpending(&pending);
+    const bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+    sigset_t previous;
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &previous);
+
+    int error = 0;
+    while (!data.empty()) {
+        const auto count = write(fd, data.data(), data.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0) {
+            error = errno;
+            break;
+        }
+        data.remove_prefix(static_cast<std::size_t>(count));
+    }
+    if (error == EPIPE && !was_pending) {
+        const timespec no_wait{};
+        while (sigtimedwait(&sigpipe, nullptr, &no_wait) < 0 && errno == EINTR) {
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+    if (error != 0)
+        return std::unexpected(GitError(std::string("Failed to write to git cat-file: ") + std::strerror(error)));
+    return {};
+}
+
+Expected<Process> SpawnGit(const std::string &repository, std::vector<std::string> args, bool with_input) {
+    args.insert(args.begin(), {"git", "-C", repository});
+    std::vector<char *> argv;
+    for (auto &arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    std::array<int, 2> output{-1, -1};
+    std::array<int, 2> input{-1, -1};
+    if (pipe2(output.data(), O_CLOEXEC) != 0 || (with_input && pipe2(input.data(), O_CLOEXEC) != 0)) {
+        const int error = errno;
+        for (int fd : {output[0], output[1], input[0], input[1]})
+            if (fd >= 0)
+                close(fd);
+        return std::unexpected(GitError(std::string("Failed to create pipe for git: ") + std::strerror(error)));
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+    if (with_input)
+        posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+
+    pid_t pid = 0;
+    const int spawn_error = posix_spawnp(&pid, "git", &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(output[1]);
+    if (with_input)
+        close(input[0]);
+    if (spawn_error != 0) {
+        close(output[0]);
+        if (with_input)
+            close(input[1]);
+        return std::unexpected(GitError(std::string("Failed to execute git: ") + std::strerror(spawn_error)));
+    }
+    return Process{.pid = pid, .input = with_input ? input[1] : -1, .output = output[0]};
+}
+
+int Wait(pid_t pid) {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return status;
+}
+
+Expected<std::string> RunGit(const std::string &repository, std::vector<std::string> args) {
+    const std::string command = args.front();
+    auto process = SpawnGit(repository, std::move(args), false);
+    if (!process)
+        return std::unexpected(std::move(process.error()));
+
+    std::string output;
+    std::array<char, 65536> buffer;
+    for (;;) {
+        const auto count = read(process->output, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        output.append(buffer.data(), static_cast<std::size_t>(count));
+    }
+    close(process->output);
+
+    const int status = Wait(process->pid);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return std::unexpected(GitError("git " + command + " failed with status " + std::to_string(status)));
+    return output;
+}
+
+bool HasExtension(std::string_view path, const std::vector<std::string> &extensions) {
+    return extensions.empty() || std::ranges::any_of(extensions, [path](const std::string &extension) {
+               return path.size() > extension.size() && path.ends_with(extension);
+           });
+}
+
+// Путь из заголовка git diff: кавычки в стиле C снимаются, префикс a/ или b/ отбрасывается
+std::string DiffPath(std::string_view text) {
+    std::string path;
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        text = text.substr(1, text.size() - 2);
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (text[i] != '\\' || i + 1 == text.size()) {
+                path.push_back(text[i]);
+                continue;
+            }
+            const char escaped = text[++i];
+            if (escaped >= '0' && escaped <= '7' && i + 2 < text.size()) {
+                path.push_back(static_cast<char>((escaped - '0') * 64 + (text[i + 1] - '0') * 8 + (text[i + 2] - '0')));
+                i += 2;
+            } else {
+                path.push_back(escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped);
+            }
+        }
+    } else {
+        path = text;
+    }
+    return path.size() > 2 ? path.substr(2) : std::string();
+}
+
+// Начало и число строк одной стороны ханка, например "-12,3" или "+7"
+bool ParseHunkSide(std::string_view text, std::size_t &start, std::size_t &count) {
+    const char *end = text.data() + text.size();
+    auto parsed = std::from_chars(text.data() + 1, end, start);
+    count = 1;
+    if (parsed.ec != std::errc{})
+        return false;
+    if (parsed.ptr != end && *parsed.ptr == ',')
+        parsed = std::from_chars(parsed.ptr + 1, end, count);
+    return parsed.ec == std::errc{} && parsed.ptr == end;
+}
+
+void AddChangedLines(std::vector<LineRange> &lines, LineRange range) {
+    if (!lines.empty() && range.first <= lines.back().last)
+        lines.back().last = std::max(lines.back().last, range.last);
+    else
+        lines.push_back(range);
+}
+
+}  // namespace
+
+Expected<std::vector<BlobEntry>> ListBlobs(const std::string &rev, const std::vector<std::string> &extensions,
+                                           const std::string &repository) {
+    auto listing = RunGit(repository, {"ls-tree", "-r", "-z", "--full-tree", rev});
+    if (!listing)
+        return std::unexpected(std::move(listing.error()));
+
+    // Записи вида "<mode> <type> <id>\t<path>\0"
+    std::vector<BlobEntry> blobs;
+    std::string_view rest = *listing;
+    while (!rest.empty()) {
+        const auto end = std::min(rest.find('\0'), rest.size());
+        const auto record = rest.substr(0, end);
+        rest.remove_prefix(std::min(end + 1, rest.size()));
+
+        const auto tab = record.find('\t');
+        const auto first_space = record.find(' ');
+        const auto second_space = record.find(' ', first_space + 1);
+        if (tab == std::string_view::npos || second_space == std::string_view::npos || second_space > tab)
+            return MakeError(ErrorCode::kParse, "Unexpected git ls-tree record: " + std::string(record));
+
+        const auto type = record.substr(first_space + 1, second_space - first_space - 1);
+        const auto path = record.substr(tab + 1);
+        if (type != "blob" || !HasExtension(path, extensions))
+            continue;
+        const auto object_id = record.substr(second_space + 1, tab - second_space - 1);
+        blobs.push_back(BlobEntry{.path = std::string(path), .object_id = std::string(object_id)});
+    }
+    return blobs;
+}
+
+Expected<std::vector<FileChange>> ChangedFiles(const std::string &base, const std::vector<std::string> &extensions,
+                                               const std::string &repository) {
+    auto cdup = RunGit(repository, {"rev-parse", "--show-cdup"});
+    if (!cdup)
+        return std::unexpected(std::move(cdup.error()));
+    while (!cdup->empty() && cdup->back() == '\n')
+        cdup->pop_back();
+
+    std::vector<std::string> args = {"diff",         "-U0", "--no-color",      "--no-ext-diff",   "--no-textconv",
+                                     "--full-index", "-M",  "--src-prefix=a/", "--dst-prefix=b/", base,
+                                     "--"};
+    for (const auto &extension : extensions)
+        args.push_back(":(top)*" + extension);
+    auto diff = RunGit(repository, std::move(args));
+    if (!diff)
+        return std::unexpected(std::move(diff.error()));
+
+    const auto relative = [&](const std::string &path) {
+        return path.empty() ? path : (std::filesystem::path(*cdup) / path).lexically_normal().string();
+    };
+
+    std::vector<FileChange> changes;
+    FileChange current;
+    const auto finish = [&] {
+        if (!current.path.empty() && !current.lines.empty() && HasExtension(current.path, extensions)) {
+            current.path = relative(current.path);
+            current.base_path = relative(current.base_path);
+            changes.push_back(std::move(current));
+        }
+        current = FileChange{};
+    };
+
+    // Строки содержимого ханка пропускаются по счётчикам из заголовка: они могут начинаться с "+++" или "diff"
+    std::size_t old_left = 0;
+    std::size_t new_left = 0;
+    std::string_view rest = *diff;
+    while (!rest.empty()) {
+        const auto end = std::min(rest.find('\n'), rest.size());
+        const auto line = rest.substr(0, end);
+        rest.remove_prefix(std::min(end + 1, rest.size()));
+
+        if (old_left > 0 || new_left > 0) {
+            if (line.starts_with('-') && old_left > 0)
+                --old_left;
+            else if (line.starts_with('+') && new_left > 0)
+                --new_left;
+            else if (!line.starts_with('\\'))
+                return MakeError(ErrorCode::kParse, "Unexpected line in git diff hunk: " + std::string(line));
+            continue;
+        }
+
+        if (line.starts_with("diff --git ")) {
+            finish();
+        } else if (line.starts_with("index ")) {
+            const auto dots = line.find("..");
+            const auto id = line.substr(6, dots == std::string_view::npos ? 0 : dots - 6);
+            if (id.find_first_not_of('0') != std::string_view::npos)
+                current.base_object_id = id;
+        } else if (line.starts_with("--- ")) {
+            current.base_path = line == "--- /dev/null" ? std::string() : DiffPath(line.substr(4));
+        } else if (line.starts_with("+++ ")) {
+            current.path = line == "+++ /dev/null" ? std::string() : DiffPath(line.substr(4));
+        } else if (line.starts_with("@@ ")) {
+            // "@@ -<начало>[,<число>] +<начало>[,<число>] @@ <контекст>"
+            const auto plus = line.find(" +");
+            const auto close = line.find(" @@", plus);
+            std::size_t old_start = 0;
+            std::size_t new_start = 0;
+            if (plus == std::string_view::npos || close == std::string_view::npos ||
+                !ParseHunkSide(line.substr(3, plus - 3), old_start, old_left) ||
+                !ParseHunkSide(line.substr(plus + 1, close - plus - 1), new_start, new_left))
+                return MakeError(ErrorCode::kParse, "Unexpected git diff hunk header: " + std::string(line));
+
+            // При чистом удалении new_start — строка перед удалённым фрагментом, считая с единицы
+            if (new_left > 0)
+                AddChangedLines(current.lines, {new_start - 1, new_start - 1 + new_left});
+            else
+                AddChangedLines(current.lines, {new_start > 0 ? new_start - 1 : 0, new_start + 1});
+        }
+    }
+    finish();
+    return changes;
+}
+
+Expected<std::unique_ptr<CatFileBatch>> CatFileBatch::Start(const std::string &repository) {
+    auto process = SpawnGit(repository, {"cat-file", "--batch"}, true);
+    if (!process)
+        return std::unexpected(std::move(process.error()));
+    return std::unique_ptr<CatFileBatch>(new CatFileBatch(process->pid, process->input, process->output));
+}
+
+CatFileBatch::~CatFileBatch() {
+    // EOF на stdin завершает git cat-file
+    close(input_);
+    close(output_);
+    Wait(pid_);
+}
+
+Expected<std::string> CatFileBatch::Read(std::string_view object_id) {
+    std::string request(object_id);
+    request.push_back('\n');
+    if (auto written = WriteToPipe(input_, request); !written)
+        return std::unexpected(std::move(written.error()));
+
+    // Ответ: "<id> <type> <size>\n<содержимое>\n" или "<id> missing\n"
+    auto header = ReadLine();
+    if (!header)
+        return std::unexpected(std::move(header.error()));
+    if (header->ends_with(" missing"))
+        return MakeError(ErrorCode::kIo, "Object " + std::string(object_id) + " is missing");
+
+    const auto space = header->rfind(' ');
+    std::size_t size = 0;
+    const char *header_end = header->data() + header->size();
+    if (space == std::string::npos || std::from_chars(header->data() + space + 1, header_end, size).ptr != header_end)
+        return MakeError(ErrorCode::kParse, "Unexpected git cat-file header: " + *header);
+
+    auto content = ReadExact(size + 1);
+    if (!content)
+        return std::unexpected(std::move(content.error()));
+    content->pop_back();
+    return content;
+}
+
+bool CatFileBatch::Fill() {
+    if (buffer_pos_ > 0) {
+        buffer_.erase(0, buffer_pos_);
+        buffer_pos_ = 0;
+    }
+    std::array<char, 65536> chunk;
+    for (;;) {
+        const auto count = read(output_, chunk.data(), chunk.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        buffer_.append(chunk.data(), static_cast<std::size_t>(count));
+        return true;
+    }
+}
+
+Expected<std::string> CatFileBatch::ReadLine() {
+    for (;;) {
+        const auto newline = buffer_.find('\n', buffer_pos_);
+        if (newline != std::string::npos) {
+            std::string line = buffer_.substr(buffer_pos_, newline - buffer_pos_);
+            buffer_pos_ = newline + 1;
+            return line;
+        }
+        if (!Fill())
+            return std::unexpected(GitError("git cat-file exited unexpectedly"));
+    }
+}
+
+Expected<std::string> CatFileBatch::ReadExact(std::size_t size) {
+    while (buffer_.size() - buffer_pos_ < size)
+        if (!Fill())
+            return std::unexpected(GitError("git cat-file exited unexpectedly"));
+    std::string data = buffer_.substr(buffer_pos_, size);
+    buffer_pos_ += size;
+    return data;
+}
+
+Expected<TempDirectory> TempDirectory::Create(std::string_view prefix) {
+    std::string pattern = (std::filesystem::temp_directory_path() / prefix).string() + "XXXXXX";
+    if (mkdtemp(pattern.data()) == nullptr)
+        return MakeError(ErrorCode::kIo, "Failed to create temporary directory: " + std::string(std::strerror(errno)));
+    return TempDirectory(std::filesystem::path(pattern));
+}
+
+TempDirectory::~TempDirectory() {
+    if (path_.empty())
+        return;
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+}
+
+}  // namespace analyzer::git
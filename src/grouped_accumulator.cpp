@@ -0,0 +1,32 @@
+#include "grouped_accumulator.hpp"
+
+#include <string>
+
+#include "interner.hpp"
+
+namespace analyzer::metric_accumulator {
+
+GroupingLevel GlobalLevel() {
+    return GroupingLevel{.name = "global", .build_key = [](const function::Function &, GroupingLevel::Key &key) {
+                             key = 0;
+                             return true;
+                         }};
+}
+
+GroupingLevel FileLevel() {
+    return GroupingLevel{.name = "file", .build_key = [](const function::Function &func, GroupingLevel::Key &key) {
+                             key = func.filename.Id();
+                             return true;
+                         }};
+}
+
+GroupingLevel ClassLevel() {
+    return GroupingLevel{.name = "class", .build_key = [](const function::Function &func, GroupingLevel::Key &key) {
+                             if (!func.class_name)
+                                 return false;
+                             key = interner::CombineIds(func.filename.Id(), func.class_name->Id());
+                             return true;
+                         }};
+}
+
+}  // namespace analyzer::metric_accumulator
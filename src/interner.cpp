@@ -0,0 +1,93 @@
+#include "interner.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace analyzer::interner {
+
+namespace {
+
+// id = индекс в шарде * kShards + номер шарда; пустая строка всегда получает id 0
+constexpr std::size_t kShardBits = 4;
+constexpr std::size_t kShards = std::size_t{1} << kShardBits;
+
+struct Shard {
+    std::mutex mutex;
+    std::pmr::monotonic_buffer_resource storage;  // Символы строк; память не освобождается до конца программы
+    std::unordered_map<std::string_view, StringId> ids;
+    std::vector<std::string_view> views;
+};
+
+struct Pool {
+    Pool() { shards.front().views.emplace_back(); }
+
+    std::array<Shard, kShards> shards;
+};
+
+Pool &GetPool() {
+    static Pool pool;
+    return pool;
+}
+
+std::size_t ShardOf(std::string_view value) { return std::hash<std::string_view>{}(value) & (kShards - 1); }
+
+}  // namespace
+
+StringId Intern(std::string_view value) { return detail::InternWithView(value).first; }
+
+namespace detail {
+
+std::pair<StringId, std::string_view> InternWithView(std::string_view value) {
+    if (value.empty())
+        return {0, {}};
+
+    const auto shard_index = ShardOf(value);
+    auto &shard = GetPool().shards[shard_index];
+    std::lock_guard lock(shard.mutex);
+    if (auto it = shard.ids.find(value); it != shard.ids.end())
+        return {it->second, it->first};
+
+    const auto id = shard.views.size() * kShards + shard_index;
+    if (id > std::numeric_limits<StringId>::max())
+        throw std::length_error("String interner is out of ids");
+
+    auto *data = static_cast<char *>(shard.storage.allocate(value.size(), alignof(char)));
+    std::memcpy(data, value.data(), value.size());
+    const std::string_view stored(data, value.size());
+    shard.views.push_back(stored);
+    shard.ids.emplace(stored, static_cast<StringId>(id));
+    return {static_cast<StringId>(id), stored};
+}
+
+}  // namespace detail
+
+std::optional<StringId> Find(std::string_view value) {
+    if (value.empty())
+        return 0;
+
+    auto &shard = GetPool().shards[ShardOf(value)];
+    std::lock_guard lock(shard.mutex);
+    if (auto it = shard.ids.find(value); it != shard.ids.end())
+        return it->second;
+    return std::nullopt;
+}
+
+std::string_view Lookup(StringId id) {
+    auto &shard = GetPool().shards[id & (kShards - 1)];
+    const auto index = id >> kShardBits;
+    std::lock_guard lock(shard.mutex);
+    if (index >= shard.views.size())
+        throw std::out_of_range("Unknown interned string id " + std::to_string(id));
+    return shard.views[index];
+}
+
+}  // namespace analyzer::interner
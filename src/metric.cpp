@@ -12,29 +12,127 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <mutex>
+#include <optional>
 #include <ranges>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
 #include "function.hpp"
+#include "interner.hpp"
+#include "metric_memo.hpp"
 
 namespace analyzer::metric {
 
+namespace {
+
+// Ключ — id интернированного имени, поэтому поиск не хеширует строку
+struct MetricRegistry {
+    std::mutex mutex;
+    std::unordered_map<interner::StringId, MetricId> ids;
+};
+
+MetricRegistry &GetRegistry() {
+    static MetricRegistry registry;
+    return registry;
+}
+
+std::optional<MetricId> FindMetricId(interner::StringId name_id) {
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (auto it = registry.ids.find(name_id); it != registry.ids.end())
+        return it->second;
+    return std::nullopt;
+}
+
+}  // namespace
+
+MetricId RegisterMetricName(std::string_view metric_name) {
+    const auto name_id = interner::Intern(metric_name);
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    const auto [it, inserted] = registry.ids.try_emplace(name_id, static_cast<MetricId>(registry.ids.size()));
+    return it->second;
+}
+
+std::optional<MetricId> FindMetricId(std::string_view metric_name) {
+    const auto name_id = interner::Find(metric_name);
+    return name_id ? FindMetricId(*name_id) : std::nullopt;
+}
+
+std::optional<MetricId> ResolveMetricId(const MetricResult &metric_result) {
+    if (metric_result.metric_id != kUnknownMetricId)
+        return metric_result.metric_id;
+    return FindMetricId(metric_result.metric_name.Id());
+}
+
+const IMetric::MetricInfo &IMetric::Info() const {
+    std::call_once(info_once_, [this] {
+        info_.name = Name();
+        info_.id = RegisterMetricName(info_.name.View());
+    });
+    return info_;
+}
+
 void MetricExtractor::RegisterMetric(std::unique_ptr<IMetric> metric) {
     if (!metric)
         throw std::invalid_argument("Metric pointer is null");
+    metric->Id();  // Регистрирует имя метрики до первого вычисления
     metrics.push_back(std::move(metric));
 }
 
-MetricResults MetricExtractor::Get(const function::Function &func) const {
-    MetricResults results;
+MetricResults MetricExtractor::Get(const function::Function &func, std::pmr::memory_resource *resource) const {
+    MetricResults results(resource);
     results.reserve(metrics.size());
     for (const auto &metric : metrics)
         results.push_back(metric->Calculate(func));
     return results;
 }
 
+MetricResults MetricExtractor::Get(const function::Function &func, std::pmr::memory_resource *resource,
+                                   std::vector<MetricError> &errors) const {
+    MetricResults results(resource);
+    results.reserve(metrics.size());
+
+    // Имена структурных метрик входят в ключ: запись другого набора метрик, например из файла
+    // прошлого запуска, не подойдёт
+    std::uint64_t key = 0;
+    std::shared_ptr<const MetricMemo::Entry> memoized;
+    if (memo) {
+        std::uint64_t seed = kAstHashSeed;
+        for (const auto &metric : metrics)
+            if (metric->IsStructural())
+                seed = NormalizedAstHash(metric->MetricName().View(), seed);
+        key = NormalizedAstHash(func.ast, seed);
+        memoized = memo->Find(key);
+    }
+
+    bool memoizable = memo != nullptr && !memoized;
+    MetricMemo::Entry structural;
+    std::size_t next_memoized = 0;
+    for (const auto &metric : metrics) {
+        const bool is_structural = metric->IsStructural();
+        if (memoized && is_structural && next_memoized < memoized->size()) {
+            results.push_back((*memoized)[next_memoized++]);
+            continue;
+        }
+        if (auto result = metric->TryCalculate(func)) {
+            if (memoizable && is_structural)
+                structural.push_back(*result);
+            results.push_back(std::move(*result));
+        } else {
+            memoizable = memoizable && !is_structural;  // Ошибки не мемоизируются: у каждой копии своя запись
+            errors.push_back(MetricError{.metric_name = metric->MetricName(), .error = std::move(result.error())});
+        }
+    }
+    if (memoizable && !structural.empty())
+        memo->Store(key, std::move(structural));
+    return results;
+}
+
 }  // namespace analyzer::metric
@@ -11,9 +11,12 @@
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <ranges>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -22,16 +25,121 @@ using namespace std;
 
 namespace analyzer::metric_accumulator {
 
-void MetricsAccumulator::AccumulateNextFunctionResults(const std::vector<metric::MetricResult> &metric_results) const {
-    auto results =
-        metric_results | views::filter([&](const auto &result) { return accumulators.contains(result.metric_name); });
-    ranges::for_each(results, [&](const auto &result) { accumulators.at(result.metric_name)->Accumulate(result); });
+void IAccumulator::AccumulateFunctionResult(const function::Function & /*function*/,
+                                            const metric::MetricResult &metric_result) {
+    Accumulate(metric_result);
+}
+
+void MetricsAccumulator::AccumulateNextFunctionResults(const metric::MetricResults &metric_results) const {
+    ranges::for_each(metric_results, [&](const auto &result) {
+        if (auto *acc = FindAccumulator(result))
+            acc->Accumulate(result);
+    });
+}
+
+void MetricsAccumulator::AccumulateNextFunctionResults(const function::Function &function,
+                                                       const metric::MetricResults &metric_results) const {
+    ranges::for_each(metric_results, [&](const auto &result) {
+        if (auto *acc = FindAccumulator(result))
+            acc->AccumulateFunctionResult(function, result);
+    });
+}
+
+void IAccumulator::AccumulateBatch(std::span<const int> values) {
+    ranges::for_each(values, [this](int value) { Accumulate(metric::MetricResult{.value = value}); });
+}
+
+void IAccumulator::AccumulateFunctionBatch(std::span<const function::Function *const> /*functions*/,
+                                           std::span<const int> values) {
+    AccumulateBatch(values);
+}
+
+void ValueColumn::Append(IAccumulator &accumulator, const function::Function *function,
+                         const metric::MetricResult &result) {
+    if (const auto *value = std::get_if<int>(&result.value)) {
+        if (function)
+            functions.push_back(function);
+        values.push_back(*value);
+        return;
+    }
+    FlushInto(accumulator);
+    if (function)
+        accumulator.AccumulateFunctionResult(*function, result);
+    else
+        accumulator.Accumulate(result);
+}
+
+void ValueColumn::FlushInto(IAccumulator &accumulator) {
+    if (values.empty())
+        return;
+    if (functions.empty())
+        accumulator.AccumulateBatch(values);
+    else
+        accumulator.AccumulateFunctionBatch(functions, values);
+    functions.clear();
+    values.clear();
+}
+
+void IAccumulator::Retract(const metric::MetricResult & /*metric_result*/) {
+    throw std::logic_error("Accumulator does not support retraction");
+}
+
+metric::MetricId MetricsAccumulator::ResolveId(const metric::MetricResult &metric_result) const {
+    if (metric_result.metric_id != metric::kUnknownMetricId)
+        return metric_result.metric_id;
+    return metric::ResolveMetricId(metric_result).value_or(metric::kUnknownMetricId);
+}
+
+IAccumulator *MetricsAccumulator::FindAccumulator(const metric::MetricResult &metric_result) const {
+    const auto id = ResolveId(metric_result);
+    return id < accumulators.size() ? accumulators[id].accumulator.get() : nullptr;
+}
+
+void MetricsAccumulator::AppendToColumn(const function::Function *function, const metric::MetricResult &metric_result,
+                                        std::vector<ValueColumn> &columns) const {
+    const auto id = ResolveId(metric_result);
+    if (id < accumulators.size() && accumulators[id].accumulator)
+        columns[id].Append(*accumulators[id].accumulator, function, metric_result);
+}
+
+void MetricsAccumulator::FlushColumns(std::vector<ValueColumn> &columns) const {
+    for (size_t id = 0; id < columns.size(); ++id)
+        if (accumulators[id].accumulator)
+            columns[id].FlushInto(*accumulators[id].accumulator);
+}
+
+void IAccumulator::Merge(const IAccumulator & /*other*/) {
+    throw std::logic_error("Accumulator does not support merging");
+}
+
+void MetricsAccumulator::Merge(const MetricsAccumulator &other) {
+    const auto size = std::max(accumulators.size(), other.accumulators.size());
+    auto registered = [](const std::vector<Slot> &slots, size_t id) {
+        return id < slots.size() && slots[id].accumulator;
+    };
+    for (size_t id = 0; id < size; ++id)
+        if (registered(accumulators, id) != registered(other.accumulators, id))
+            throw std::invalid_argument("Cannot merge MetricsAccumulator with different metric sets");
+    for (size_t id = 0; id < size; ++id)
+        if (registered(accumulators, id))
+            accumulators[id].accumulator->Merge(*other.accumulators[id].accumulator);
+}
+
+void MergeTree(std::vector<MetricsAccumulator> &partials) {
+    for (size_t stride = 1; stride < partials.size(); stride *= 2) {
+        std::vector<std::future<void>> merges;
+        for (size_t i = 0; i + stride < partials.size(); i += 2 * stride)
+            merges.push_back(std::async(std::launch::async, [&partials, i, stride] {
+                partials[i].Merge(partials[i + stride]);
+            }));
+        ranges::for_each(merges, [](auto &merge) { merge.get(); });
+    }
 }
 
 void MetricsAccumulator::ResetAccumulators() {
-    ranges::for_each(accumulators, [](auto &pair) {
-        if (pair.second)
-            pair.second->Reset();
+    ranges::for_each(accumulators, [](auto &slot) {
+        if (slot.accumulator)
+            slot.accumulator->Reset();
     });
 }
 
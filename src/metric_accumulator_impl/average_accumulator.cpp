@@ -13,6 +13,7 @@
 #include <iostream>
 #include <ranges>
 #include <stdexcept>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -39,6 +40,38 @@ void AverageAccumulator::Accumulate(const metric::MetricResult &metric_result) {
     ++count;
 }
 
+void AverageAccumulator::AccumulateBatch(std::span<const int> values) {
+    if (is_finalized)
+        throw std::logic_error("AverageAccumulator cannot accumulate after finalization");
+
+    std::int64_t batch_sum = 0;
+    for (int value : values)
+        batch_sum += value;
+    sum += batch_sum;
+    count += static_cast<std::int64_t>(values.size());
+}
+
+void AverageAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("AverageAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const AverageAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("AverageAccumulator can only merge with AverageAccumulator");
+    sum += typed->sum;
+    count += typed->count;
+}
+
+void AverageAccumulator::Retract(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("AverageAccumulator cannot retract after finalization");
+    if (count == 0)
+        throw std::logic_error("AverageAccumulator has no values to retract");
+
+    sum -= ExtractIntValue(metric_result, "AverageAccumulator");
+    --count;
+}
+
 void AverageAccumulator::Finalize() {
     if (is_finalized)
         return;
@@ -39,6 +39,17 @@ void CategoricalAccumulator::Accumulate(const metric::MetricResult &metric_resul
     ++categories_freq[category];
 }
 
+void CategoricalAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("CategoricalAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const CategoricalAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("CategoricalAccumulator can only merge with CategoricalAccumulator");
+    for (const auto &[category, freq] : typed->categories_freq)
+        categories_freq[category] += freq;
+}
+
 void CategoricalAccumulator::Finalize() {
     if (is_finalized)
         return;
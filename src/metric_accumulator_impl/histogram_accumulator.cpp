@@ -0,0 +1,156 @@
+#include "metric_accumulator_impl/histogram_accumulator.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+namespace {
+
+constexpr unsigned kValueBits = std::numeric_limits<int>::digits;
+
+int ExtractIntValue(const metric::MetricResult &metric_result, std::string_view context) {
+    if (!std::holds_alternative<int>(metric_result.value))
+        throw std::invalid_argument(std::string(context) + " expects integer metric values");
+    return std::get<int>(metric_result.value);
+}
+
+}  // namespace
+
+HistogramAccumulator::HistogramAccumulator() : HistogramAccumulator(kDefaultSubBucketBits) {}
+
+HistogramAccumulator::HistogramAccumulator(unsigned sub_bucket_bits) : sub_bucket_bits{sub_bucket_bits} {
+    if (sub_bucket_bits > kMaxSubBucketBits)
+        throw std::invalid_argument("HistogramAccumulator supports at most " + std::to_string(kMaxSubBucketBits) +
+                                    " sub-bucket bits");
+    const std::size_t sub_buckets = std::size_t{1} << sub_bucket_bits;
+    counters.assign(sub_buckets + (kValueBits - sub_bucket_bits) * sub_buckets, 0);
+}
+
+void HistogramAccumulator::Accumulate(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("HistogramAccumulator cannot accumulate after finalization");
+
+    const int value = ExtractIntValue(metric_result, "HistogramAccumulator");
+    if (value < 0)
+        throw std::invalid_argument("HistogramAccumulator expects non-negative metric values");
+    ++counters[BucketIndex(value)];
+    ++count;
+}
+
+// Проверка знака — отдельная редукция min, чтобы цикл раскладки по корзинам остался без ветвлений
+void HistogramAccumulator::AccumulateBatch(std::span<const int> values) {
+    if (is_finalized)
+        throw std::logic_error("HistogramAccumulator cannot accumulate after finalization");
+    if (values.empty())
+        return;
+    if (std::ranges::min(values) < 0)
+        throw std::invalid_argument("HistogramAccumulator expects non-negative metric values");
+
+    for (int value : values)
+        ++counters[BucketIndex(value)];
+    count += values.size();
+}
+
+void HistogramAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("HistogramAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const HistogramAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("HistogramAccumulator can only merge with HistogramAccumulator");
+    if (typed->sub_bucket_bits != sub_bucket_bits)
+        throw std::invalid_argument("HistogramAccumulator can only merge histograms with the same precision");
+
+    std::ranges::transform(counters, typed->counters, counters.begin(), std::plus{});
+    count += typed->count;
+}
+
+void HistogramAccumulator::Finalize() {
+    if (is_finalized)
+        return;
+
+    buckets.clear();
+    cumulative.clear();
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < counters.size(); ++index) {
+        if (counters[index] == 0)
+            continue;
+        auto bucket = BucketBounds(index);
+        bucket.count = counters[index];
+        seen += bucket.count;
+        buckets.push_back(bucket);
+        cumulative.push_back(CumulativeBucket{.upper = bucket.upper,
+                                              .count = seen,
+                                              .fraction = static_cast<double>(seen) / static_cast<double>(count)});
+    }
+    is_finalized = true;
+}
+
+void HistogramAccumulator::Reset() {
+    std::ranges::fill(counters, 0);
+    count = 0;
+    buckets.clear();
+    cumulative.clear();
+    is_finalized = false;
+}
+
+const std::vector<HistogramAccumulator::Bucket> &HistogramAccumulator::Get() const {
+    if (!is_finalized)
+        throw std::logic_error("HistogramAccumulator::Get requires finalized state");
+    return buckets;
+}
+
+const std::vector<HistogramAccumulator::CumulativeBucket> &HistogramAccumulator::GetCumulative() const {
+    if (!is_finalized)
+        throw std::logic_error("HistogramAccumulator::GetCumulative requires finalized state");
+    return cumulative;
+}
+
+std::uint64_t HistogramAccumulator::Count() const { return count; }
+
+// Старший бит задаёт диапазон [2^h, 2^(h+1)), следующие sub_bucket_bits бит — корзину внутри него
+std::size_t HistogramAccumulator::BucketIndex(int value) const {
+    const auto unsigned_value = static_cast<unsigned>(value);
+    const unsigned sub_buckets = 1u << sub_bucket_bits;
+    if (unsigned_value < sub_buckets)
+        return unsigned_value;
+
+    const unsigned magnitude = std::bit_width(unsigned_value) - 1;
+    const unsigned shift = magnitude - sub_bucket_bits;
+    const unsigned mantissa = (unsigned_value >> shift) & (sub_buckets - 1);
+    return sub_buckets + std::size_t{shift} * sub_buckets + mantissa;
+}
+
+HistogramAccumulator::Bucket HistogramAccumulator::BucketBounds(std::size_t index) const {
+    const std::size_t sub_buckets = std::size_t{1} << sub_bucket_bits;
+    if (index < sub_buckets)
+        return Bucket{.lower = static_cast<int>(index), .upper = static_cast<int>(index), .count = 0};
+
+    const std::size_t shift = (index - sub_buckets) / sub_buckets;
+    const std::size_t mantissa = (index - sub_buckets) % sub_buckets;
+    const auto lower = (std::uint64_t{1} << (shift + sub_bucket_bits)) + (std::uint64_t{mantissa} << shift);
+    const auto upper = lower + (std::uint64_t{1} << shift) - 1;
+    return Bucket{.lower = static_cast<int>(lower), .upper = static_cast<int>(upper), .count = 0};
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
@@ -0,0 +1,161 @@
+#include "metric_accumulator_impl/hyperloglog_accumulator.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+namespace {
+
+const std::string &ExtractStringValue(const metric::MetricResult &metric_result, std::string_view context) {
+    if (!std::holds_alternative<std::string>(metric_result.value))
+        throw std::invalid_argument(std::string(context) + " expects string metric values");
+    return std::get<std::string>(metric_result.value);
+}
+
+// FNV-1a с финальным перемешиванием splitmix64: хеш не зависит от реализации std::hash,
+// поэтому частичные аккумуляторы из разных потоков и запусков совместимы
+std::uint64_t Hash(std::string_view value) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char ch : value) {
+        hash ^= ch;
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+}  // namespace
+
+HyperLogLogAccumulator::HyperLogLogAccumulator() : HyperLogLogAccumulator(kDefaultPrecision) {}
+
+HyperLogLogAccumulator::HyperLogLogAccumulator(unsigned precision, std::size_t exact_threshold)
+    : precision{precision}, exact_threshold{exact_threshold} {
+    if (precision < kMinPrecision || precision > kMaxPrecision)
+        throw std::invalid_argument("HyperLogLogAccumulator precision must be in [" + std::to_string(kMinPrecision) +
+                                    ", " + std::to_string(kMaxPrecision) + "]");
+    if (exact_threshold == 0)
+        SwitchToRegisters();
+}
+
+void HyperLogLogAccumulator::Accumulate(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("HyperLogLogAccumulator cannot accumulate after finalization");
+
+    Add(Hash(ExtractStringValue(metric_result, "HyperLogLogAccumulator")));
+}
+
+void HyperLogLogAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("HyperLogLogAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const HyperLogLogAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("HyperLogLogAccumulator can only merge with HyperLogLogAccumulator");
+    if (typed->precision != precision)
+        throw std::invalid_argument("HyperLogLogAccumulator can only merge sketches with the same precision");
+
+    if (typed->IsExact()) {
+        for (auto hash : typed->exact_hashes)
+            Add(hash);
+        return;
+    }
+    if (IsExact())
+        SwitchToRegisters();
+    std::ranges::transform(registers, typed->registers, registers.begin(),
+                           [](std::uint8_t lhs, std::uint8_t rhs) { return std::max(lhs, rhs); });
+}
+
+void HyperLogLogAccumulator::Finalize() {
+    if (is_finalized)
+        return;
+
+    estimate = IsExact() ? exact_hashes.size() : Estimate();
+    is_finalized = true;
+}
+
+void HyperLogLogAccumulator::Reset() {
+    exact_hashes.clear();
+    registers.clear();
+    if (exact_threshold == 0)
+        SwitchToRegisters();
+    estimate = 0;
+    is_finalized = false;
+}
+
+std::uint64_t HyperLogLogAccumulator::Get() const {
+    if (!is_finalized)
+        throw std::logic_error("HyperLogLogAccumulator::Get requires finalized state");
+    return estimate;
+}
+
+bool HyperLogLogAccumulator::IsExact() const { return registers.empty(); }
+
+void HyperLogLogAccumulator::Add(std::uint64_t hash) {
+    if (!IsExact()) {
+        AddToRegisters(hash);
+        return;
+    }
+    exact_hashes.insert(hash);
+    if (exact_hashes.size() > exact_threshold)
+        SwitchToRegisters();
+}
+
+// Старшие precision бит хеша выбирают регистр, в нём хранится максимальная позиция первой единицы в остатке
+void HyperLogLogAccumulator::AddToRegisters(std::uint64_t hash) {
+    const auto index = static_cast<std::size_t>(hash >> (64 - precision));
+    const auto remainder = hash << precision;
+    const auto rank = static_cast<std::uint8_t>(std::min<unsigned>(std::countl_zero(remainder), 64 - precision) + 1);
+    registers[index] = std::max(registers[index], rank);
+}
+
+void HyperLogLogAccumulator::SwitchToRegisters() {
+    registers.assign(std::size_t{1} << precision, 0);
+    for (auto hash : exact_hashes)
+        AddToRegisters(hash);
+    exact_hashes.clear();
+}
+
+std::uint64_t HyperLogLogAccumulator::Estimate() const {
+    const auto m = static_cast<double>(registers.size());
+    double inverse_sum = 0;
+    std::size_t zeros = 0;
+    for (auto rank : registers) {
+        inverse_sum += std::ldexp(1.0, -static_cast<int>(rank));
+        zeros += rank == 0;
+    }
+
+    const double alpha = registers.size() == 16   ? 0.673
+                         : registers.size() == 32 ? 0.697
+                         : registers.size() == 64 ? 0.709
+                                                  : 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / inverse_sum;
+    // Поправка на малые кардинальности: пока есть пустые регистры, точнее линейный подсчёт
+    if (raw <= 2.5 * m && zeros != 0)
+        raw = m * std::log(m / static_cast<double>(zeros));
+    return static_cast<std::uint64_t>(std::llround(raw));
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
@@ -0,0 +1,143 @@
+#include "metric_accumulator_impl/moments_accumulator.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+namespace {
+
+int ExtractIntValue(const metric::MetricResult &metric_result, std::string_view context) {
+    if (!std::holds_alternative<int>(metric_result.value))
+        throw std::invalid_argument(std::string(context) + " expects integer metric values");
+    return std::get<int>(metric_result.value);
+}
+
+}  // namespace
+
+void MomentsAccumulator::Accumulate(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("MomentsAccumulator cannot accumulate after finalization");
+
+    const std::int64_t value = ExtractIntValue(metric_result, "MomentsAccumulator");
+    min = count == 0 ? value : std::min(min, value);
+    max = count == 0 ? value : std::max(max, value);
+    sum += value;
+    ++count;
+
+    const double delta = static_cast<double>(value) - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (static_cast<double>(value) - mean);
+}
+
+void MomentsAccumulator::Accumulate(std::span<const std::int64_t> values) {
+    AccumulateValues(values);
+}
+
+void MomentsAccumulator::AccumulateBatch(std::span<const int> values) {
+    AccumulateValues(values);
+}
+
+template <typename Value>
+void MomentsAccumulator::AccumulateValues(std::span<const Value> values) {
+    if (is_finalized)
+        throw std::logic_error("MomentsAccumulator cannot accumulate after finalization");
+    if (values.empty())
+        return;
+
+    std::int64_t batch_sum = 0;
+    std::int64_t batch_min = values.front();
+    std::int64_t batch_max = values.front();
+    for (std::int64_t value : values) {
+        batch_sum += value;
+        batch_min = std::min(batch_min, value);
+        batch_max = std::max(batch_max, value);
+    }
+
+    const auto batch_count = static_cast<std::int64_t>(values.size());
+    const double batch_mean = static_cast<double>(batch_sum) / static_cast<double>(batch_count);
+    double batch_m2 = 0;
+    for (std::int64_t value : values) {
+        const double delta = static_cast<double>(value) - batch_mean;
+        batch_m2 += delta * delta;
+    }
+
+    Combine(batch_count, batch_sum, batch_min, batch_max, batch_mean, batch_m2);
+}
+
+void MomentsAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("MomentsAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const MomentsAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("MomentsAccumulator can only merge with MomentsAccumulator");
+    Combine(typed->count, typed->sum, typed->min, typed->max, typed->mean, typed->m2);
+}
+
+void MomentsAccumulator::Finalize() {
+    if (is_finalized)
+        return;
+
+    variance = count == 0 ? 0.0 : m2 / static_cast<double>(count);
+    is_finalized = true;
+}
+
+void MomentsAccumulator::Reset() {
+    count = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+    mean = 0.0;
+    m2 = 0.0;
+    variance = 0.0;
+    is_finalized = false;
+}
+
+MomentsAccumulator::Moments MomentsAccumulator::Get() const {
+    if (!is_finalized)
+        throw std::logic_error("MomentsAccumulator::Get requires finalized state");
+    return Moments{.count = count,
+                   .sum = sum,
+                   .min = min,
+                   .max = max,
+                   .mean = mean,
+                   .variance = variance,
+                   .stddev = std::sqrt(variance)};
+}
+
+void MomentsAccumulator::Combine(std::int64_t other_count, std::int64_t other_sum, std::int64_t other_min,
+                                 std::int64_t other_max, double other_mean, double other_m2) {
+    if (other_count == 0)
+        return;
+
+    const auto total = count + other_count;
+    const double delta = other_mean - mean;
+    mean += delta * static_cast<double>(other_count) / static_cast<double>(total);
+    m2 += other_m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other_count) /
+                         static_cast<double>(total);
+
+    min = count == 0 ? other_min : std::min(min, other_min);
+    max = count == 0 ? other_max : std::max(max, other_max);
+    sum += other_sum;
+    count = total;
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
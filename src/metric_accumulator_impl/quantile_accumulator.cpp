@@ -0,0 +1,182 @@
+#include "metric_accumulator_impl/quantile_accumulator.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <stdexcept>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+namespace {
+
+constexpr double kCapacityDecay = 2.0 / 3.0;
+constexpr std::size_t kMinCapacity = 2;
+constexpr std::minstd_rand::result_type kSeed = 42;
+
+int ExtractIntValue(const metric::MetricResult &metric_result, std::string_view context) {
+    if (!std::holds_alternative<int>(metric_result.value))
+        throw std::invalid_argument(std::string(context) + " expects integer metric values");
+    return std::get<int>(metric_result.value);
+}
+
+}  // namespace
+
+QuantileAccumulator::QuantileAccumulator() : QuantileAccumulator(kDefaultK) {}
+
+QuantileAccumulator::QuantileAccumulator(std::size_t k) : k{k}, compactors(1), random{kSeed} {
+    if (k < kMinK)
+        throw std::invalid_argument("QuantileAccumulator requires k >= " + std::to_string(kMinK));
+}
+
+void QuantileAccumulator::Accumulate(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("QuantileAccumulator cannot accumulate after finalization");
+
+    Insert(ExtractIntValue(metric_result, "QuantileAccumulator"));
+}
+
+void QuantileAccumulator::AccumulateBatch(std::span<const int> values) {
+    if (is_finalized)
+        throw std::logic_error("QuantileAccumulator cannot accumulate after finalization");
+
+    for (int value : values)
+        Insert(value);
+}
+
+void QuantileAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("QuantileAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const QuantileAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("QuantileAccumulator can only merge with QuantileAccumulator");
+    // Уровни вливаются вставкой диапазона в свой же вектор
+    if (typed == this)
+        throw std::invalid_argument("QuantileAccumulator cannot merge with itself");
+    if (typed->k != k)
+        throw std::invalid_argument("QuantileAccumulator can only merge sketches with the same k");
+    if (typed->count == 0)
+        return;
+
+    min = count == 0 ? typed->min : std::min(min, typed->min);
+    max = count == 0 ? typed->max : std::max(max, typed->max);
+    count += typed->count;
+
+    if (compactors.size() < typed->compactors.size())
+        compactors.resize(typed->compactors.size());
+    for (std::size_t level = 0; level < typed->compactors.size(); ++level)
+        compactors[level].insert(compactors[level].end(), typed->compactors[level].begin(),
+                                 typed->compactors[level].end());
+    Compress();
+}
+
+void QuantileAccumulator::Finalize() {
+    if (is_finalized)
+        return;
+
+    cumulative.clear();
+    cumulative.reserve(RetainedItems());
+    for (std::size_t level = 0; level < compactors.size(); ++level)
+        for (int value : compactors[level])
+            cumulative.emplace_back(value, std::uint64_t{1} << level);
+    std::ranges::sort(cumulative, {}, &std::pair<int, std::uint64_t>::first);
+
+    std::uint64_t total = 0;
+    for (auto &[value, weight] : cumulative) {
+        total += weight;
+        weight = total;
+    }
+    is_finalized = true;
+}
+
+void QuantileAccumulator::Reset() {
+    count = 0;
+    min = 0;
+    max = 0;
+    compactors.assign(1, {});
+    random.seed(kSeed);
+    cumulative.clear();
+    is_finalized = false;
+}
+
+int QuantileAccumulator::Get(double q) const {
+    if (!is_finalized)
+        throw std::logic_error("QuantileAccumulator::Get requires finalized state");
+    if (!(q >= 0.0 && q <= 1.0))
+        throw std::invalid_argument("QuantileAccumulator::Get expects q in [0, 1]");
+    if (count == 0)
+        return 0;
+    if (q == 0.0)
+        return min;
+    if (q == 1.0)
+        return max;
+
+    const auto total = cumulative.back().second;
+    const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * total)));
+    auto it = std::ranges::lower_bound(cumulative, target, {}, &std::pair<int, std::uint64_t>::second);
+    return it == cumulative.end() ? max : it->first;
+}
+
+std::int64_t QuantileAccumulator::Count() const { return count; }
+
+std::size_t QuantileAccumulator::RetainedItems() const {
+    std::size_t items = 0;
+    for (const auto &compactor : compactors)
+        items += compactor.size();
+    return items;
+}
+
+void QuantileAccumulator::Insert(int value) {
+    min = count == 0 ? value : std::min(min, value);
+    max = count == 0 ? value : std::max(max, value);
+    ++count;
+
+    compactors.front().push_back(value);
+    if (compactors.front().size() >= Capacity(0))
+        Compress();
+}
+
+// Каждый переполненный уровень сортируется, и половина его значений (чётные или нечётные позиции,
+// выбор случаен) переходит на следующий уровень с удвоенным весом. Непарное значение остаётся на месте.
+void QuantileAccumulator::Compress() {
+    for (std::size_t level = 0; level < compactors.size(); ++level) {
+        if (compactors[level].size() < Capacity(level))
+            continue;
+        if (level + 1 == compactors.size())
+            compactors.emplace_back();
+
+        auto &items = compactors[level];
+        auto &next = compactors[level + 1];
+        std::ranges::sort(items);
+
+        const std::size_t leftover = items.size() % 2;
+        const std::size_t offset = leftover + (random() & 1u);
+        for (std::size_t i = offset; i < items.size(); i += 2)
+            next.push_back(items[i]);
+        items.resize(leftover);
+    }
+}
+
+std::size_t QuantileAccumulator::Capacity(std::size_t level) const {
+    const auto depth = static_cast<double>(compactors.size() - 1 - level);
+    const auto capacity = static_cast<std::size_t>(std::ceil(static_cast<double>(k) * std::pow(kCapacityDecay, depth)));
+    return std::max(capacity, kMinCapacity);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
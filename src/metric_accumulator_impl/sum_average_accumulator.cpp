@@ -13,6 +13,7 @@
 #include <iostream>
 #include <ranges>
 #include <stdexcept>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -39,6 +40,38 @@ void SumAverageAccumulator::Accumulate(const metric::MetricResult &metric_result
     ++count;
 }
 
+void SumAverageAccumulator::AccumulateBatch(std::span<const int> values) {
+    if (is_finalized)
+        throw std::logic_error("SumAverageAccumulator cannot accumulate after finalization");
+
+    std::int64_t batch_sum = 0;
+    for (int value : values)
+        batch_sum += value;
+    sum += batch_sum;
+    count += static_cast<std::int64_t>(values.size());
+}
+
+void SumAverageAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("SumAverageAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const SumAverageAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("SumAverageAccumulator can only merge with SumAverageAccumulator");
+    sum += typed->sum;
+    count += typed->count;
+}
+
+void SumAverageAccumulator::Retract(const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("SumAverageAccumulator cannot retract after finalization");
+    if (count == 0)
+        throw std::logic_error("SumAverageAccumulator has no values to retract");
+
+    sum -= ExtractIntValue(metric_result, "SumAverageAccumulator");
+    --count;
+}
+
 void SumAverageAccumulator::Finalize() {
     if (is_finalized)
         return;
@@ -3,8 +3,10 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
 
@@ -78,4 +80,56 @@ TEST(AverageAccumulatorTest, RejectsNonIntegerValues) {
     EXPECT_THROW(accumulator.Accumulate(wrong_value), std::invalid_argument);
 }
 
+TEST(AverageAccumulatorTest, BatchMatchesScalarAccumulation) {
+    const std::vector<int> values = {2, 4, 9, 1};
+    AverageAccumulator scalar;
+    AverageAccumulator batch;
+    for (int value : values)
+        scalar.Accumulate(MakeMetricResult(value));
+    batch.AccumulateBatch(values);
+    batch.AccumulateBatch({});
+    scalar.Finalize();
+    batch.Finalize();
+
+    EXPECT_DOUBLE_EQ(batch.Get(), scalar.Get());
+}
+
+TEST(AverageAccumulatorTest, BatchAfterFinalizeThrows) {
+    AverageAccumulator accumulator;
+    accumulator.Finalize();
+
+    const std::vector<int> values = {1};
+    EXPECT_THROW(accumulator.AccumulateBatch(values), std::logic_error);
+}
+
+TEST(AverageAccumulatorTest, MergeMatchesSerialAccumulation) {
+    AverageAccumulator serial;
+    AverageAccumulator left;
+    AverageAccumulator right;
+    for (int value : {1, 2}) {
+        left.Accumulate(MakeMetricResult(value));
+        serial.Accumulate(MakeMetricResult(value));
+    }
+    for (int value : {7, 11, 13}) {
+        right.Accumulate(MakeMetricResult(value));
+        serial.Accumulate(MakeMetricResult(value));
+    }
+
+    left.Merge(right);
+    left.Finalize();
+    serial.Finalize();
+
+    EXPECT_DOUBLE_EQ(left.Get(), serial.Get());
+}
+
+TEST(AverageAccumulatorTest, MergeWithEmptyAccumulatorKeepsState) {
+    AverageAccumulator accumulator;
+    AverageAccumulator empty;
+    accumulator.Accumulate(MakeMetricResult(6));
+    accumulator.Merge(empty);
+    accumulator.Finalize();
+
+    EXPECT_DOUBLE_EQ(accumulator.Get(), 6.0);
+}
+
 }  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
@@ -92,4 +92,30 @@ TEST(CategoricalAccumulatorTest, GetBeforeFinalizeThrows) {
     EXPECT_THROW(accumulator.Get(), std::logic_error);
 }
 
+TEST(CategoricalAccumulatorTest, MergeSumsFrequencies) {
+    CategoricalAccumulator left;
+    CategoricalAccumulator right;
+    left.Accumulate(MakeCategoryResult("alpha"));
+    left.Accumulate(MakeCategoryResult("beta"));
+    right.Accumulate(MakeCategoryResult("beta"));
+    right.Accumulate(MakeCategoryResult("gamma"));
+
+    left.Merge(right);
+    left.Finalize();
+
+    const auto &freq = left.Get();
+    ASSERT_EQ(freq.size(), 3u);
+    EXPECT_EQ(freq.at("alpha"), 1);
+    EXPECT_EQ(freq.at("beta"), 2);
+    EXPECT_EQ(freq.at("gamma"), 1);
+}
+
+TEST(CategoricalAccumulatorTest, MergeAfterFinalizeThrows) {
+    CategoricalAccumulator accumulator;
+    CategoricalAccumulator other;
+    accumulator.Finalize();
+
+    EXPECT_THROW(accumulator.Merge(other), std::logic_error);
+}
+
 }  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
@@ -0,0 +1,137 @@
+#include "metric_accumulator_impl/histogram_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
+
+namespace {
+
+metric::MetricResult MakeMetricResult(int value) {
+    return metric::MetricResult{.metric_name = "metric", .value = value};
+}
+
+using Bucket = HistogramAccumulator::Bucket;
+
+}  // namespace
+
+TEST(HistogramAccumulatorTest, SmallValuesHaveExactBuckets) {
+    HistogramAccumulator accumulator(3);
+    for (int value : {0, 1, 1, 7})
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(), (std::vector<Bucket>{{0, 0, 1}, {1, 1, 2}, {7, 7, 1}}));
+}
+
+TEST(HistogramAccumulatorTest, LargeValuesUseLogLinearBuckets) {
+    HistogramAccumulator accumulator(2);
+    for (int value : {8, 9, 10, 11, 100})
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(), (std::vector<Bucket>{{8, 9, 2}, {10, 11, 2}, {96, 111, 1}}));
+}
+
+TEST(HistogramAccumulatorTest, BucketsCoverWholeIntRange) {
+    HistogramAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(std::numeric_limits<int>::max()));
+    accumulator.Finalize();
+
+    ASSERT_EQ(accumulator.Get().size(), 1u);
+    EXPECT_EQ(accumulator.Get().front().upper, std::numeric_limits<int>::max());
+    EXPECT_LE(accumulator.Get().front().lower, std::numeric_limits<int>::max());
+}
+
+TEST(HistogramAccumulatorTest, CumulativeDistribution) {
+    HistogramAccumulator accumulator(3);
+    for (int value : {1, 2, 2, 5})
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    const auto &cdf = accumulator.GetCumulative();
+    ASSERT_EQ(cdf.size(), 3u);
+    EXPECT_EQ(cdf[1].upper, 2);
+    EXPECT_EQ(cdf[1].count, 3u);
+    EXPECT_DOUBLE_EQ(cdf[1].fraction, 0.75);
+    EXPECT_DOUBLE_EQ(cdf.back().fraction, 1.0);
+}
+
+TEST(HistogramAccumulatorTest, MergeMatchesSerialAccumulation) {
+    HistogramAccumulator serial;
+    HistogramAccumulator left;
+    HistogramAccumulator right;
+    for (int value = 0; value < 1000; value += 7) {
+        serial.Accumulate(MakeMetricResult(value));
+        (value % 2 == 0 ? left : right).Accumulate(MakeMetricResult(value));
+    }
+
+    left.Merge(right);
+    left.Finalize();
+    serial.Finalize();
+
+    EXPECT_EQ(left.Count(), serial.Count());
+    EXPECT_EQ(left.Get(), serial.Get());
+    EXPECT_EQ(left.GetCumulative(), serial.GetCumulative());
+}
+
+TEST(HistogramAccumulatorTest, BatchMatchesScalarAccumulation) {
+    std::vector<int> values;
+    for (int value = 0; value < 100000; value = value * 3 + 1)
+        values.push_back(value);
+    HistogramAccumulator scalar;
+    HistogramAccumulator batch;
+    for (int value : values)
+        scalar.Accumulate(MakeMetricResult(value));
+    batch.AccumulateBatch(values);
+    scalar.Finalize();
+    batch.Finalize();
+
+    EXPECT_EQ(batch.Count(), scalar.Count());
+    EXPECT_EQ(batch.Get(), scalar.Get());
+}
+
+TEST(HistogramAccumulatorTest, BatchWithNegativeValueChangesNothing) {
+    const std::vector<int> values = {1, 2, -3};
+    HistogramAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.AccumulateBatch(values), std::invalid_argument);
+    accumulator.Finalize();
+    EXPECT_EQ(accumulator.Count(), 0u);
+}
+
+TEST(HistogramAccumulatorTest, ResetClearsState) {
+    HistogramAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(3));
+    accumulator.Finalize();
+    accumulator.Reset();
+
+    accumulator.Finalize();
+
+    EXPECT_TRUE(accumulator.Get().empty());
+    EXPECT_EQ(accumulator.Count(), 0u);
+}
+
+TEST(HistogramAccumulatorTest, RejectsInvalidArguments) {
+    EXPECT_THROW(HistogramAccumulator(HistogramAccumulator::kMaxSubBucketBits + 1), std::invalid_argument);
+
+    HistogramAccumulator accumulator;
+    HistogramAccumulator other(5);
+    EXPECT_THROW(accumulator.Accumulate(MakeMetricResult(-1)), std::invalid_argument);
+    EXPECT_THROW(accumulator.Accumulate({.metric_name = "metric", .value = std::string("NaN")}),
+                 std::invalid_argument);
+    EXPECT_THROW(accumulator.Merge(other), std::invalid_argument);
+}
+
+TEST(HistogramAccumulatorTest, GetBeforeFinalizeThrows) {
+    HistogramAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.Get(), std::logic_error);
+    EXPECT_THROW(accumulator.GetCumulative(), std::logic_error);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
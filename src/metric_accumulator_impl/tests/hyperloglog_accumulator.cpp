@@ -0,0 +1,119 @@
+#include "metric_accumulator_impl/hyperloglog_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
+
+namespace {
+
+metric::MetricResult MakeCategoryResult(std::string_view category) {
+    return metric::MetricResult{.metric_name = "metric", .value = std::string(category)};
+}
+
+void AccumulateRange(HyperLogLogAccumulator &accumulator, int begin, int end) {
+    for (int i = begin; i < end; ++i)
+        accumulator.Accumulate(MakeCategoryResult("identifier_" + std::to_string(i)));
+}
+
+}  // namespace
+
+TEST(HyperLogLogAccumulatorTest, EstimatesLargeCardinality) {
+    constexpr int kDistinct = 100000;
+    HyperLogLogAccumulator accumulator(14);
+    AccumulateRange(accumulator, 0, kDistinct);
+    AccumulateRange(accumulator, 0, kDistinct / 2);
+    accumulator.Finalize();
+
+    EXPECT_FALSE(accumulator.IsExact());
+    EXPECT_NEAR(static_cast<double>(accumulator.Get()), kDistinct, 0.03 * kDistinct);
+}
+
+TEST(HyperLogLogAccumulatorTest, SmallCardinalityIsCloseWithoutExactMode) {
+    HyperLogLogAccumulator accumulator;
+    AccumulateRange(accumulator, 0, 100);
+    accumulator.Finalize();
+
+    EXPECT_NEAR(static_cast<double>(accumulator.Get()), 100.0, 5.0);
+}
+
+TEST(HyperLogLogAccumulatorTest, HybridModeIsExactBelowThreshold) {
+    HyperLogLogAccumulator accumulator(12, 1000);
+    AccumulateRange(accumulator, 0, 700);
+    AccumulateRange(accumulator, 100, 200);
+    accumulator.Finalize();
+
+    EXPECT_TRUE(accumulator.IsExact());
+    EXPECT_EQ(accumulator.Get(), 700u);
+}
+
+TEST(HyperLogLogAccumulatorTest, HybridModeSwitchesPastThreshold) {
+    HyperLogLogAccumulator accumulator(12, 100);
+    AccumulateRange(accumulator, 0, 5000);
+    accumulator.Finalize();
+
+    EXPECT_FALSE(accumulator.IsExact());
+    EXPECT_NEAR(static_cast<double>(accumulator.Get()), 5000.0, 250.0);
+}
+
+TEST(HyperLogLogAccumulatorTest, MergeMatchesSerialAccumulation) {
+    HyperLogLogAccumulator serial(10, 50);
+    HyperLogLogAccumulator exact_part(10, 50);
+    HyperLogLogAccumulator sketch_part(10, 50);
+    AccumulateRange(serial, 0, 3000);
+    AccumulateRange(exact_part, 0, 40);
+    AccumulateRange(sketch_part, 40, 3000);
+
+    exact_part.Merge(sketch_part);
+    exact_part.Finalize();
+    serial.Finalize();
+
+    EXPECT_EQ(exact_part.Get(), serial.Get());
+}
+
+TEST(HyperLogLogAccumulatorTest, MergeOfExactPartsStaysExact) {
+    HyperLogLogAccumulator left(10, 100);
+    HyperLogLogAccumulator right(10, 100);
+    AccumulateRange(left, 0, 30);
+    AccumulateRange(right, 20, 60);
+
+    left.Merge(right);
+    left.Finalize();
+
+    EXPECT_TRUE(left.IsExact());
+    EXPECT_EQ(left.Get(), 60u);
+}
+
+TEST(HyperLogLogAccumulatorTest, ResetClearsState) {
+    HyperLogLogAccumulator accumulator(12, 10);
+    AccumulateRange(accumulator, 0, 100);
+    accumulator.Finalize();
+    accumulator.Reset();
+
+    AccumulateRange(accumulator, 0, 3);
+    accumulator.Finalize();
+
+    EXPECT_TRUE(accumulator.IsExact());
+    EXPECT_EQ(accumulator.Get(), 3u);
+}
+
+TEST(HyperLogLogAccumulatorTest, RejectsInvalidArguments) {
+    EXPECT_THROW(HyperLogLogAccumulator(HyperLogLogAccumulator::kMaxPrecision + 1), std::invalid_argument);
+
+    HyperLogLogAccumulator accumulator(10);
+    HyperLogLogAccumulator other(11);
+    EXPECT_THROW(accumulator.Accumulate({.metric_name = "metric", .value = 42}), std::invalid_argument);
+    EXPECT_THROW(accumulator.Merge(other), std::invalid_argument);
+}
+
+TEST(HyperLogLogAccumulatorTest, GetBeforeFinalizeThrows) {
+    HyperLogLogAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.Get(), std::logic_error);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
@@ -0,0 +1,145 @@
+#include "metric_accumulator_impl/moments_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
+
+namespace {
+
+metric::MetricResult MakeMetricResult(int value) {
+    return metric::MetricResult{.metric_name = "metric", .value = value};
+}
+
+}  // namespace
+
+TEST(MomentsAccumulatorTest, TracksAllMoments) {
+    MomentsAccumulator accumulator;
+    for (int value : {2, 4, 4, 4, 5, 5, 7, 9})
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    const auto result = accumulator.Get();
+    EXPECT_EQ(result.count, 8);
+    EXPECT_EQ(result.sum, 40);
+    EXPECT_EQ(result.min, 2);
+    EXPECT_EQ(result.max, 9);
+    EXPECT_DOUBLE_EQ(result.mean, 5.0);
+    EXPECT_DOUBLE_EQ(result.variance, 4.0);
+    EXPECT_DOUBLE_EQ(result.stddev, 2.0);
+}
+
+TEST(MomentsAccumulatorTest, SumDoesNotOverflowInt) {
+    MomentsAccumulator accumulator;
+    for (int i = 0; i < 3; ++i)
+        accumulator.Accumulate(MakeMetricResult(std::numeric_limits<int>::max()));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get().sum, 3 * static_cast<std::int64_t>(std::numeric_limits<int>::max()));
+}
+
+TEST(MomentsAccumulatorTest, BatchMatchesScalarAccumulation) {
+    const std::vector<std::int64_t> values = {13, 1, 8, 21, 3, 5, 2, 1, 34};
+    MomentsAccumulator scalar;
+    MomentsAccumulator batch;
+    for (auto value : values)
+        scalar.Accumulate(MakeMetricResult(static_cast<int>(value)));
+    batch.Accumulate(std::span(values).first(4));
+    batch.Accumulate(std::span(values).subspan(4));
+    scalar.Finalize();
+    batch.Finalize();
+
+    const auto expected = scalar.Get();
+    const auto actual = batch.Get();
+    EXPECT_EQ(actual.count, expected.count);
+    EXPECT_EQ(actual.sum, expected.sum);
+    EXPECT_EQ(actual.min, expected.min);
+    EXPECT_EQ(actual.max, expected.max);
+    EXPECT_NEAR(actual.mean, expected.mean, 1e-9);
+    EXPECT_NEAR(actual.variance, expected.variance, 1e-9);
+}
+
+TEST(MomentsAccumulatorTest, IntBatchMatchesScalarAccumulation) {
+    const std::vector<int> values = {7, -2, 40, 3, 3, 11};
+    MomentsAccumulator scalar;
+    MomentsAccumulator batch;
+    for (int value : values)
+        scalar.Accumulate(MakeMetricResult(value));
+    batch.AccumulateBatch(values);
+    scalar.Finalize();
+    batch.Finalize();
+
+    EXPECT_EQ(batch.Get().sum, scalar.Get().sum);
+    EXPECT_EQ(batch.Get().min, -2);
+    EXPECT_EQ(batch.Get().max, 40);
+    EXPECT_NEAR(batch.Get().variance, scalar.Get().variance, 1e-9);
+}
+
+TEST(MomentsAccumulatorTest, MergeMatchesSerialAccumulation) {
+    MomentsAccumulator serial;
+    MomentsAccumulator left;
+    MomentsAccumulator right;
+    MomentsAccumulator empty;
+    for (int value = -50; value < 150; value += 3) {
+        serial.Accumulate(MakeMetricResult(value));
+        (value < 40 ? left : right).Accumulate(MakeMetricResult(value));
+    }
+
+    left.Merge(right);
+    left.Merge(empty);
+    left.Finalize();
+    serial.Finalize();
+
+    const auto expected = serial.Get();
+    const auto actual = left.Get();
+    EXPECT_EQ(actual.count, expected.count);
+    EXPECT_EQ(actual.sum, expected.sum);
+    EXPECT_EQ(actual.min, expected.min);
+    EXPECT_EQ(actual.max, expected.max);
+    EXPECT_NEAR(actual.mean, expected.mean, 1e-9);
+    EXPECT_NEAR(actual.variance, expected.variance, 1e-9);
+}
+
+TEST(MomentsAccumulatorTest, FinalizeWithoutValuesReturnsZeroes) {
+    MomentsAccumulator accumulator;
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(), (MomentsAccumulator::Moments{0, 0, 0, 0, 0.0, 0.0, 0.0}));
+}
+
+TEST(MomentsAccumulatorTest, ResetClearsState) {
+    MomentsAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(100));
+    accumulator.Finalize();
+    accumulator.Reset();
+
+    accumulator.Accumulate(MakeMetricResult(3));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(), (MomentsAccumulator::Moments{1, 3, 3, 3, 3.0, 0.0, 0.0}));
+}
+
+TEST(MomentsAccumulatorTest, AccumulateAfterFinalizeThrows) {
+    MomentsAccumulator accumulator;
+    const std::vector<std::int64_t> values = {1};
+    accumulator.Finalize();
+
+    EXPECT_THROW(accumulator.Accumulate(MakeMetricResult(2)), std::logic_error);
+    EXPECT_THROW(accumulator.Accumulate(values), std::logic_error);
+}
+
+TEST(MomentsAccumulatorTest, RejectsNonIntegerValues) {
+    MomentsAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.Accumulate({.metric_name = "metric", .value = std::string("NaN")}),
+                 std::invalid_argument);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
@@ -0,0 +1,129 @@
+#include "metric_accumulator_impl/quantile_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
+
+namespace {
+
+metric::MetricResult MakeMetricResult(int value) {
+    return metric::MetricResult{.metric_name = "metric", .value = value};
+}
+
+std::vector<int> ShuffledRange(int size, unsigned seed) {
+    std::vector<int> values(size);
+    std::iota(values.begin(), values.end(), 1);
+    std::shuffle(values.begin(), values.end(), std::mt19937{seed});
+    return values;
+}
+
+}  // namespace
+
+TEST(QuantileAccumulatorTest, ExactForSmallInputs) {
+    QuantileAccumulator accumulator;
+    for (int value : ShuffledRange(100, 1))
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(0.0), 1);
+    EXPECT_EQ(accumulator.Get(0.5), 50);
+    EXPECT_EQ(accumulator.Get(0.9), 90);
+    EXPECT_EQ(accumulator.Get(0.99), 99);
+    EXPECT_EQ(accumulator.Get(1.0), 100);
+    EXPECT_EQ(accumulator.Count(), 100);
+}
+
+TEST(QuantileAccumulatorTest, ApproximatesLargeInputsWithBoundedMemory) {
+    constexpr int kSize = 100000;
+    QuantileAccumulator accumulator(200);
+    for (int value : ShuffledRange(kSize, 2))
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Finalize();
+
+    EXPECT_LT(accumulator.RetainedItems(), 1000u);
+    for (double q : {0.5, 0.9, 0.99})
+        EXPECT_NEAR(accumulator.Get(q), q * kSize, 0.02 * kSize) << "q=" << q;
+}
+
+TEST(QuantileAccumulatorTest, BatchMatchesScalarAccumulation) {
+    const auto values = ShuffledRange(20000, 4);
+    QuantileAccumulator scalar;
+    QuantileAccumulator batch;
+    for (int value : values)
+        scalar.Accumulate(MakeMetricResult(value));
+    batch.AccumulateBatch(values);
+    scalar.Finalize();
+    batch.Finalize();
+
+    EXPECT_EQ(batch.Count(), scalar.Count());
+    for (double q : {0.0, 0.5, 0.9, 0.99, 1.0})
+        EXPECT_EQ(batch.Get(q), scalar.Get(q)) << "q=" << q;
+}
+
+TEST(QuantileAccumulatorTest, MergeApproximatesSerialAccumulation) {
+    constexpr int kSize = 50000;
+    QuantileAccumulator left;
+    QuantileAccumulator right;
+    const auto values = ShuffledRange(kSize, 3);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        (i % 3 == 0 ? left : right).Accumulate(MakeMetricResult(values[i]));
+
+    left.Merge(right);
+    left.Finalize();
+
+    EXPECT_EQ(left.Count(), kSize);
+    EXPECT_EQ(left.Get(0.0), 1);
+    EXPECT_EQ(left.Get(1.0), kSize);
+    for (double q : {0.5, 0.9, 0.99})
+        EXPECT_NEAR(left.Get(q), q * kSize, 0.02 * kSize) << "q=" << q;
+}
+
+TEST(QuantileAccumulatorTest, FinalizeWithoutValuesYieldsZero) {
+    QuantileAccumulator accumulator;
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(0.5), 0);
+}
+
+TEST(QuantileAccumulatorTest, ResetClearsState) {
+    QuantileAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(100));
+    accumulator.Finalize();
+    accumulator.Reset();
+
+    accumulator.Accumulate(MakeMetricResult(3));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get(0.5), 3);
+    EXPECT_EQ(accumulator.Count(), 1);
+}
+
+TEST(QuantileAccumulatorTest, RejectsInvalidArguments) {
+    EXPECT_THROW(QuantileAccumulator(2), std::invalid_argument);
+
+    QuantileAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(1));
+    EXPECT_THROW(accumulator.Merge(accumulator), std::invalid_argument);
+    EXPECT_THROW(accumulator.Accumulate({.metric_name = "metric", .value = std::string("NaN")}),
+                 std::invalid_argument);
+    accumulator.Finalize();
+    EXPECT_THROW(accumulator.Get(1.5), std::invalid_argument);
+    EXPECT_THROW(accumulator.Merge(QuantileAccumulator{}), std::logic_error);
+}
+
+TEST(QuantileAccumulatorTest, GetBeforeFinalizeThrows) {
+    QuantileAccumulator accumulator;
+    accumulator.Accumulate(MakeMetricResult(1));
+
+    EXPECT_THROW(accumulator.Get(0.5), std::logic_error);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
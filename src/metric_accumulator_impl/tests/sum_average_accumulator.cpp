@@ -3,8 +3,13 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <limits>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+#include "metric_accumulator_impl/average_accumulator.hpp"
 
 namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
 
@@ -79,4 +84,70 @@ TEST(SumAverageAccumulatorTest, RejectsNonIntegerValues) {
     EXPECT_THROW(accumulator.Accumulate(wrong_result), std::invalid_argument);
 }
 
+TEST(SumAverageAccumulatorTest, BatchMatchesScalarAccumulation) {
+    const std::vector<int> values = {3, 8, 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+    SumAverageAccumulator scalar;
+    SumAverageAccumulator batch;
+    for (int value : values)
+        scalar.Accumulate(MakeMetricResult(value));
+    batch.AccumulateBatch(std::span(values).first(2));
+    batch.AccumulateBatch(std::span(values).subspan(2));
+    scalar.Finalize();
+    batch.Finalize();
+
+    EXPECT_EQ(batch.Get(), scalar.Get());
+}
+
+TEST(SumAverageAccumulatorTest, MergeMatchesSerialAccumulation) {
+    SumAverageAccumulator serial;
+    SumAverageAccumulator left;
+    SumAverageAccumulator right;
+    for (int value : {3, 8, 1}) {
+        left.Accumulate(MakeMetricResult(value));
+        serial.Accumulate(MakeMetricResult(value));
+    }
+    for (int value : {4, 9}) {
+        right.Accumulate(MakeMetricResult(value));
+        serial.Accumulate(MakeMetricResult(value));
+    }
+
+    left.Merge(right);
+    left.Finalize();
+    serial.Finalize();
+
+    EXPECT_EQ(left.Get(), serial.Get());
+}
+
+TEST(SumAverageAccumulatorTest, RetractUndoesAccumulate) {
+    SumAverageAccumulator accumulator;
+    for (int value : {3, 8, 1})
+        accumulator.Accumulate(MakeMetricResult(value));
+    accumulator.Retract(MakeMetricResult(8));
+    accumulator.Accumulate(MakeMetricResult(5));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get().sum, 9);
+    EXPECT_DOUBLE_EQ(accumulator.Get().average, 3.0);
+}
+
+TEST(SumAverageAccumulatorTest, RetractFromEmptyThrows) {
+    SumAverageAccumulator accumulator;
+    EXPECT_THROW(accumulator.Retract(MakeMetricResult(1)), std::logic_error);
+}
+
+TEST(SumAverageAccumulatorTest, MergeAfterFinalizeThrows) {
+    SumAverageAccumulator accumulator;
+    SumAverageAccumulator other;
+    accumulator.Finalize();
+
+    EXPECT_THROW(accumulator.Merge(other), std::logic_error);
+}
+
+TEST(SumAverageAccumulatorTest, MergeRejectsOtherAccumulatorTypes) {
+    SumAverageAccumulator accumulator;
+    AverageAccumulator other;
+
+    EXPECT_THROW(accumulator.Merge(other), std::invalid_argument);
+}
+
 }  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
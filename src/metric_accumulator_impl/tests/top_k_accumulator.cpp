@@ -0,0 +1,118 @@
+#include "metric_accumulator_impl/top_k_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "function.hpp"
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl::test {
+
+namespace {
+
+metric::MetricResult MakeMetricResult(int value) {
+    return metric::MetricResult{.metric_name = "metric", .value = value};
+}
+
+function::Function MakeFunction(std::string_view name, std::optional<std::string_view> class_name = std::nullopt) {
+    function::Function function{.filename = "sample.py", .name = std::pmr::string(name), .ast = ""};
+    if (class_name)
+        function.class_name.emplace(*class_name);
+    return function;
+}
+
+std::vector<int> Values(const std::vector<TopKAccumulator::Entry> &entries) {
+    std::vector<int> values;
+    for (const auto &entry : entries)
+        values.push_back(entry.value);
+    return values;
+}
+
+}  // namespace
+
+TEST(TopKAccumulatorTest, KeepsLargestValuesInDescendingOrder) {
+    TopKAccumulator accumulator(3);
+    int index = 0;
+    for (int value : {5, 1, 9, 7, 3, 8})
+        accumulator.AccumulateFunctionResult(MakeFunction("f" + std::to_string(index++)), MakeMetricResult(value));
+    accumulator.Finalize();
+
+    EXPECT_EQ(Values(accumulator.Get()), (std::vector<int>{9, 8, 7}));
+    EXPECT_EQ(accumulator.Get().front().function.qualified_name, "f2");
+    EXPECT_EQ(accumulator.Get().front().function.filename, "sample.py");
+}
+
+TEST(TopKAccumulatorTest, QualifiesMethodNamesWithClass) {
+    TopKAccumulator accumulator(1);
+    accumulator.AccumulateFunctionResult(MakeFunction("run", "Worker"), MakeMetricResult(4));
+    accumulator.Finalize();
+
+    EXPECT_EQ(accumulator.Get().front().function.qualified_name, "Worker.run");
+}
+
+TEST(TopKAccumulatorTest, MergeMatchesSerialAccumulationWithTies) {
+    TopKAccumulator serial(4);
+    TopKAccumulator left(4);
+    TopKAccumulator right(4);
+    const std::vector<int> values = {3, 7, 7, 2, 7, 5, 7, 1, 6};
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto function = MakeFunction("f" + std::to_string(i));
+        serial.AccumulateFunctionResult(function, MakeMetricResult(values[i]));
+        (i % 2 == 0 ? left : right).AccumulateFunctionResult(function, MakeMetricResult(values[i]));
+    }
+
+    right.Merge(left);
+    right.Finalize();
+    serial.Finalize();
+
+    EXPECT_EQ(right.Get(), serial.Get());
+}
+
+TEST(TopKAccumulatorTest, ResetClearsState) {
+    TopKAccumulator accumulator(2);
+    accumulator.AccumulateFunctionResult(MakeFunction("f"), MakeMetricResult(10));
+    accumulator.Finalize();
+    accumulator.Reset();
+
+    accumulator.AccumulateFunctionResult(MakeFunction("g"), MakeMetricResult(1));
+    accumulator.Finalize();
+
+    ASSERT_EQ(accumulator.Get().size(), 1u);
+    EXPECT_EQ(accumulator.Get().front().function.qualified_name, "g");
+}
+
+TEST(TopKAccumulatorTest, RequiresSourceFunction) {
+    TopKAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.Accumulate(MakeMetricResult(1)), std::logic_error);
+}
+
+TEST(TopKAccumulatorTest, BatchRequiresSourceFunction) {
+    TopKAccumulator accumulator;
+    const std::vector<int> values = {1, 2};
+
+    EXPECT_THROW(accumulator.AccumulateBatch(values), std::logic_error);
+}
+
+TEST(TopKAccumulatorTest, RejectsInvalidArguments) {
+    EXPECT_THROW(TopKAccumulator(0), std::invalid_argument);
+
+    TopKAccumulator accumulator;
+    EXPECT_THROW(accumulator.AccumulateFunctionResult(MakeFunction("f"),
+                                                      {.metric_name = "metric", .value = std::string("NaN")}),
+                 std::invalid_argument);
+    accumulator.AccumulateFunctionResult(MakeFunction("f"), MakeMetricResult(1));
+    EXPECT_THROW(accumulator.Merge(accumulator), std::invalid_argument);
+}
+
+TEST(TopKAccumulatorTest, GetBeforeFinalizeThrows) {
+    TopKAccumulator accumulator;
+
+    EXPECT_THROW(accumulator.Get(), std::logic_error);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl::test
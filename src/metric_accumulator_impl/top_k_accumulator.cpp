@@ -0,0 +1,131 @@
+#include "metric_accumulator_impl/top_k_accumulator.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace analyzer::metric_accumulator::metric_accumulator_impl {
+
+namespace {
+
+int ExtractIntValue(const metric::MetricResult &metric_result, std::string_view context) {
+    if (!std::holds_alternative<int>(metric_result.value))
+        throw std::invalid_argument(std::string(context) + " expects integer metric values");
+    return std::get<int>(metric_result.value);
+}
+
+// Порядок "лучше": большее значение, при равенстве — меньший FunctionRef
+bool Better(const TopKAccumulator::Entry &lhs, const TopKAccumulator::Entry &rhs) {
+    if (lhs.value != rhs.value)
+        return lhs.value > rhs.value;
+    return lhs.function < rhs.function;
+}
+
+}  // namespace
+
+TopKAccumulator::TopKAccumulator() : TopKAccumulator(kDefaultK) {}
+
+TopKAccumulator::TopKAccumulator(std::size_t k) : k{k} {
+    if (k == 0)
+        throw std::invalid_argument("TopKAccumulator requires k > 0");
+    heap.reserve(k);
+}
+
+void TopKAccumulator::Accumulate(const metric::MetricResult & /*metric_result*/) {
+    throw std::logic_error("TopKAccumulator requires the source function, use AccumulateFunctionResult");
+}
+
+void TopKAccumulator::AccumulateFunctionResult(const function::Function &function,
+                                               const metric::MetricResult &metric_result) {
+    if (is_finalized)
+        throw std::logic_error("TopKAccumulator cannot accumulate after finalization");
+
+    const int value = ExtractIntValue(metric_result, "TopKAccumulator");
+    if (!MayAdmit(value))
+        return;
+    Offer(Entry{.value = value, .function = FunctionRef{.filename = std::string(function.filename.View()),
+                                                        .qualified_name = function::QualifiedName(function)}});
+}
+
+void TopKAccumulator::AccumulateFunctionBatch(std::span<const function::Function *const> functions,
+                                              std::span<const int> values) {
+    if (is_finalized)
+        throw std::logic_error("TopKAccumulator cannot accumulate after finalization");
+    if (functions.size() != values.size())
+        throw std::invalid_argument("TopKAccumulator requires a source function for every value");
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+        if (MayAdmit(values[i]))
+            Offer(Entry{.value = values[i],
+                        .function = FunctionRef{.filename = std::string(functions[i]->filename.View()),
+                                                .qualified_name = function::QualifiedName(*functions[i])}});
+}
+
+void TopKAccumulator::Merge(const IAccumulator &other) {
+    if (is_finalized)
+        throw std::logic_error("TopKAccumulator cannot merge after finalization");
+
+    const auto *typed = dynamic_cast<const TopKAccumulator *>(&other);
+    if (!typed)
+        throw std::invalid_argument("TopKAccumulator can only merge with TopKAccumulator");
+    // Offer меняет кучу, по которой шёл бы цикл
+    if (typed == this)
+        throw std::invalid_argument("TopKAccumulator cannot merge with itself");
+    for (const auto &entry : typed->heap)
+        if (MayAdmit(entry.value))
+            Offer(entry);
+}
+
+void TopKAccumulator::Finalize() {
+    if (is_finalized)
+        return;
+
+    std::ranges::sort(heap, Better);
+    is_finalized = true;
+}
+
+void TopKAccumulator::Reset() {
+    heap.clear();
+    is_finalized = false;
+}
+
+const std::vector<TopKAccumulator::Entry> &TopKAccumulator::Get() const {
+    if (!is_finalized)
+        throw std::logic_error("TopKAccumulator::Get requires finalized state");
+    return heap;
+}
+
+// Дешёвая проверка до копирования строк FunctionRef; при равных значениях решает Offer
+bool TopKAccumulator::MayAdmit(int value) const { return heap.size() < k || value >= heap.front().value; }
+
+void TopKAccumulator::Offer(Entry entry) {
+    if (heap.size() < k) {
+        heap.push_back(std::move(entry));
+        std::ranges::push_heap(heap, Better);
+        return;
+    }
+    if (!Better(entry, heap.front()))
+        return;
+    std::ranges::pop_heap(heap, Better);
+    heap.back() = std::move(entry);
+    std::ranges::push_heap(heap, Better);
+}
+
+}  // namespace analyzer::metric_accumulator::metric_accumulator_impl
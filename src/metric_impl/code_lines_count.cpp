@@ -19,6 +19,7 @@
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -26,45 +27,49 @@ using namespace std;
 
 namespace analyzer::metric::metric_impl {
 
-std::string readFile(const std::string &filePath) {
+Expected<std::string> readFile(const std::string &filePath) {
     std::ifstream file(filePath, std::ios::in | std::ios::binary);
     if (!file.is_open())
-        throw std::runtime_error("Failed to open file: " + filePath);
+        return MakeError(ErrorCode::kIo, "Failed to open file: " + filePath);
 
     std::string data((std::istreambuf_iterator<char>(file)), {});
     if (file.bad())
-        throw std::runtime_error("I/O error while reading file: " + filePath);
+        return MakeError(ErrorCode::kIo, "I/O error while reading file: " + filePath);
 
     if (data.empty())
-        throw std::runtime_error("File is empty: " + filePath);
+        return MakeError(ErrorCode::kIo, "File is empty: " + filePath);
 
     return data;
 }
 
-std::pair<int, int> extractLinesRange(std::string_view str) {
-    auto next_num = [&](size_t pos) -> int {
+Expected<std::pair<int, int>> extractLinesRange(std::string_view str) {
+    auto next_num = [&](size_t pos) -> Expected<int> {
         pos = str.find_first_of("-0123456789", pos);
         if (pos == std::string_view::npos)
-            throw std::runtime_error("number expected");
+            return MakeError(ErrorCode::kParse, "number expected");
 
         int value{};
         auto [ptr, ec] = std::from_chars(str.data() + pos, str.data() + str.size(), value);
         if (ec != std::errc{})
-            throw std::runtime_error("invalid number");
+            return MakeError(ErrorCode::kParse, "invalid number");
         return value;
     };
 
     size_t p = str.find('[');
     if (p == std::string_view::npos)
-        throw std::runtime_error("first [ missing");
-    int a = next_num(++p);
+        return MakeError(ErrorCode::kParse, "first [ missing");
+    auto a = next_num(++p);
+    if (!a)
+        return std::unexpected(std::move(a.error()));
 
     p = str.find('[', p);
     if (p == std::string_view::npos)
-        throw std::runtime_error("second [ missing");
-    int b = next_num(++p);
+        return MakeError(ErrorCode::kParse, "second [ missing");
+    auto b = next_num(++p);
+    if (!b)
+        return std::unexpected(std::move(b.error()));
 
-    return {a, b};
+    return std::pair{*a, *b};
 }
 
 static bool checkIsLineComment(const std::vector<std::pair<int, int>> &commentLines, int lineNumber) {
@@ -76,7 +81,7 @@ static bool checkIsLineComment(const std::vector<std::pair<int, int>> &commentLi
     return (lineNumber >= it->first) && (lineNumber <= it->second);
 }
 
-MetricResult::ValueType CodeLinesCountMetric::CalculateImpl(const function::Function &f) const {
+Expected<int> CodeLinesCountMetric::CalculateValue(const function::Function &f) const {
     constexpr auto delim{"\n"sv};
     constexpr auto commentStr{"comment"sv};
 
@@ -85,33 +90,58 @@ MetricResult::ValueType CodeLinesCountMetric::CalculateImpl(const function::Func
                                 return extractLinesRange(string_view(comentLine));
                             });
     if (functionSizeView.begin() == functionSizeView.end())
-        throw runtime_error("functionSizeView is empty");
-    auto functionSize = *functionSizeView.begin();
+        return MakeError(ErrorCode::kParse, "functionSizeView is empty");
+    auto functionSizeResult = *functionSizeView.begin();
+    if (!functionSizeResult)
+        return std::unexpected(std::move(functionSizeResult.error()));
+    const auto functionSize = *functionSizeResult;
 
     // create vector of [comment.begin, comment.end] numbers
-    auto commentLines =
+    auto commentLineResults =
         views::split(f.ast, delim) |
         views::filter([&commentStr](auto &&line) { return ranges::contains_subrange(line, commentStr); }) |
-        views::transform([](auto &&comentLine) { return extractLinesRange(string_view(comentLine)); }) |
-        ranges::to<vector>();
+        views::transform([](auto &&comentLine) { return extractLinesRange(string_view(comentLine)); });
+    vector<pair<int, int>> commentLines;
+    for (auto &&commentLine : commentLineResults) {
+        if (!commentLine)
+            return std::unexpected(std::move(commentLine.error()));
+        commentLines.push_back(*commentLine);
+    }
 
     // filter empty lines and comment lines
-    string buffer = readFile(f.filename);
-    auto numberOfLines =
-        ranges::distance(views::split(buffer, delim) | views::enumerate | views::filter([&functionSize](auto &&p) {
-                             auto [index, line] = p;
-                             return index >= functionSize.first && index <= functionSize.second;
-                         }) |
-                         views::filter([&commentLines](auto &&pair) {
-                             const auto &[index, line] = pair;
-                             bool isEmptyLine = ranges::all_of(line, [](unsigned char ch) { return isspace(ch); });
-                             bool isComment = checkIsLineComment(commentLines, index);
-                             return !isEmptyLine && !isComment;
-                         }));
+    auto countCodeLines = [&](auto &&lines) {
+        return ranges::distance(lines | views::enumerate | views::filter([&functionSize](auto &&p) {
+                                    auto [index, line] = p;
+                                    return index >= functionSize.first && index <= functionSize.second;
+                                }) |
+                                views::filter([&commentLines](auto &&pair) {
+                                    const auto &[index, line] = pair;
+                                    bool isEmptyLine =
+                                        ranges::all_of(line, [](unsigned char ch) { return isspace(ch); });
+                                    bool isComment = checkIsLineComment(commentLines, index);
+                                    return !isEmptyLine && !isComment;
+                                }));
+    };
+
+    // Строки уже прочитаны вместе с файлом; иначе, например для функции вне AnalyseFile, читаем файл
+    if (!f.source_lines.empty())
+        return static_cast<int>(countCodeLines(f.source_lines));
+
+    auto buffer = readFile(string(f.filename.View()));
+    if (!buffer)
+        return std::unexpected(std::move(buffer.error()));
+    auto numberOfLines = countCodeLines(views::split(*buffer, delim));
 
     return static_cast<int>(numberOfLines);
 }
 
+Expected<MetricResult::ValueType> CodeLinesCountMetric::CalculateImpl(const function::Function &f) const {
+    auto value = CalculateValue(f);
+    if (!value)
+        return std::unexpected(std::move(value.error()));
+    return *value;
+}
+
 std::string CodeLinesCountMetric::Name() const { return "code_lines_count"; }
 
 }  // namespace analyzer::metric::metric_impl
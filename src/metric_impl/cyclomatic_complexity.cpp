@@ -35,7 +35,7 @@ static const std::unordered_set<std::string_view> kCyclomaticNodes = {"if_statem
                                                                       "assert_statement",
                                                                       "conditional_expression"};
 
-MetricResult::ValueType CyclomaticComplexityMetric::CalculateImpl(const function::Function &f) const {
+Expected<int> CyclomaticComplexityMetric::CalculateValue(const function::Function &f) const {
     constexpr auto delim{"\n"sv};
     return static_cast<int>(ranges::distance(views::split(f.ast, delim) | views::filter([](auto &&line) {
                                                  return ranges::any_of(kCyclomaticNodes, [&line](auto &&node) {
@@ -44,6 +44,13 @@ MetricResult::ValueType CyclomaticComplexityMetric::CalculateImpl(const function
                                              })));
 }
 
+Expected<MetricResult::ValueType> CyclomaticComplexityMetric::CalculateImpl(const function::Function &f) const {
+    auto value = CalculateValue(f);
+    if (!value)
+        return std::unexpected(std::move(value.error()));
+    return *value;
+}
+
 std::string CyclomaticComplexityMetric::Name() const { return "cyclomatic_complexity"; }
 
 }  // namespace analyzer::metric::metric_impl
@@ -19,7 +19,7 @@
 
 namespace analyzer::metric::metric_impl {
 
-MetricResult::ValueType NamingStyleMetric::CalculateImpl(const function::Function &/*f*/) const {
+Expected<MetricResult::ValueType> NamingStyleMetric::CalculateImpl(const function::Function &/*f*/) const {
     // TODO: implement
     return 0;
 }
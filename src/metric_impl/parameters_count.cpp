@@ -26,9 +26,9 @@ static const std::unordered_set<std::string_view> parameterNodeTypes = {
     "tuple_pattern", "list_splat_pattern", "dictionary_splat_pattern",
 };
 
-int findFirstOpenParen(auto &&ast, std::size_t startSearchFrom) {
-    if (startSearchFrom >= ranges::distance(ast))
-        throw std::out_of_range("startSearchFrom is past the end");
+optional<int> findFirstOpenParen(auto &&ast, std::size_t startSearchFrom) {
+    if (startSearchFrom >= static_cast<std::size_t>(ranges::distance(ast)))
+        return nullopt;
 
     auto v = ast | std::views::drop(startSearchFrom) | std::views::enumerate;
 
@@ -39,7 +39,7 @@ int findFirstOpenParen(auto &&ast, std::size_t startSearchFrom) {
     });
 
     if (it == std::ranges::end(v))
-        throw std::runtime_error("No opening parenthesis found");
+        return nullopt;
 
     const auto &[relPos, ch] = *it;
     return static_cast<int>(relPos + startSearchFrom);
@@ -47,8 +47,10 @@ int findFirstOpenParen(auto &&ast, std::size_t startSearchFrom) {
 
 optional<int> findPositionOfClosingParenthesis(auto &&ast, std::size_t startSearchFrom = 0) {
     int buff = 0;
-    int positionOfFistOpeningParenthesis = findFirstOpenParen(ast, startSearchFrom);
-    auto bracketDeltas = ast | views::enumerate | views::drop(positionOfFistOpeningParenthesis) |
+    const auto positionOfFistOpeningParenthesis = findFirstOpenParen(ast, startSearchFrom);
+    if (!positionOfFistOpeningParenthesis)
+        return nullopt;
+    auto bracketDeltas = ast | views::enumerate | views::drop(*positionOfFistOpeningParenthesis) |
                          std::views::transform([](auto &&pos_ch) {
                              const auto &[pos, ch] = pos_ch;
                              return std::pair{pos, (ch == '(') - (ch == ')')};
@@ -64,7 +66,7 @@ optional<int> findPositionOfClosingParenthesis(auto &&ast, std::size_t startSear
     return position;
 }
 
-MetricResult::ValueType CountParametersMetric::CalculateImpl(const function::Function &f) const {
+Expected<int> CountParametersMetric::CalculateValue(const function::Function &f) const {
     constexpr auto delim{"\n"sv};
     constexpr auto parametersStr{"parameters"sv};
 
@@ -75,7 +77,7 @@ MetricResult::ValueType CountParametersMetric::CalculateImpl(const function::Fun
         });
 
     if (parametersLine.begin() == parametersLine.end())
-        throw runtime_error("parametersLines is empty");
+        return MakeError(ErrorCode::kParse, "parametersLines is empty");
     const auto FunctionParametersLine = parametersLine.front();
     const auto &[startOfParmsLine, line] = FunctionParametersLine;
     const auto symbolsBeforLineWithParams = ranges::fold_left(
@@ -87,7 +89,7 @@ MetricResult::ValueType CountParametersMetric::CalculateImpl(const function::Fun
     const auto endOfParmsPosition = findPositionOfClosingParenthesis(f.ast, symbolsBeforLineWithParams);
 
     if (!endOfParmsPosition)
-        throw std::runtime_error("No closing parenthesis found");
+        return MakeError(ErrorCode::kParse, "No closing parenthesis found");
 
     auto paramsLines = f.ast | views::take(*endOfParmsPosition) | views::drop(symbolsBeforLineWithParams) |
                        views::split(delim) | views::drop(1);
@@ -115,6 +117,13 @@ MetricResult::ValueType CountParametersMetric::CalculateImpl(const function::Fun
                                                })));
 }
 
+Expected<MetricResult::ValueType> CountParametersMetric::CalculateImpl(const function::Function &f) const {
+    auto value = CalculateValue(f);
+    if (!value)
+        return std::unexpected(std::move(value.error()));
+    return *value;
+}
+
 std::string CountParametersMetric::Name() const { return "parameters_count"; }
 
 }  // namespace analyzer::metric::metric_impl
@@ -62,6 +62,18 @@ TEST(CodeLinesCountMetric, CountsDocstringsButSkipsComments) {
     EXPECT_EQ(std::get<int>(result.value), 6);
 }
 
+TEST(CodeLinesCountMetric, ReportsMissingSourceAsError) {
+    const function::Function function{.filename = (SamplesDir() / "missing.py").string(),
+                                      .name = "missing",
+                                      .ast = "(function_definition [0, 0] - [1, 0]"};
+    CodeLinesCountMetric metric;
+
+    const auto result = metric.TryCalculate(function);
+
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, ErrorCode::kIo);
+}
+
 TEST(CodeLinesCountMetric, IgnoresBlankLinesInSparseFunction) {
     const auto function = GetFunctionFromFile("example_function", SamplePath("code_lines_count_sparse.py"));
     CodeLinesCountMetric metric;
@@ -53,6 +53,17 @@ TEST(CountParametersMetric, CountsDifferentKinds) {
     EXPECT_EQ(std::get<int>(result.value), 8);
 }
 
+TEST(CountParametersMetric, ReportsMalformedAstAsError) {
+    const function::Function function{.filename = "broken.py", .name = "broken", .ast = "(function_definition"};
+    CountParametersMetric metric;
+
+    const auto result = metric.TryCalculate(function);
+
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, ErrorCode::kParse);
+    EXPECT_THROW(metric.Calculate(function), std::runtime_error);
+}
+
 TEST_P(ParametersCountMetricSamples, CountsParametersAcrossSamples) {
     const auto params = GetParam();
     const auto function = GetFunctionFromFile(params.function_name, SamplePath(params.filename));
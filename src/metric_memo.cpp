@@ -0,0 +1,80 @@
+#include "metric_memo.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace analyzer::metric {
+
+std::uint64_t NormalizedAstHash(std::string_view ast, std::uint64_t seed) {
+    std::uint64_t hash = seed;
+    const auto mix = [&](unsigned char ch) { hash = (hash ^ ch) * 1099511628211ull; };
+
+    std::optional<std::size_t> base_indent;
+    for (std::size_t i = 0; i < ast.size();) {
+        if (ast[i] == '\n') {
+            mix('\n');
+            std::size_t indent = 0;
+            for (++i; i < ast.size() && ast[i] == ' '; ++i)
+                ++indent;
+            // Первая строка — сам узел без отступа, вторая — первый дочерний узел, самый мелкий из потомков
+            if (!base_indent)
+                base_indent = indent;
+            for (std::size_t extra = indent - std::min(indent, *base_indent); extra > 0; --extra)
+                mix(' ');
+            continue;
+        }
+        if (ast[i] == '[') {
+            const auto close = ast.find(']', i);
+            if (close == std::string_view::npos)
+                break;
+            i = close + 1;
+            if (ast.substr(i).starts_with(" - ["))
+                i += 3;  // Вторая пара координат пропустится на следующем шаге
+            continue;
+        }
+        mix(static_cast<unsigned char>(ast[i++]));
+    }
+    return hash;
+}
+
+MetricMemo::MetricMemo(std::size_t capacity) {
+    for (auto &shard : shards_)
+        shard.entries = cache::LruMap<std::uint64_t, std::shared_ptr<const Entry>>(
+            capacity == 0 ? 0 : std::max<std::size_t>(capacity / kShards, 1));
+}
+
+std::shared_ptr<const MetricMemo::Entry> MetricMemo::Find(std::uint64_t key) {
+    auto &shard = ShardOf(key);
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard lock(shard.mutex);
+        if (const auto *found = shard.entries.Find(key))
+            entry = *found;
+    }
+    (entry ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+void MetricMemo::Store(std::uint64_t key, Entry results) {
+    auto entry = std::make_shared<const Entry>(std::move(results));
+    auto &shard = ShardOf(key);
+    std::lock_guard lock(shard.mutex);
+    shard.entries.InsertOrAssign(key, std::move(entry));
+}
+
+std::size_t MetricMemo::Size() const {
+    std::size_t size = 0;
+    for (const auto &shard : shards_) {
+        std::lock_guard lock(shard.mutex);
+        size += shard.entries.Size();
+    }
+    return size;
+}
+
+}  // namespace analyzer::metric
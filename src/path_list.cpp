@@ -0,0 +1,97 @@
+#include "path_list.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace analyzer::input {
+
+namespace {
+
+constexpr std::size_t kChunkSize = 64 * 1024;
+
+class PathSplitter {
+public:
+    explicit PathSplitter(PathQueue &paths) : paths_(paths) {}
+
+    void Feed(std::string_view chunk) {
+        if (!separator_) {
+            const auto pos = chunk.find_first_of(std::string_view("\0\n", 2));
+            if (pos != std::string_view::npos)
+                separator_ = chunk[pos];
+        }
+        if (!separator_) {
+            pending_.append(chunk);
+            return;
+        }
+
+        for (auto pos = chunk.find(*separator_); pos != std::string_view::npos; pos = chunk.find(*separator_)) {
+            pending_.append(chunk.substr(0, pos));
+            Emit();
+            chunk.remove_prefix(pos + 1);
+        }
+        pending_.append(chunk);
+    }
+
+    // Последний путь может быть без завершающего разделителя
+    void Finish() { Emit(); }
+
+    std::size_t Count() const { return count_; }
+
+private:
+    void Emit() {
+        if (separator_ != '\0' && !pending_.empty() && pending_.back() == '\r')
+            pending_.pop_back();
+        if (!pending_.empty()) {
+            paths_.Push(std::move(pending_));
+            ++count_;
+        }
+        pending_.clear();
+    }
+
+    PathQueue &paths_;
+    std::string pending_;
+    std::optional<char> separator_;  // Не определён, пока не встретился первый разделитель
+    std::size_t count_ = 0;
+};
+
+}  // namespace
+
+Expected<std::size_t> ReadPathList(int fd, PathQueue &paths) {
+    PathSplitter splitter(paths);
+    std::array<char, kChunkSize> buffer;
+    while (true) {
+        const auto count = ::read(fd, buffer.data(), buffer.size());
+        if (count == 0)
+            break;
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            return MakeError(ErrorCode::kIo, std::string("Failed to read path list: ") + std::strerror(errno));
+        }
+        splitter.Feed(std::string_view(buffer.data(), static_cast<std::size_t>(count)));
+    }
+    splitter.Finish();
+    return splitter.Count();
+}
+
+Expected<std::size_t> ReadPathList(const std::string &source, PathQueue &paths) {
+    if (source == "-")
+        return ReadPathList(STDIN_FILENO, paths);
+
+    const int fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return MakeError(ErrorCode::kIo, "Failed to open path list " + source + ": " + std::strerror(errno));
+    auto result = ReadPathList(fd, paths);
+    ::close(fd);
+    return result;
+}
+
+}  // namespace analyzer::input
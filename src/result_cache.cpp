@@ -0,0 +1,286 @@
+#include "result_cache.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace analyzer::cache {
+
+namespace {
+
+constexpr std::string_view kFormatHeader = "analyzer-cache 1\n";
+
+// Разбор формата Serialize: числа разделены пробелами, строки идут сырыми байтами после строки с длинами
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    bool Literal(std::string_view expected) {
+        if (!data_.starts_with(expected))
+            return false;
+        data_.remove_prefix(expected.size());
+        return true;
+    }
+
+    template <typename Number>
+    std::optional<Number> Read() {
+        Number value{};
+        const auto [end, error] = std::from_chars(data_.data(), data_.data() + data_.size(), value);
+        if (error != std::errc{} || end == data_.data() + data_.size() || (*end != ' ' && *end != '\n'))
+            return std::nullopt;
+        data_.remove_prefix(static_cast<std::size_t>(end - data_.data()) + 1);
+        return value;
+    }
+
+    std::optional<std::string> Bytes(std::size_t size) {
+        if (data_.size() < size)
+            return std::nullopt;
+        std::string bytes(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return bytes;
+    }
+
+    bool AtEnd() const { return data_.empty(); }
+
+private:
+    std::string_view data_;
+};
+
+std::optional<metric::MetricResult> ReadMetric(Reader &reader) {
+    if (!reader.Literal("m "))
+        return std::nullopt;
+    const auto name_size = reader.Read<std::size_t>();
+    if (!name_size)
+        return std::nullopt;
+
+    std::optional<metric::MetricResult::ValueType> value;
+    std::size_t string_size = 0;
+    if (reader.Literal("i ")) {
+        if (auto number = reader.Read<int>())
+            value = *number;
+    } else if (reader.Literal("s ")) {
+        if (auto size = reader.Read<std::size_t>()) {
+            string_size = *size;
+            value = std::string();
+        }
+    }
+    auto name = value ? reader.Bytes(*name_size) : std::nullopt;
+    if (!name)
+        return std::nullopt;
+    if (std::holds_alternative<std::string>(*value)) {
+        auto text = reader.Bytes(string_size);
+        if (!text)
+            return std::nullopt;
+        value = std::move(*text);
+    }
+    if (!reader.Literal("\n"))
+        return std::nullopt;
+
+    metric::MetricResult result{.metric_name = *name, .value = std::move(*value)};
+    result.metric_id = metric::FindMetricId(*name).value_or(metric::kUnknownMetricId);
+    return result;
+}
+
+std::optional<CachedFunction> ReadFunction(Reader &reader) {
+    if (!reader.Literal("f "))
+        return std::nullopt;
+    const auto has_class = reader.Read<int>();
+    const auto class_size = has_class ? reader.Read<std::size_t>() : std::nullopt;
+    const auto name_size = class_size ? reader.Read<std::size_t>() : std::nullopt;
+    const auto metric_count = name_size ? reader.Read<std::size_t>() : std::nullopt;
+    if (!metric_count)
+        return std::nullopt;
+
+    CachedFunction function;
+    auto class_name = reader.Bytes(*class_size);
+    auto name = class_name ? reader.Bytes(*name_size) : std::nullopt;
+    if (!name || !reader.Literal("\n"))
+        return std::nullopt;
+    if (*has_class)
+        function.class_name = std::move(*class_name);
+    function.name = std::move(*name);
+
+    for (std::size_t i = 0; i < *metric_count; ++i) {
+        auto metric = ReadMetric(reader);
+        if (!metric)
+            return std::nullopt;
+        function.metrics.push_back(std::move(*metric));
+    }
+    return function;
+}
+
+}  // namespace
+
+std::string Serialize(const CachedFile &file) {
+    std::ostringstream out;
+    out << kFormatHeader << file.functions.size() << '\n';
+    for (const auto &function : file.functions) {
+        const std::string_view class_name = function.class_name ? *function.class_name : std::string_view();
+        out << "f " << (function.class_name ? 1 : 0) << ' ' << class_name.size() << ' ' << function.name.size() << ' '
+            << function.metrics.size() << '\n'
+            << class_name << function.name << '\n';
+        for (const auto &metric : function.metrics) {
+            const auto name = metric.metric_name.View();
+            out << "m " << name.size() << ' ';
+            std::visit(
+                [&](const auto &value) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+                        out << "s " << value.size() << '\n' << name << value << '\n';
+                    else
+                        out << "i " << value << '\n' << name << '\n';
+                },
+                metric.value);
+        }
+    }
+    return std::move(out).str();
+}
+
+std::optional<CachedFile> Deserialize(std::string_view data) {
+    Reader reader(data);
+    if (!reader.Literal(kFormatHeader))
+        return std::nullopt;
+    const auto count = reader.Read<std::size_t>();
+    if (!count)
+        return std::nullopt;
+
+    CachedFile file;
+    for (std::size_t i = 0; i < *count; ++i) {
+        auto function = ReadFunction(reader);
+        if (!function)
+            return std::nullopt;
+        file.functions.push_back(std::move(*function));
+    }
+    if (!reader.AtEnd())
+        return std::nullopt;
+    return file;
+}
+
+bool SaveMemo(const metric::MetricMemo &memo, const std::filesystem::path &path) {
+    CachedFile file;
+    memo.ForEach([&](std::uint64_t key, const metric::MetricMemo::Entry &entry) {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key;
+        file.functions.push_back(CachedFunction{.class_name = std::nullopt, .name = name.str(), .metrics = entry});
+    });
+
+    std::error_code error;
+    auto temporary = path;
+    temporary += ".tmp" + std::to_string(getpid());
+    if (!(std::ofstream(temporary, std::ios::binary) << Serialize(file))) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+bool LoadMemo(const std::filesystem::path &path, metric::MetricMemo &memo) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return false;
+    auto file = Deserialize(std::string(std::istreambuf_iterator<char>(stream), {}));
+    if (!file)
+        return false;
+
+    std::vector<std::pair<std::uint64_t, metric::MetricMemo::Entry>> entries;
+    for (auto &function : file->functions) {
+        std::uint64_t key = 0;
+        const auto *end = function.name.data() + function.name.size();
+        if (function.name.size() != 16 || std::from_chars(function.name.data(), end, key, 16).ptr != end)
+            return false;
+        entries.emplace_back(key, std::move(function.metrics));
+    }
+    for (auto &[key, entry] : entries)
+        memo.Store(key, std::move(entry));
+    return true;
+}
+
+ResultCache::ResultCache(std::filesystem::path directory, std::size_t capacity)
+    : directory_(std::move(directory)), entries_(capacity) {}
+
+std::shared_ptr<const CachedFile> ResultCache::Find(const std::string &key) {
+    {
+        std::lock_guard lock(mutex_);
+        if (const auto *entry = entries_.Find(key)) {
+            ++hits_;
+            return *entry;
+        }
+    }
+
+    std::shared_ptr<const CachedFile> loaded;
+    if (!directory_.empty()) {
+        std::ifstream stream(PathOf(key), std::ios::binary);
+        const std::string data = stream.is_open() ? std::string(std::istreambuf_iterator<char>(stream), {}) : "";
+        if (auto file = Deserialize(data))
+            loaded = std::make_shared<const CachedFile>(std::move(*file));
+    }
+
+    std::lock_guard lock(mutex_);
+    if (!loaded) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    // Другой поток мог успеть загрузить ту же запись: берётся уже сохранённая
+    if (const auto *entry = entries_.Find(key))
+        return *entry;
+    return entries_.InsertOrAssign(key, std::move(loaded));
+}
+
+void ResultCache::Store(const std::string &key, std::shared_ptr<const CachedFile> file) {
+    if (!directory_.empty()) {
+        // Запись во временный файл и rename: параллельные запуски не увидят недописанную запись
+        const auto path = PathOf(key);
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        static std::atomic<unsigned> sequence{0};
+        auto temporary = path;
+        temporary += ".tmp" + std::to_string(getpid()) + "-" + std::to_string(sequence.fetch_add(1));
+        if (std::ofstream(temporary, std::ios::binary) << Serialize(*file))
+            std::filesystem::rename(temporary, path, error);
+        else
+            std::filesystem::remove(temporary, error);
+    }
+
+    std::lock_guard lock(mutex_);
+    entries_.InsertOrAssign(key, std::move(file));
+}
+
+std::size_t ResultCache::Hits() const {
+    std::lock_guard lock(mutex_);
+    return hits_;
+}
+
+std::size_t ResultCache::Misses() const {
+    std::lock_guard lock(mutex_);
+    return misses_;
+}
+
+std::size_t ResultCache::Size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.Size();
+}
+
+std::filesystem::path ResultCache::PathOf(const std::string &key) const {
+    return directory_ / key.substr(0, 2) / key;
+}
+
+}  // namespace analyzer::cache
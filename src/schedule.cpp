@@ -0,0 +1,41 @@
+#include "schedule.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace analyzer::schedule {
+
+std::vector<std::size_t> LongestFirstOrder(std::span<const std::uint64_t> costs) {
+    std::vector<std::size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::ranges::stable_sort(order, std::ranges::greater{}, [costs](std::size_t index) { return costs[index]; });
+    return order;
+}
+
+std::uint64_t EstimateFileCost(const std::string &filename) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(filename, error);
+    return error ? 0 : static_cast<std::uint64_t>(size);
+}
+
+std::chrono::nanoseconds ScheduleProfile::Ideal() const {
+    if (workers == 0)
+        return total_work;
+    return std::max(total_work / static_cast<std::chrono::nanoseconds::rep>(workers), longest_task);
+}
+
+double ScheduleProfile::Efficiency() const {
+    if (makespan.count() == 0)
+        return 1.0;
+    return static_cast<double>(Ideal().count()) / static_cast<double>(makespan.count());
+}
+
+}  // namespace analyzer::schedule
@@ -0,0 +1,480 @@
+#include "source_reader.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <thread>
+#include <vector>
+
+#include "schedule.hpp"
+
+namespace analyzer::io {
+
+namespace {
+
+constexpr unsigned kRingEntries = 64;
+constexpr std::size_t kFilesPerRound = kRingEntries / 2;  // На файл уходит два запроса: openat и statx
+constexpr std::size_t kPrefetchBatch = 32;
+// Один read/pread читает не больше: ядро само режет чтение до 0x7ffff000 байт, а len в SQE 32-битный
+constexpr std::size_t kMaxReadChunk = std::size_t{1} << 30;
+
+Error IoError(std::string_view what, const std::string &path, int error) {
+    return Error{ErrorCode::kIo, std::string(what) + " " + path + ": " + std::strerror(error)};
+}
+
+// Дочитывает файл с offset до конца; data уже содержит первые offset байт. Короткое чтение обычного
+// файла означает его конец, поэтому буфер на байт больше размера файла читается одним pread.
+// Больше kMaxReadChunk за раз не запрашивается, так что короткое чтение — всегда конец файла
+Source ReadRest(int fd, const std::string &path, std::string data, std::size_t offset) {
+    for (;;) {
+        if (data.size() == offset)
+            data.resize(std::max<std::size_t>(data.size() * 2, 4096));
+        const auto requested = std::min(data.size() - offset, kMaxReadChunk);
+        const auto count = ::pread(fd, data.data() + offset, requested, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return std::unexpected(IoError("Failed to read file", path, errno));
+        offset += static_cast<std::size_t>(count);
+        if (static_cast<std::size_t>(count) < requested)
+            break;
+    }
+    data.resize(offset);
+    return data;
+}
+
+// Минимальная обёртка над io_uring без liburing: кольца отображаются в память, запросы готовятся
+// через Prepare и отправляются io_uring_enter, который сразу ждёт все завершения
+class Ring {
+public:
+    explicit Ring(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0)
+            throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+        try {
+            sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+            cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+            sqes_ = static_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+        } catch (...) {
+            Release();
+            throw;
+        }
+
+        auto *sq = static_cast<char *>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        auto *cq = static_cast<char *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        capacity_ = params.sq_entries;
+    }
+
+    ~Ring() { Release(); }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    // Поддерживает ли ядро все opcodes. Ядра до 5.6 не знают IORING_REGISTER_PROBE, но у них нет и OPENAT
+    bool Supports(std::span<const std::uint8_t> opcodes) const {
+        constexpr unsigned kProbeOps = 256;
+        std::vector<std::byte> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+        auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+        if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+            return false;
+        return std::ranges::all_of(opcodes, [&](std::uint8_t opcode) {
+            return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+        });
+    }
+
+    // После ошибки, при которой не удалось дождаться отправленных запросов, кольцом пользоваться нельзя
+    bool Broken() const { return broken_; }
+
+    // Следующий свободный запрос; за один раунд можно подготовить не больше entries запросов
+    io_uring_sqe &Prepare(std::uint8_t opcode, int fd, std::uint64_t user_data) {
+        if (prepared_ == capacity_)
+            throw std::logic_error("io_uring submission queue is full");
+        const unsigned tail = *sq_tail_ + prepared_++;
+        auto &sqe = sqes_[tail & sq_mask_];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.user_data = user_data;
+        sq_array_[tail & sq_mask_] = tail & sq_mask_;
+        return sqe;
+    }
+
+    // Отправляет подготовленные запросы и вызывает on_complete(user_data, res) для каждого завершения.
+    // EINTR, EAGAIN и EBUSY повторяются. При другой ошибке ещё не принятые ядром запросы снимаются с очереди,
+    // а принятые дожидаются: до возврата ядро не пишет в буферы вызывающего. Если дождаться не удалось,
+    // кольцо помечается сломанным, и буферы отправленных запросов нельзя освобождать
+    template <typename OnComplete>
+    Expected<void> SubmitAndWait(OnComplete &&on_complete) {
+        unsigned submitted = prepared_;
+        if (submitted == 0)
+            return {};
+        unsigned tail = *sq_tail_ + submitted;
+        std::atomic_ref(*sq_tail_).store(tail, std::memory_order_release);
+        prepared_ = 0;
+
+        std::optional<Error> failure;
+        unsigned completed = 0;
+        while (completed < submitted) {
+            const unsigned unconsumed = tail - std::atomic_ref(*sq_head_).load(std::memory_order_acquire);
+            const unsigned in_flight = submitted - unconsumed - completed;
+            const auto result =
+                ::syscall(__NR_io_uring_enter, fd_, unconsumed, in_flight, IORING_ENTER_GETEVENTS, nullptr, 0);
+            const int error = result < 0 ? errno : 0;
+            const unsigned reaped = Reap(on_complete);
+            completed += reaped;
+            if (error == 0 || error == EINTR)
+                continue;
+            if (error == EAGAIN || error == EBUSY) {
+                if (reaped == 0)
+                    std::this_thread::yield();
+                continue;
+            }
+            if (failure) {
+                broken_ = true;
+                return std::unexpected(std::move(*failure));
+            }
+            // Непринятые запросы не отправятся никогда: хвост возвращается к голове ядра
+            failure = Error{ErrorCode::kIo, std::string("io_uring_enter failed: ") + std::strerror(error)};
+            const unsigned head = std::atomic_ref(*sq_head_).load(std::memory_order_acquire);
+            std::atomic_ref(*sq_tail_).store(head, std::memory_order_release);
+            submitted -= tail - head;
+            tail = head;
+        }
+        if (failure)
+            return std::unexpected(std::move(*failure));
+        return {};
+    }
+
+private:
+    template <typename OnComplete>
+    unsigned Reap(OnComplete &on_complete) {
+        unsigned head = *cq_head_;
+        const unsigned tail = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire);
+        const unsigned reaped = tail - head;
+        for (; head != tail; ++head) {
+            const auto &cqe = cqes_[head & cq_mask_];
+            on_complete(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref(*cq_head_).store(head, std::memory_order_release);
+        return reaped;
+    }
+
+    void Release() {
+        if (sqes_)
+            ::munmap(sqes_, sqes_size_);
+        if (cq_ring_ && cq_ring_ != sq_ring_)
+            ::munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_)
+            ::munmap(sq_ring_, sq_ring_size_);
+        ::close(fd_);
+    }
+
+    void *Map(std::size_t size, off_t offset) {
+        void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (memory == MAP_FAILED)
+            throw std::runtime_error(std::string("io_uring mmap failed: ") + std::strerror(errno));
+        return memory;
+    }
+
+    int fd_ = -1;
+    std::size_t sq_ring_size_ = 0;
+    std::size_t cq_ring_size_ = 0;
+    std::size_t sqes_size_ = 0;
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    io_uring_sqe *sqes_ = nullptr;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned capacity_ = 0;
+    unsigned prepared_ = 0;
+    bool broken_ = false;
+};
+
+// Файлы читаются раундами по kFilesPerRound: openat и statx, затем read на размер + 1 байт (короткое
+// чтение подтверждает конец файла без лишнего вызова), затем close. Файл, выросший после statx или
+// больший kMaxReadChunk, дочитывается через pread. Если io_uring_enter вернул ошибку, раунд дочитывается
+// через ReadWholeFile, а после поломки кольца через него читаются и все следующие файлы
+class IoUringReader : public IBatchReader {
+public:
+    IoUringReader() : ring_(kRingEntries) {
+        static constexpr std::uint8_t kOpcodes[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                                                    IORING_OP_CLOSE};
+        if (!ring_.Supports(kOpcodes))
+            throw std::runtime_error("io_uring doesn't support openat, statx, read or close");
+    }
+
+    std::vector<Source> ReadBatch(std::span<const std::string> paths) override {
+        std::vector<Source> sources(paths.size());
+        for (std::size_t begin = 0; begin < paths.size(); begin += kFilesPerRound) {
+            const auto end = std::min(begin + kFilesPerRound, paths.size());
+            const auto round_paths = paths.subspan(begin, end - begin);
+            const auto round_sources = std::span(sources).subspan(begin, end - begin);
+            if (ring_.Broken() || !ReadRound(round_paths, round_sources))
+                std::ranges::transform(round_paths, round_sources.begin(), ReadWholeFile);
+        }
+        return sources;
+    }
+
+    std::string_view Name() const override { return "io_uring"; }
+
+private:
+    struct Pending {
+        int fd = -1;
+        int open_error = 0;
+        bool size_known = false;
+        struct statx stats {};
+        std::size_t requested = 0;
+        std::string buffer;
+    };
+
+    // Состояние раунда, в которое пишет ядро; держится в куче, чтобы пережить поломку кольца
+    using Round = std::vector<Pending>;
+
+    // false, если раунд не удался; открытые им файлы к этому моменту закрыты
+    bool ReadRound(std::span<const std::string> paths, std::span<Source> sources) {
+        auto round = std::make_unique<Round>(paths.size());
+        auto &pending = *round;
+
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            auto &open = ring_.Prepare(IORING_OP_OPENAT, AT_FDCWD, i * 2);
+            open.addr = reinterpret_cast<std::uint64_t>(paths[i].c_str());
+            open.open_flags = O_RDONLY | O_CLOEXEC;
+            auto &stat = ring_.Prepare(IORING_OP_STATX, AT_FDCWD, i * 2 + 1);
+            stat.addr = reinterpret_cast<std::uint64_t>(paths[i].c_str());
+            stat.len = STATX_SIZE;
+            stat.off = reinterpret_cast<std::uint64_t>(&pending[i].stats);
+        }
+        auto opened = ring_.SubmitAndWait([&](std::uint64_t user_data, int result) {
+            auto &file = pending[user_data / 2];
+            if (user_data % 2 == 1)
+                file.size_known = result == 0;
+            else if (result >= 0)
+                file.fd = result;
+            else
+                file.open_error = -result;
+        });
+        if (!opened)
+            return Abandon(std::move(round));
+
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            auto &file = pending[i];
+            if (file.fd < 0)
+                continue;
+            file.buffer.resize((file.size_known ? static_cast<std::size_t>(file.stats.stx_size) : 0) + 1);
+            file.requested = std::min(file.buffer.size(), kMaxReadChunk);
+            auto &read = ring_.Prepare(IORING_OP_READ, file.fd, i);
+            read.addr = reinterpret_cast<std::uint64_t>(file.buffer.data());
+            read.len = static_cast<std::uint32_t>(file.requested);
+            read.off = 0;
+        }
+        std::vector<Source> results(paths.size());
+        auto read = ring_.SubmitAndWait([&](std::uint64_t index, int result) {
+            auto &file = pending[index];
+            if (result < 0) {
+                results[index] = std::unexpected(IoError("Failed to read file", paths[index], -result));
+                return;
+            }
+            const auto count = static_cast<std::size_t>(result);
+            if (count < file.requested) {
+                file.buffer.resize(count);
+                results[index] = std::move(file.buffer);
+            } else {
+                results[index] = ReadRest(file.fd, paths[index], std::move(file.buffer), count);
+            }
+        });
+        if (!read)
+            return Abandon(std::move(round));
+
+        for (std::size_t i = 0; i < paths.size(); ++i)
+            if (pending[i].fd >= 0)
+                ring_.Prepare(IORING_OP_CLOSE, pending[i].fd, i);
+        auto closed = ring_.SubmitAndWait([&](std::uint64_t index, int) { pending[index].fd = -1; });
+        if (!closed)
+            Abandon(std::move(round));
+
+        for (std::size_t i = 0; i < paths.size(); ++i)
+            sources[i] = pending[i].open_error != 0
+                             ? std::unexpected(IoError("Can't open file", paths[i], pending[i].open_error))
+                             : std::move(results[i]);
+        return true;
+    }
+
+    // Закрывает открытые раундом файлы. Если кольцо сломано, ядро ещё может писать в буферы раунда
+    // и закрыть его файлы, поэтому состояние раунда и дескрипторы намеренно утекают
+    bool Abandon(std::unique_ptr<Round> round) {
+        if (ring_.Broken()) {
+            (void)round.release();
+            return false;
+        }
+        for (auto &file : *round)
+            if (file.fd >= 0)
+                ::close(std::exchange(file.fd, -1));
+        return false;
+    }
+
+    Ring ring_;
+};
+
+class ThreadPoolReader : public IBatchReader {
+public:
+    explicit ThreadPoolReader(std::size_t threads) : threads_(std::max<std::size_t>(threads, 1)) {}
+
+    std::vector<Source> ReadBatch(std::span<const std::string> paths) override {
+        std::vector<Source> sources(paths.size());
+        std::atomic<std::size_t> next{0};
+        schedule::RunWorkers(
+            std::min(threads_, std::max<std::size_t>(paths.size(), 1)),
+            [&]() -> std::optional<std::size_t> {
+                const auto index = next.fetch_add(1, std::memory_order_relaxed);
+                return index < paths.size() ? std::optional(index) : std::nullopt;
+            },
+            [&](std::size_t index, std::size_t) { sources[index] = ReadWholeFile(paths[index]); });
+        return sources;
+    }
+
+    std::string_view Name() const override { return "pread"; }
+
+private:
+    std::size_t threads_;
+};
+
+}  // namespace
+
+Source ReadWholeFile(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return std::unexpected(IoError("Can't open file", path, errno));
+
+    struct stat stats {};
+    const auto size = ::fstat(fd, &stats) == 0 ? static_cast<std::size_t>(stats.st_size) : 0;
+    auto source = ReadRest(fd, path, std::string(size + 1, '\0'), 0);
+    ::close(fd);
+    return source;
+}
+
+std::unique_ptr<IBatchReader> MakeBatchReader(Backend backend, std::size_t threads) {
+    switch (backend) {
+        case Backend::kIoUring:
+            return std::make_unique<IoUringReader>();
+        case Backend::kThreadPool:
+            return std::make_unique<ThreadPoolReader>(threads);
+        case Backend::kAuto:
+            break;
+    }
+    try {
+        return std::make_unique<IoUringReader>();
+    } catch (const std::runtime_error &) {
+        return std::make_unique<ThreadPoolReader>(threads);
+    }
+}
+
+Prefetcher::Prefetcher(std::span<const std::string> paths, std::vector<std::size_t> order,
+                       std::unique_ptr<IBatchReader> reader, std::size_t window)
+    : paths_(paths),
+      order_(std::move(order)),
+      reader_(std::move(reader)),
+      window_(std::max<std::size_t>(window, 1)),
+      sources_(paths.size()),
+      thread_([this](std::stop_token stop) { ReadLoop(stop); }) {}
+
+Prefetcher::~Prefetcher() = default;
+
+Source Prefetcher::Take(std::size_t index) {
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [&] { return sources_[index].has_value() || stopped_; });
+    if (!sources_[index])
+        return std::unexpected(Error{ErrorCode::kSkipped, "reading stopped before " + paths_[index]});
+    auto source = std::move(*sources_[index]);
+    sources_[index].reset();
+    ++taken_;
+    lock.unlock();
+    changed_.notify_all();
+    return source;
+}
+
+void Prefetcher::Stop() {
+    {
+        std::lock_guard lock(mutex_);
+        stopped_ = true;
+    }
+    changed_.notify_all();
+}
+
+void Prefetcher::ReadLoop(std::stop_token stop) {
+    std::vector<std::string> batch_paths;
+    while (true) {
+        std::size_t begin = 0;
+        {
+            std::unique_lock lock(mutex_);
+            if (!changed_.wait(lock, stop, [&] { return read_ - taken_ < window_ || stopped_; }) || stopped_)
+                return;
+            begin = read_;
+        }
+        if (begin == order_.size())
+            return;
+
+        const auto end = std::min(begin + kPrefetchBatch, order_.size());
+        batch_paths.clear();
+        for (std::size_t position = begin; position < end; ++position)
+            batch_paths.push_back(paths_[order_[position]]);
+
+        std::vector<Source> batch;
+        try {
+            batch = reader_->ReadBatch(batch_paths);
+        } catch (const std::exception &e) {
+            batch.assign(batch_paths.size(), std::unexpected(Error{ErrorCode::kIo, e.what()}));
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            for (std::size_t position = begin; position < end; ++position)
+                sources_[order_[position]] = std::move(batch[position - begin]);
+            read_ = end;
+        }
+        changed_.notify_all();
+    }
+}
+
+}  // namespace analyzer::io
@@ -4,16 +4,25 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 
+#include "error.hpp"
 #include "file.hpp"
 #include "function.hpp"
+#include "git_test_repo.hpp"
 #include "metric.hpp"
 #include "metric_accumulator.hpp"
+#include "result_cache.hpp"
+#include "schedule.hpp"
 
 namespace analyzer::tests {
 
@@ -29,13 +38,24 @@ std::filesystem::path SampleFileTwo() {
 
 struct NameLengthMetric : analyzer::metric::IMetric {
 protected:
-    analyzer::metric::MetricResult::ValueType CalculateImpl(const analyzer::function::Function &f) const override {
+    analyzer::Expected<analyzer::metric::MetricResult::ValueType> CalculateImpl(
+        const analyzer::function::Function &f) const override {
         return static_cast<int>(f.name.size());
     }
 
     std::string Name() const override { return "name_length"; }
 };
 
+struct FailingMetric : analyzer::metric::IMetric {
+protected:
+    analyzer::Expected<analyzer::metric::MetricResult::ValueType> CalculateImpl(
+        const analyzer::function::Function &f) const override {
+        return analyzer::MakeError(analyzer::ErrorCode::kParse, "cannot measure " + std::string(f.name));
+    }
+
+    std::string Name() const override { return "failing"; }
+};
+
 struct SumAccumulator : analyzer::metric_accumulator::IAccumulator {
     int total = 0;
 
@@ -61,6 +81,14 @@ analyzer::metric::MetricExtractor BuildExtractor() {
     return extractor;
 }
 
+FunctionAnalysis AnalyseSamples(const analyzer::metric::MetricExtractor &extractor,
+                                std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    AnalysisErrors errors;
+    auto analysis = AnalyseFunctions(SampleFiles(), extractor, errors, resource);
+    EXPECT_TRUE(errors.empty());
+    return analysis;
+}
+
 int ExpectedTotalNameLength(const analyzer::FunctionAnalysis &analysis) {
     return std::accumulate(analysis.begin(), analysis.end(), 0,
                            [](int acc, const analyzer::FunctionAnalysisEntry &entry) {
@@ -72,7 +100,7 @@ int ExpectedTotalNameLength(const analyzer::FunctionAnalysis &analysis) {
 
 TEST(AnalyseFunctions, CollectsFunctionsAndMetrics) {
     auto extractor = BuildExtractor();
-    const auto analysis = AnalyseFunctions(SampleFiles(), extractor);
+    const auto analysis = AnalyseSamples(extractor);
 
     EXPECT_EQ(analysis.size(), 5);
     for (const auto &entry : analysis) {
@@ -87,9 +115,184 @@ TEST(AnalyseFunctions, CollectsFunctionsAndMetrics) {
     }
 }
 
+TEST(AnalyseFunctions, AllocatesResultsFromGivenResource) {
+    auto extractor = BuildExtractor();
+    std::pmr::monotonic_buffer_resource arena;
+    const auto analysis = AnalyseSamples(extractor, &arena);
+
+    ASSERT_EQ(analysis.size(), 5);
+    for (const auto &entry : analysis) {
+        EXPECT_EQ(entry.first.ast.get_allocator().resource(), &arena);
+        EXPECT_EQ(entry.first.name.get_allocator().resource(), &arena);
+        EXPECT_EQ(entry.second.get_allocator().resource(), &arena);
+    }
+}
+
+TEST(AnalyseFunctions, ForEachFileAnalysisVisitsFilesInOrder) {
+    auto extractor = BuildExtractor();
+    const auto expected = AnalyseSamples(extractor);
+
+    std::vector<std::pmr::string> names;
+    std::size_t files = 0;
+    auto visit = [&](const FunctionAnalysis &analysis, const AnalysisErrors &errors) {
+        ++files;
+        EXPECT_TRUE(errors.empty());
+        for (const auto &entry : analysis)
+            names.emplace_back(entry.first.name);
+    };
+    ForEachFileAnalysis(SampleFiles(), extractor, visit);
+
+    EXPECT_EQ(files, 2u);
+    ASSERT_EQ(names.size(), expected.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+        EXPECT_EQ(names[i], expected[i].first.name);
+}
+
+TEST(AnalyseFunctions, SkipsUnreadableFileAndContinues) {
+    auto extractor = BuildExtractor();
+    const auto missing = (SampleFileOne().parent_path() / "missing.py").string();
+    AnalysisErrors errors;
+    const auto analysis = AnalyseFunctions({missing, SampleFileTwo().string()}, extractor, errors);
+
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_EQ(errors.front().filename.View(), missing);
+    EXPECT_EQ(errors.front().error.code, analyzer::ErrorCode::kIo);
+    EXPECT_TRUE(errors.front().function.empty());
+    EXPECT_TRUE(errors.front().metric_name.empty());
+
+    ASSERT_FALSE(analysis.empty());
+    EXPECT_TRUE(std::all_of(analysis.begin(), analysis.end(), [](const auto &entry) {
+        return entry.first.filename.View() == SampleFileTwo().string();
+    }));
+}
+
+TEST(AnalyseFunctions, SkipsFilesOverParseOutputLimit) {
+    auto extractor = BuildExtractor();
+    AnalysisErrors errors;
+    const AnalysisLimits limits{.parse = {.max_output_bytes = 16}};
+    const auto analysis =
+        AnalyseFunctions(SampleFiles(), extractor, errors, std::pmr::get_default_resource(), limits);
+
+    EXPECT_TRUE(analysis.empty());
+    ASSERT_EQ(errors.size(), SampleFiles().size());
+    for (const auto &error : errors)
+        EXPECT_EQ(error.error.code, analyzer::ErrorCode::kTooLarge);
+}
+
+TEST(AnalyseFunctions, RecordsMetricErrorsAndKeepsOtherMetrics) {
+    auto extractor = BuildExtractor();
+    extractor.RegisterMetric(std::make_unique<FailingMetric>());
+    AnalysisErrors errors;
+    const auto analysis = AnalyseFunctions(SampleFiles(), extractor, errors);
+
+    ASSERT_EQ(analysis.size(), 5u);
+    ASSERT_EQ(errors.size(), analysis.size());
+    for (std::size_t i = 0; i < analysis.size(); ++i) {
+        const auto &function = analysis[i].first;
+        ASSERT_EQ(analysis[i].second.size(), 1u);
+        EXPECT_EQ(analysis[i].second.front().metric_name, "name_length");
+
+        EXPECT_EQ(errors[i].filename, function.filename);
+        EXPECT_TRUE(errors[i].function.ends_with(function.name));
+        EXPECT_EQ(errors[i].metric_name, "failing");
+        EXPECT_EQ(errors[i].error.code, analyzer::ErrorCode::kParse);
+    }
+}
+
+TEST(AnalyseFunctions, ParallelAnalysisKeepsInputOrder) {
+    auto extractor = BuildExtractor();
+    const auto expected = AnalyseSamples(extractor);
+    auto files = SampleFiles();
+    files.insert(files.end(), {SampleFileTwo().string(), SampleFileOne().string()});
+
+    AnalysisErrors errors;
+    std::pmr::monotonic_buffer_resource arena;
+    analyzer::schedule::ScheduleProfile profile;
+    const auto analysis = AnalyseFunctionsParallel(files, extractor, errors, 3, &arena, {}, &profile);
+
+    EXPECT_TRUE(errors.empty());
+    EXPECT_EQ(profile.workers, 3u);
+    ASSERT_EQ(analysis.size(), 2 * expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(analysis[i].first.filename, expected[i].first.filename);
+        EXPECT_EQ(analysis[i].first.name, expected[i].first.name);
+        EXPECT_EQ(analysis[i].second.front().value, expected[i].second.front().value);
+        EXPECT_EQ(analysis[i].first.ast.get_allocator().resource(), &arena);
+    }
+    EXPECT_EQ(analysis[expected.size()].first.filename.View(), SampleFileTwo().string());
+    EXPECT_EQ(analysis.back().first.filename.View(), SampleFileOne().string());
+}
+
+TEST(AnalyseFunctions, RevisionAnalysisReadsObjectDatabaseAndReusesCache) {
+    auto extractor = BuildExtractor();
+    const auto samples = AnalyseSamples(extractor);
+    const auto one_size = rs::count(samples, SampleFileOne().string(), [](const FunctionAnalysisEntry &entry) {
+        return std::string(entry.first.filename.View());
+    });
+
+    TempGitRepo repo("analyse_revision");
+    repo.Copy(SampleFileOne(), "a.py");
+    repo.Copy(SampleFileTwo(), "b.py");
+    repo.Copy(SampleFileOne(), "dup/a_copy.py");
+    const auto rev = repo.Commit("samples");
+    repo.Write("b.py", "not python at all (");  // Рабочее дерево не читается
+
+    cache::ResultCache cache;
+    for (int run = 0; run < 2; ++run) {
+        AnalysisErrors errors;
+        const auto analysis = AnalyseRevision(repo.Root(), rev, extractor, errors, 2, std::pmr::get_default_resource(),
+                                              {}, &cache);
+
+        EXPECT_TRUE(errors.empty());
+        ASSERT_EQ(analysis.size(), samples.size() + static_cast<std::size_t>(one_size));
+        for (std::size_t i = 0; i < analysis.size(); ++i) {
+            const auto &expected = samples[i < samples.size() ? i : i - samples.size()];
+            EXPECT_EQ(analysis[i].first.name, expected.first.name);
+            EXPECT_EQ(analysis[i].second.front().value, expected.second.front().value);
+        }
+        EXPECT_EQ(analysis.front().first.filename.View(), "a.py");
+        EXPECT_EQ(analysis.back().first.filename.View(), "dup/a_copy.py");
+    }
+    EXPECT_EQ(cache.Misses(), 2u);  // Два разных blob-а; копия a.py разбирается один раз
+    EXPECT_EQ(cache.Hits(), 2u);
+}
+
+TEST(AnalyseFunctions, ChangeAnalysisKeepsOnlyFunctionsTouchedByDiff) {
+    auto extractor = BuildExtractor();
+    TempGitRepo repo("analyse_changes");
+    repo.Copy(SampleFileOne(), "a.py");
+    repo.Copy(SampleFileTwo(), "b.py");
+    const auto base = repo.Commit("samples");
+
+    std::ifstream sample(SampleFileOne());
+    std::string source(std::istreambuf_iterator<char>(sample), {});
+    source.replace(source.find("value - 1"), 9, "value - 2");
+    repo.Write("a.py", source + "\n\ndef added(x):\n    return x\n");
+
+    AnalysisErrors errors;
+    cache::ResultCache cache;
+    const auto changes = AnalyseChanges(repo.Root(), base, extractor, errors, 2, std::pmr::get_default_resource(),
+                                        {}, &cache);
+    EXPECT_TRUE(errors.empty());
+    ASSERT_EQ(changes.changed.size(), 2u);
+    ASSERT_EQ(changes.base_index.size(), 2u);
+
+    const auto &second = changes.changed[0].first;
+    EXPECT_EQ(function::QualifiedName(second), "Alpha.second");
+    EXPECT_EQ(second.filename.View(), (std::filesystem::path(repo.Root()) / "a.py").string());
+    EXPECT_EQ(second.first_line, 4u);
+    EXPECT_EQ(second.end_line, 6u);
+    ASSERT_TRUE(changes.base_index[0].has_value());
+    EXPECT_EQ(function::QualifiedName(changes.base[*changes.base_index[0]].first), "Alpha.second");
+
+    EXPECT_EQ(changes.changed[1].first.name, "added");
+    EXPECT_FALSE(changes.base_index[1].has_value());
+    EXPECT_EQ(cache.Misses(), 1u);  // Из базы прочитан только изменённый файл
+}
+
 TEST(AnalyseFunctions, SplitByClassesGroupsClassMethods) {
     auto extractor = BuildExtractor();
-    const auto analysis = AnalyseFunctions(SampleFiles(), extractor);
+    const auto analysis = AnalyseSamples(extractor);
 
     const auto grouped = SplitByClasses(analysis);
     ASSERT_EQ(grouped.size(), 2u);
@@ -108,22 +311,22 @@ TEST(AnalyseFunctions, SplitByClassesGroupsClassMethods) {
 
 TEST(AnalyseFunctions, SplitByFilesGroupsFunctionsByFilename) {
     auto extractor = BuildExtractor();
-    const auto analysis = AnalyseFunctions(SampleFiles(), extractor);
+    const auto analysis = AnalyseSamples(extractor);
 
     const auto grouped = SplitByFiles(analysis);
     ASSERT_EQ(grouped.size(), 2u);
 
     EXPECT_TRUE(std::all_of(grouped[0].begin(), grouped[0].end(), [&](const auto &entry) {
-        return entry.first.filename == SampleFileOne().string();
+        return entry.first.filename.View() == SampleFileOne().string();
     }));
     EXPECT_TRUE(std::all_of(grouped[1].begin(), grouped[1].end(), [&](const auto &entry) {
-        return entry.first.filename == SampleFileTwo().string();
+        return entry.first.filename.View() == SampleFileTwo().string();
     }));
 }
 
 TEST(AnalyseFunctions, AccumulateFunctionAnalysisFeedsAccumulator) {
     auto extractor = BuildExtractor();
-    const auto analysis = AnalyseFunctions(SampleFiles(), extractor);
+    const auto analysis = AnalyseSamples(extractor);
 
     analyzer::metric_accumulator::MetricsAccumulator accumulator;
     accumulator.RegisterAccumulator("name_length", std::make_unique<SumAccumulator>());
@@ -135,4 +338,17 @@ TEST(AnalyseFunctions, AccumulateFunctionAnalysisFeedsAccumulator) {
     EXPECT_EQ(sum_acc.total, ExpectedTotalNameLength(analysis));
 }
 
+TEST(AnalyseFunctions, AccumulateFunctionAnalysisBatchFeedsAccumulator) {
+    auto extractor = BuildExtractor();
+    const auto analysis = AnalyseSamples(extractor);
+
+    analyzer::metric_accumulator::MetricsAccumulator accumulator;
+    accumulator.RegisterAccumulator("name_length", std::make_unique<SumAccumulator>());
+
+    AccumulateFunctionAnalysisBatch(analysis, accumulator);
+
+    const auto &sum_acc = accumulator.GetFinalizedAccumulator<SumAccumulator>("name_length");
+    EXPECT_EQ(sum_acc.total, ExpectedTotalNameLength(analysis));
+}
+
 }  // namespace analyzer::tests
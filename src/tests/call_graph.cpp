@@ -0,0 +1,146 @@
+#include "call_graph.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "analyse.hpp"
+#include "file.hpp"
+#include "function.hpp"
+#include "metric.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+function::Function MakeFunction(std::string_view filename, std::string_view name,
+                                std::initializer_list<std::string_view> callees) {
+    function::Function func{.filename = filename, .class_name = std::nullopt, .name = std::pmr::string(name)};
+    for (const auto callee : callees)
+        func.callees.emplace_back(callee);
+    return func;
+}
+
+std::vector<calls::CallGraph::FunctionIndex> CalleesOf(const calls::CallGraph &graph, std::size_t function) {
+    const auto callees = graph.Callees(function);
+    return {callees.begin(), callees.end()};
+}
+
+int MetricValue(const metric::MetricResults &metrics, std::string_view name) {
+    const auto it = std::ranges::find(metrics, name, [](const metric::MetricResult &result) {
+        return result.metric_name.View();
+    });
+    return it == metrics.end() ? -1 : std::get<int>(it->value);
+}
+
+}  // namespace
+
+TEST(CallGraph, ResolvesCallsByNamePreferringCallerFile) {
+    const std::vector<function::Function> functions{
+        MakeFunction("a.py", "main", {"parse", "parse", "report", "print"}),
+        MakeFunction("a.py", "parse", {"parse", "tokenize"}),
+        MakeFunction("b.py", "parse", {}),
+        MakeFunction("b.py", "tokenize", {}),
+        MakeFunction("b.py", "report", {}),
+        MakeFunction("b.py", "run", {"parse"}),
+    };
+    std::vector<const function::Function *> pointers;
+    for (const auto &func : functions)
+        pointers.push_back(&func);
+    const calls::CallGraph graph(pointers);
+
+    ASSERT_EQ(graph.Size(), 6u);
+    // parse есть в a.py, поэтому b.py:parse не получает ребро от main; print не определена
+    EXPECT_EQ(CalleesOf(graph, 0), (std::vector<calls::CallGraph::FunctionIndex>{1, 4}));
+    // Рекурсия не даёт ребра, tokenize есть только в b.py
+    EXPECT_EQ(CalleesOf(graph, 1), (std::vector<calls::CallGraph::FunctionIndex>{3}));
+    EXPECT_EQ(CalleesOf(graph, 5), (std::vector<calls::CallGraph::FunctionIndex>{2}));
+    EXPECT_EQ(graph.EdgeCount(), 4u);
+
+    EXPECT_EQ(graph.FanOut(0), 2u);
+    EXPECT_EQ(graph.FanIn(1), 1u);
+    EXPECT_EQ(graph.FanIn(2), 1u);
+    EXPECT_TRUE(graph.Unreferenced(0));
+    EXPECT_TRUE(graph.Unreferenced(5));
+    EXPECT_FALSE(graph.Unreferenced(3));
+}
+
+TEST(CallGraph, MetricsAreAppendedToAnalysedFunctions) {
+    const TempTree tree("call_graph_");
+    const auto path = tree.Write("service.py", "class Service:\n"
+                                               "    def run(self):\n"
+                                               "        return self.load() + helper(1)\n"
+                                               "\n"
+                                               "    def load(self):\n"
+                                               "        return 1\n"
+                                               "\n"
+                                               "\n"
+                                               "def helper(x):\n"
+                                               "    return x\n"
+                                               "\n"
+                                               "\n"
+                                               "def unused():\n"
+                                               "    return print(len([]))\n");
+    metric::MetricExtractor extractor;
+    extractor.collect_callees = true;
+    AnalysisErrors errors;
+    auto analysis = AnalyseFunctions({path}, extractor, errors);
+    ASSERT_TRUE(errors.empty());
+    ASSERT_EQ(analysis.size(), 4u);
+    EXPECT_EQ(analysis[0].first.callees, (std::pmr::vector<interner::InternedString>{"load", "helper"}));
+
+    const auto graph = AppendCallGraphMetrics(analysis);
+    EXPECT_EQ(graph.EdgeCount(), 2u);
+    const auto &run = analysis[0].second;
+    EXPECT_EQ(MetricValue(run, calls::kFanOutMetric), 2);
+    EXPECT_EQ(MetricValue(run, calls::kFanInMetric), 0);
+    EXPECT_EQ(MetricValue(run, calls::kUnreferencedMetric), 1);
+    EXPECT_EQ(MetricValue(analysis[1].second, calls::kFanInMetric), 1);
+    EXPECT_EQ(MetricValue(analysis[2].second, calls::kUnreferencedMetric), 0);
+    // print и len не определены во входных файлах
+    EXPECT_EQ(MetricValue(analysis[3].second, calls::kFanOutMetric), 0);
+    EXPECT_EQ(MetricValue(analysis[3].second, calls::kUnreferencedMetric), 1);
+    EXPECT_EQ(analysis[3].second.back().metric_id, metric::FindMetricId(calls::kUnreferencedMetric));
+}
+
+TEST(CallGraph, CalleesAreCollectedOnRequestAndBrokenCallsSkipped) {
+    // cat вместо tree-sitter: AST берётся из самого файла
+    const ScopedParserCommand parser({"cat"});
+    const TempTree tree("callees_");
+    const auto path = tree.Write("f.ast", "(module [0, 0] - [3, 0]\n"
+                                          "  (function_definition [0, 0] - [2, 7]\n"
+                                          "    name: (identifier [0, 4] - [0, 5])\n"
+                                          "    parameters: (parameters [0, 5] - [0, 7])\n"
+                                          "    body: (block [1, 4] - [2, 7]\n"
+                                          "      (expression_statement [1, 4] - [1, 7]\n"
+                                          "        (call [1, 4] - [1, 7]\n"
+                                          "          function: (identifier [1 4] - [1, 5])\n"
+                                          "          arguments: (argument_list [1, 5] - [1, 7])))\n"
+                                          "      (expression_statement [2, 4] - [2, 7]\n"
+                                          "        (call [2, 4] - [2, 7]\n"
+                                          "          function: (identifier [2, 4] - [2, 5])\n"
+                                          "          arguments: (argument_list [2, 5] - [2, 7]))))))\n");
+    auto file = file::File::Open(path, std::string("def f():\n    g()\n    h()\n"));
+    ASSERT_TRUE(file.has_value()) << file.error().message;
+
+    function::FunctionExtractor plain;
+    const auto without_callees = plain.TryGet(*file);
+    ASSERT_TRUE(without_callees.has_value()) << without_callees.error().message;
+    ASSERT_EQ(without_callees->size(), 1u);
+    EXPECT_TRUE(without_callees->front().callees.empty());
+
+    // Координаты первого вызова испорчены: он пропускается, а функция и второй вызов остаются
+    function::FunctionExtractor collecting{.collect_callees = true};
+    const auto with_callees = collecting.TryGet(*file);
+    ASSERT_TRUE(with_callees.has_value()) << with_callees.error().message;
+    ASSERT_EQ(with_callees->size(), 1u);
+    EXPECT_EQ(with_callees->front().callees, (std::pmr::vector<interner::InternedString>{"h"}));
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,144 @@
+#include "clone_detector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "analyse.hpp"
+#include "error.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+// "def f(x):\n    return x + 1" со строки line; в дереве 9 узлов, в теле 5
+std::string FunctionAst(std::size_t line) {
+    const auto head = std::to_string(line);
+    const auto body = std::to_string(line + 1);
+    return "  (function_definition [" + head + ", 0] - [" + body + ", 16]\n"
+           "    name: (identifier [" + head + ", 4] - [" + head + ", 5])\n"
+           "    parameters: (parameters [" + head + ", 5] - [" + head + ", 8]\n"
+           "      (identifier [" + head + ", 6] - [" + head + ", 7]))\n"
+           "    body: (block [" + body + ", 4] - [" + body + ", 16]\n"
+           "      (return_statement [" + body + ", 4] - [" + body + ", 16]\n"
+           "        (binary_operator [" + body + ", 11] - [" + body + ", 16]\n"
+           "          left: (identifier [" + body + ", 11] - [" + body + ", 12])\n"
+           "          right: (integer [" + body + ", 15] - [" + body + ", 16])))))";
+}
+
+std::pmr::vector<std::pmr::string> FunctionLines(char name, char param) {
+    std::pmr::string head = "def ?(?):";
+    head[4] = name;
+    head[6] = param;
+    std::pmr::string body = "    return ? + 1";
+    body[11] = param;
+    return {head, body};
+}
+
+// Модуль из одной функции
+struct Source {
+    std::string ast;
+    std::pmr::vector<std::pmr::string> lines;
+};
+
+Source PlainModule(char name, char param) {
+    return {"(module [0, 0] - [2, 0]\n" + FunctionAst(0) + ")", FunctionLines(name, param)};
+}
+
+// Та же функция после import os: модули разные, функции совпадают
+Source ModuleWithImport(char name, char param) {
+    Source source{"(module [0, 0] - [3, 0]\n"
+                  "  (import_statement [0, 0] - [0, 9]\n"
+                  "    name: (dotted_name [0, 7] - [0, 9]\n"
+                  "      (identifier [0, 7] - [0, 9])))\n" +
+                      FunctionAst(1) + ")",
+                  {std::pmr::string("import os")}};
+    for (auto &line : FunctionLines(name, param))
+        source.lines.push_back(line);
+    return source;
+}
+
+}  // namespace
+
+TEST(CloneDetector, IdenticalFunctionsFormOneMaximalClass) {
+    const auto first = PlainModule('f', 'x');
+    const auto second = ModuleWithImport('f', 'x');
+    clones::CloneIndex index({.min_nodes = 5});
+    ASSERT_TRUE(index.AddTree("a.py", first.ast, first.lines));
+    ASSERT_TRUE(index.AddTree("b.py", second.ast, second.lines));
+
+    // Тело функции тоже повторяется, но лежит внутри копий функции и отдельно не сообщается
+    const auto classes = index.Classes();
+    ASSERT_EQ(classes.size(), 1u);
+    EXPECT_EQ(classes[0].nodes, 9u);
+    ASSERT_EQ(classes[0].locations.size(), 2u);
+    EXPECT_EQ(classes[0].locations[0].node_type.View(), "function_definition");
+    EXPECT_EQ(classes[0].locations[0].filename.View(), "a.py");
+    EXPECT_EQ(classes[0].locations[0].start, (clones::SourcePosition{0, 0}));
+    EXPECT_EQ(classes[0].locations[1].filename.View(), "b.py");
+    EXPECT_EQ(classes[0].locations[1].start, (clones::SourcePosition{1, 0}));
+    EXPECT_EQ(classes[0].locations[1].end, (clones::SourcePosition{2, 16}));
+
+    clones::CloneIndex large({.min_nodes = 10});
+    ASSERT_TRUE(large.AddTree("a.py", first.ast, first.lines));
+    ASSERT_TRUE(large.AddTree("b.py", second.ast, second.lines));
+    EXPECT_TRUE(large.Classes().empty());
+}
+
+TEST(CloneDetector, RenamedCopyNeedsIdentifierNormalization) {
+    const auto first = PlainModule('f', 'x');
+    const auto renamed = ModuleWithImport('g', 'y');
+
+    clones::CloneIndex exact({.min_nodes = 5});
+    ASSERT_TRUE(exact.AddTree("a.py", first.ast, first.lines));
+    ASSERT_TRUE(exact.AddTree("b.py", renamed.ast, renamed.lines));
+    EXPECT_TRUE(exact.Classes().empty());
+
+    clones::CloneIndex normalized({.min_nodes = 5, .normalize_identifiers = true});
+    ASSERT_TRUE(normalized.AddTree("a.py", first.ast, first.lines));
+    ASSERT_TRUE(normalized.AddTree("b.py", renamed.ast, renamed.lines));
+    const auto classes = normalized.Classes();
+    ASSERT_EQ(classes.size(), 1u);
+    EXPECT_EQ(classes[0].nodes, 9u);
+    EXPECT_EQ(classes[0].locations.size(), 2u);
+
+    // Литералы остаются значимыми и при нормализации имён
+    auto other_literal = renamed;
+    other_literal.lines.back() = "    return y + 2";
+    clones::CloneIndex literals({.min_nodes = 5, .normalize_identifiers = true});
+    ASSERT_TRUE(literals.AddTree("a.py", first.ast, first.lines));
+    ASSERT_TRUE(literals.AddTree("b.py", other_literal.ast, other_literal.lines));
+    EXPECT_TRUE(literals.Classes().empty());
+}
+
+TEST(CloneDetector, MalformedAstIsRejected) {
+    const auto valid = PlainModule('f', 'x');
+    clones::CloneIndex index({.min_nodes = 1});
+    const auto added = index.AddTree("broken.py", valid.ast.substr(0, valid.ast.size() - 1), valid.lines);
+    ASSERT_FALSE(added);
+    EXPECT_EQ(added.error().code, ErrorCode::kParse);
+    EXPECT_FALSE(index.AddTree("broken.py", "(module [0, 0] - [1, 0]))", valid.lines));
+    EXPECT_TRUE(index.Classes().empty());
+}
+
+TEST(CloneDetector, FindClonesReportsCopiesAndUnreadableFiles) {
+    const auto sample = SampleFile().string();
+    const std::vector<std::string> files{sample, sample, "missing_clone_input.py"};
+    AnalysisErrors errors;
+    const auto classes = FindClones(files, {.min_nodes = 5}, errors, 2);
+
+    // Файл дважды: самый большой класс — весь модуль из двух копий
+    ASSERT_FALSE(classes.empty());
+    EXPECT_EQ(classes[0].locations.size(), 2u);
+    EXPECT_EQ(classes[0].locations[0].node_type.View(), "module");
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_EQ(errors[0].filename.View(), "missing_clone_input.py");
+}
+
+}  // namespace analyzer::tests
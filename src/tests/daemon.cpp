@@ -0,0 +1,152 @@
+#include "analysis_daemon.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analyse.hpp"
+#include "daemon_protocol.hpp"
+#include "metric.hpp"
+#include "result_cache.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+std::string ReadSample(const std::string &name) {
+    std::ifstream input(SampleFile(name), std::ios::binary);
+    return {std::istreambuf_iterator<char>(input), {}};
+}
+
+std::string SocketPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / (name + "_" + std::to_string(getpid()) + ".sock")).string();
+}
+
+// Функции и метрики ответа демона совпадают с анализом того же файла в процессе
+void ExpectMatchesInProcess(const daemon::ItemResult &item, const std::string &path,
+                            const analyzer::metric::MetricExtractor &extractor) {
+    AnalysisErrors errors;
+    const auto expected = detail::ToCachedFile(AnalyseFunctions({path}, extractor, errors));
+    ASSERT_TRUE(errors.empty());
+    EXPECT_TRUE(item.errors.empty());
+    ASSERT_EQ(item.result.functions.size(), expected.functions.size());
+    for (std::size_t i = 0; i < expected.functions.size(); ++i) {
+        const auto &actual_function = item.result.functions[i];
+        EXPECT_EQ(actual_function.class_name, expected.functions[i].class_name);
+        EXPECT_EQ(actual_function.name, expected.functions[i].name);
+        ASSERT_EQ(actual_function.metrics.size(), expected.functions[i].metrics.size());
+        for (std::size_t m = 0; m < actual_function.metrics.size(); ++m)
+            EXPECT_EQ(actual_function.metrics[m].value, expected.functions[i].metrics[m].value);
+    }
+}
+
+}  // namespace
+
+TEST(DaemonProtocol, RequestAndResponseRoundTrip) {
+    const daemon::Request request{.items = {{.name = "/abs/a.py", .content = std::nullopt},
+                                            {.name = "buffer.py", .content = std::string("def f():\n\0pass\n", 16)}}};
+    const auto decoded_request = daemon::DecodeRequest(daemon::EncodeRequest(request));
+    ASSERT_TRUE(decoded_request);
+    ASSERT_EQ(decoded_request->items.size(), 2u);
+    EXPECT_EQ(decoded_request->items[0].name, "/abs/a.py");
+    EXPECT_FALSE(decoded_request->items[0].content);
+    EXPECT_EQ(decoded_request->items[1].content, request.items[1].content);
+
+    daemon::Response response;
+    response.items.resize(2);
+    response.items[0].result.functions.push_back(
+        {.class_name = "Alpha",
+         .name = "first",
+         .metrics = {{.metric_name = "code_lines_count", .value = -3}, {.metric_name = "kind", .value = "method"}}});
+    response.items[1].errors.push_back({.function = "f", .metric_name = "m", .code = ErrorCode::kTimeout,
+                                        .message = "slow"});
+    const auto decoded = daemon::DecodeResponse(daemon::EncodeResponse(response));
+    ASSERT_TRUE(decoded);
+    ASSERT_EQ(decoded->items.size(), 2u);
+    const auto &function = decoded->items[0].result.functions.at(0);
+    EXPECT_EQ(function.class_name, "Alpha");
+    EXPECT_EQ(function.name, "first");
+    EXPECT_EQ(function.metrics.at(0).value, metric::MetricResult::ValueType(-3));
+    EXPECT_EQ(function.metrics.at(1).value, metric::MetricResult::ValueType("method"));
+    const auto &error = decoded->items[1].errors.at(0);
+    EXPECT_EQ(error.code, ErrorCode::kTimeout);
+    EXPECT_EQ(error.message, "slow");
+}
+
+TEST(DaemonProtocol, RejectsTruncatedAndTrailingBytes) {
+    daemon::Response response;
+    response.items.resize(1);
+    response.items[0].result.functions.push_back(
+        {.class_name = std::nullopt, .name = "f", .metrics = {{.metric_name = "m", .value = 1}}});
+    const auto payload = daemon::EncodeResponse(response);
+    for (std::size_t size = 0; size < payload.size(); ++size)
+        EXPECT_FALSE(daemon::DecodeResponse(payload.substr(0, size))) << size;
+    EXPECT_FALSE(daemon::DecodeResponse(payload + '\0'));
+    EXPECT_FALSE(daemon::DecodeRequest("\x01\xff\xff\xff\x7f"));
+}
+
+TEST(AnalysisDaemon, ReportsUnreadableFileWithoutStoppingOthers) {
+    const auto extractor = BuildExtractor();
+    cache::ResultCache cache;
+    daemon::AnalysisDaemon analysis_daemon(extractor, cache, 2);
+    const auto sample = SampleFile("analysis_sample_one.py").string();
+    const daemon::Request request{.items = {{.name = "/nonexistent/missing.py", .content = std::nullopt},
+                                            {.name = sample, .content = std::nullopt}}};
+    const auto response = analysis_daemon.Handle(request);
+    ASSERT_EQ(response.items.size(), 2u);
+    ASSERT_EQ(response.items[0].errors.size(), 1u);
+    EXPECT_EQ(response.items[0].errors[0].code, ErrorCode::kIo);
+    ExpectMatchesInProcess(response.items[1], sample, extractor);
+}
+
+TEST(AnalysisDaemon, ServesConcurrentClientsAndReusesResults) {
+    const auto extractor = BuildExtractor();
+    cache::ResultCache cache;
+    const auto socket_path = SocketPath("analysis_daemon");
+    const auto sample_one = SampleFile("analysis_sample_one.py").string();
+    const auto sample_two = SampleFile("analysis_sample_two.py").string();
+    {
+        daemon::AnalysisDaemon analysis_daemon(extractor, cache, 2);
+        ASSERT_TRUE(analysis_daemon.Listen(socket_path));
+        std::jthread server([&] { EXPECT_TRUE(analysis_daemon.Serve()); });
+
+        // Путь к файлу и несохранённый буфер с тем же текстом дают одну запись кеша
+        const daemon::Request request{
+            .items = {{.name = sample_one, .content = std::nullopt},
+                      {.name = sample_two, .content = std::nullopt},
+                      {.name = "unsaved.py", .content = ReadSample("analysis_sample_one.py")}}};
+        std::vector<Expected<daemon::Response>> responses(3, MakeError(ErrorCode::kIo, "not called"));
+        {
+            std::vector<std::jthread> clients;
+            for (auto &response : responses)
+                clients.emplace_back([&] { response = daemon::Call(socket_path, request); });
+        }
+        // ASSERT здесь оставил бы поток Serve без Stop
+        for (const auto &response : responses) {
+            EXPECT_TRUE(response) << response.error().message;
+            if (!response)
+                continue;
+            ExpectMatchesInProcess(response->items[0], sample_one, extractor);
+            ExpectMatchesInProcess(response->items[1], sample_two, extractor);
+            ExpectMatchesInProcess(response->items[2], sample_one, extractor);
+        }
+        EXPECT_GT(cache.Hits(), 0u);
+
+        // Второй демон на том же сокете не должен перехватить живой
+        daemon::AnalysisDaemon second(extractor, cache, 1);
+        EXPECT_FALSE(second.Listen(socket_path));
+
+        analysis_daemon.Stop();
+    }
+    EXPECT_FALSE(std::filesystem::exists(socket_path));
+    EXPECT_FALSE(daemon::Call(socket_path, {}));
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,104 @@
+#include "directory_walker.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "path_queue.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+using analyzer::walk::GlobMatch;
+using analyzer::walk::IgnoreRules;
+
+std::vector<std::string> CollectRelative(const TempTree &tree, const analyzer::walk::WalkOptions &options,
+                                         std::vector<analyzer::walk::WalkError> *errors = nullptr) {
+    PathQueue paths;
+    auto walk_errors = analyzer::walk::Walk({tree.Root()}, options, paths);
+    paths.Close();
+    if (errors)
+        *errors = std::move(walk_errors);
+
+    std::vector<std::string> found;
+    while (auto queued = paths.Pop())
+        found.push_back(std::filesystem::relative(queued->path, tree.Root()).string());
+    std::ranges::sort(found);
+    return found;
+}
+
+}  // namespace
+
+TEST(DirectoryWalker, GlobMatchFollowsGitignoreSemantics) {
+    EXPECT_TRUE(GlobMatch("*.py", "module.py"));
+    EXPECT_FALSE(GlobMatch("*.py", "pkg/module.py"));
+    EXPECT_TRUE(GlobMatch("test_?.py", "test_1.py"));
+    EXPECT_TRUE(GlobMatch("[abc]*.py", "b_module.py"));
+    EXPECT_FALSE(GlobMatch("[!abc]*.py", "b_module.py"));
+    EXPECT_TRUE(GlobMatch("**/generated", "generated"));
+    EXPECT_TRUE(GlobMatch("**/generated", "a/b/generated"));
+    EXPECT_TRUE(GlobMatch("docs/**", "docs/a/b.py"));
+    EXPECT_TRUE(GlobMatch("a/**/b.py", "a/b.py"));
+    EXPECT_TRUE(GlobMatch("a/**/b.py", "a/x/y/b.py"));
+    EXPECT_FALSE(GlobMatch("a/*/b.py", "a/x/y/b.py"));
+}
+
+TEST(DirectoryWalker, IgnoreRulesUseLastMatchAndScopes) {
+    IgnoreRules rules;
+    rules.AddFile("# comment\n*.pyc\nbuild/\n/top.py\n*_test.py\n!keep_test.py\n", "");
+    rules.Add("local.py", "pkg");
+
+    EXPECT_TRUE(rules.IsIgnored("a/b/c.pyc", false));
+    EXPECT_TRUE(rules.IsIgnored("src/build", true));
+    EXPECT_FALSE(rules.IsIgnored("src/build", false));
+    EXPECT_TRUE(rules.IsIgnored("top.py", false));
+    EXPECT_FALSE(rules.IsIgnored("sub/top.py", false));
+    EXPECT_TRUE(rules.IsIgnored("x/drop_test.py", false));
+    EXPECT_FALSE(rules.IsIgnored("x/keep_test.py", false));
+    EXPECT_TRUE(rules.IsIgnored("pkg/inner/local.py", false));
+    EXPECT_FALSE(rules.IsIgnored("other/local.py", false));
+}
+
+TEST(DirectoryWalker, FindsPythonFilesHonouringGitignoreAndExcludes) {
+    TempTree tree("walker_test_");
+    tree.Write("main.py");
+    tree.Write("README.md");
+    tree.Write(".gitignore", "venv/\n");
+    tree.Write("venv/lib/site.py");
+    tree.Write(".git/hooks/hook.py");
+    tree.Write("pkg/module.py");
+    tree.Write("pkg/.gitignore", "generated_*.py\n");
+    tree.Write("pkg/generated_api.py");
+    tree.Write("pkg/deep/nested/leaf.py");
+    tree.Write("generated_root.py");
+    tree.Write("tests/test_main.py");
+
+    analyzer::walk::WalkOptions options;
+    options.exclude = {"tests/"};
+    options.threads = 3;
+
+    EXPECT_EQ(CollectRelative(tree, options),
+              (std::vector<std::string>{"generated_root.py", "main.py", "pkg/deep/nested/leaf.py", "pkg/module.py"}));
+
+    options.read_gitignore = false;
+    options.exclude.clear();
+    EXPECT_EQ(CollectRelative(tree, options).size(), 7u);
+}
+
+TEST(DirectoryWalker, ReportsMissingRoots) {
+    PathQueue paths;
+    const auto errors = analyzer::walk::Walk({"/nonexistent/walker/root"}, {}, paths);
+    paths.Close();
+
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_EQ(errors.front().path, "/nonexistent/walker/root");
+    EXPECT_EQ(errors.front().error.code, analyzer::ErrorCode::kIo);
+    EXPECT_FALSE(paths.Pop().has_value());
+}
+
+}  // namespace analyzer::tests
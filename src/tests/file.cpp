@@ -0,0 +1,74 @@
+#include "file.hpp"
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "analyse.hpp"
+#include "error.hpp"
+#include "metric.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+// Жив ли процесс; зомби, которого ещё не забрал init, считается завершённым
+bool Alive(pid_t pid) {
+    if (kill(pid, 0) != 0)
+        return false;
+    // Состояние — первое поле после имени процесса в скобках
+    std::string stat;
+    std::getline(std::ifstream("/proc/" + std::to_string(pid) + "/stat"), stat);
+    const auto name_end = stat.rfind(')');
+    return name_end == std::string::npos || stat.substr(name_end + 2, 1) != "Z";
+}
+
+}  // namespace
+
+TEST(FakeParser, TimeoutKillsWholeProcessGroup) {
+    const TempTree tree("parse_group_");
+    const auto pid_file = tree.Path("grandchild.pid");
+    // Оболочка запускает внука и ждёт его; имя файла приходит как $1
+    const ScopedParserCommand parser({"sh", "-c", "sleep 30 & echo $! > \"$1\"; wait", "sh"});
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto file = file::File::Open(pid_file.string(), std::string(), std::pmr::get_default_resource(),
+                                       {.timeout = std::chrono::milliseconds(300)});
+    ASSERT_FALSE(file);
+    EXPECT_EQ(file.error().code, ErrorCode::kTimeout);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(10));
+
+    pid_t grandchild = 0;
+    std::ifstream(pid_file) >> grandchild;
+    ASSERT_GT(grandchild, 0);
+    for (int attempt = 0; attempt < 100 && Alive(grandchild); ++attempt)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(Alive(grandchild));
+}
+
+TEST(FakeParser, BudgetClampsParseTimeout) {
+    const ScopedParserCommand parser({"sh", "-c", "sleep 30", "sh"});
+    const auto sample = SampleFile().string();
+    metric::MetricExtractor extractor;
+    AnalysisErrors errors;
+
+    // Таймаут файла больше бюджета: разбор обрывается по остатку бюджета, второй файл не начинается
+    const auto started = std::chrono::steady_clock::now();
+    const auto analysis =
+        AnalyseFunctions({sample, sample}, extractor, errors, std::pmr::get_default_resource(),
+                         {.parse = {.timeout = std::chrono::seconds(60)}, .budget = std::chrono::milliseconds(300)});
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(10));
+    EXPECT_TRUE(analysis.empty());
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0].error.code, ErrorCode::kTimeout);
+    EXPECT_EQ(errors[1].error.code, ErrorCode::kSkipped);
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,131 @@
+#include "file_watcher.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+bool Contains(const std::vector<std::string> &paths, const std::string &path) {
+    return std::ranges::find(paths, path) != paths.end();
+}
+
+}  // namespace
+
+TEST(FileWatcher, ReportsWrittenRenamedAndRemovedFilesOnce) {
+    TempTree tree("watch_test_");
+    const auto edited = tree.Write("edited.py", "x = 1\n");
+    const auto removed = tree.Write("removed.py", "y = 1\n");
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(tree.Root(), false).has_value());
+
+    // Сохранение через временный файл и rename, как в редакторах
+    tree.Write("edited.py.tmp", "x = 2\n");
+    std::filesystem::rename(edited + ".tmp", edited);
+    tree.Write("edited.py", "x = 3\n");
+    std::filesystem::remove(removed);
+
+    const auto changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_FALSE(changes->overflowed);
+    EXPECT_EQ(std::ranges::count(changes->paths, edited), 1);
+    EXPECT_TRUE(Contains(changes->paths, removed));
+}
+
+TEST(FileWatcher, RecursiveWatchFollowsNewDirectories) {
+    TempTree tree("watch_test_");
+    tree.Write("pkg/module.py", "a = 1\n");
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(tree.Root(), true).has_value());
+
+    const auto nested = tree.Write("pkg/module.py", "a = 2\n");
+    auto changes = (*watcher)->Wait(std::chrono::milliseconds(50));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_TRUE(Contains(changes->paths, nested));
+
+    const auto created = tree.Write("new/deep/file.py", "b = 1\n");
+    changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_TRUE(Contains(changes->paths, created));
+}
+
+TEST(FileWatcher, ReportsRemovedDirectory) {
+    TempTree tree("watch_test_");
+    tree.Write("pkg/sub/module.py", "a = 1\n");
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(tree.Root(), true).has_value());
+
+    const auto package = tree.Root() + "/pkg";
+    std::filesystem::remove_all(package);
+    const auto changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_TRUE(Contains(changes->removed_directories, package));
+}
+
+TEST(FileWatcher, ReportsDirectoryMovedOutAndStopsWatchingIt) {
+    TempTree tree("watch_test_");
+    TempTree outside("watch_outside_");
+    tree.Write("pkg/module.py", "a = 1\n");
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(tree.Root(), true).has_value());
+
+    const auto package = tree.Root() + "/pkg";
+    std::filesystem::rename(package, outside.Root() + "/pkg");
+    auto changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_TRUE(Contains(changes->removed_directories, package));
+
+    // Правка в унесённом каталоге не выдаётся за правку старого пути
+    outside.Write("pkg/module.py", "a = 2\n");
+    const auto marker = tree.Write("marker.py", "m = 1\n");
+    changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_EQ(changes->paths, std::vector<std::string>{marker});
+}
+
+TEST(FileWatcher, ReportsRemovedWatchedRoot) {
+    TempTree tree("watch_test_");
+    const auto root = tree.Root() + "/root";
+    std::filesystem::create_directories(root);
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(root, true).has_value());
+
+    std::filesystem::remove(root);
+    const auto changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_EQ(changes->removed_directories, std::vector<std::string>{root});
+}
+
+TEST(FileWatcher, DirectoryMovedWithinTreeIsWatchedUnderNewPath) {
+    TempTree tree("watch_test_");
+    tree.Write("old/sub/module.py", "a = 1\n");
+    auto watcher = watch::Watcher::Create();
+    ASSERT_TRUE(watcher.has_value()) << watcher.error().message;
+    ASSERT_TRUE((*watcher)->WatchDirectory(tree.Root(), true).has_value());
+
+    std::filesystem::rename(tree.Root() + "/old", tree.Root() + "/new");
+    auto changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_TRUE(Contains(changes->removed_directories, tree.Root() + "/old"));
+    EXPECT_TRUE(Contains(changes->paths, tree.Root() + "/new/sub/module.py"));
+
+    const auto edited = tree.Write("new/sub/module.py", "a = 2\n");
+    changes = (*watcher)->Wait(std::chrono::milliseconds(100));
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    EXPECT_EQ(changes->paths, std::vector<std::string>{edited});
+}
+
+}  // namespace analyzer::tests
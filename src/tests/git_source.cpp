@@ -0,0 +1,150 @@
+#include "git_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "error.hpp"
+#include "git_test_repo.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+TEST(GitSource, ListsPythonBlobsOfRevisionWithoutWorkingTree) {
+    TempGitRepo repo("git_source_list");
+    repo.Write("main.py", "print(1)\n");
+    repo.Write("pkg/module.py", "x = 1\n");
+    repo.Write("README.md", "readme\n");
+    const auto first = repo.Commit("first");
+    repo.Write("pkg/added.py", "y = 2\n");
+    repo.Remove("main.py");
+    repo.Commit("second");
+
+    const auto blobs = git::ListBlobs(first, {".py"}, repo.Root());
+    ASSERT_TRUE(blobs.has_value()) << blobs.error().message;
+    std::vector<std::string> paths;
+    std::ranges::transform(*blobs, std::back_inserter(paths), &git::BlobEntry::path);
+    EXPECT_EQ(paths, (std::vector<std::string>{"main.py", "pkg/module.py"}));
+    EXPECT_EQ(blobs->front().object_id, repo.Output("rev-parse " + first + ":main.py"));
+}
+
+TEST(GitSource, ReportsUnknownRevision) {
+    TempGitRepo repo("git_source_unknown");
+    repo.Write("main.py", "print(1)\n");
+    repo.Commit("first");
+
+    const auto blobs = git::ListBlobs("no-such-branch", {".py"}, repo.Root());
+    ASSERT_FALSE(blobs.has_value());
+    EXPECT_EQ(blobs.error().code, ErrorCode::kToolFailed);
+}
+
+TEST(GitSource, CatFileBatchStreamsObjectsFromOneProcess) {
+    TempGitRepo repo("git_source_cat");
+    const std::string binary("a\0b\nc", 5);
+    const std::string large(200000, 'z');
+    repo.Write("small.py", "def f():\n    pass\n");
+    repo.Write("binary.py", binary);
+    repo.Write("large.py", large);
+    repo.Write("empty.py", "");
+    const auto rev = repo.Commit("blobs");
+
+    auto objects = git::CatFileBatch::Start(repo.Root());
+    ASSERT_TRUE(objects.has_value()) << objects.error().message;
+    for (const auto &[path, content] : std::vector<std::pair<std::string, std::string>>{
+             {"small.py", "def f():\n    pass\n"}, {"binary.py", binary}, {"large.py", large}, {"empty.py", ""}}) {
+        const auto object = (*objects)->Read(repo.Output("rev-parse " + rev + ":" + path));
+        ASSERT_TRUE(object.has_value()) << object.error().message;
+        EXPECT_EQ(*object, content) << path;
+    }
+
+    const auto missing = (*objects)->Read(std::string(40, '0'));
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().code, ErrorCode::kIo);
+    EXPECT_EQ((*objects)->Read(repo.Output("rev-parse " + rev + ":small.py")).value_or(""), "def f():\n    pass\n");
+}
+
+TEST(GitSource, CatFileBatchReportsExitedGitAsError) {
+    // Не репозиторий: git cat-file сразу завершается, и запись в его stdin получает EPIPE, а не SIGPIPE
+    const TempTree directory("git_source_exited_");
+    auto objects = git::CatFileBatch::Start(directory.Root());
+    ASSERT_TRUE(objects.has_value()) << objects.error().message;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        const auto object = (*objects)->Read(std::string(40, '0'));
+        ASSERT_FALSE(object.has_value());
+        EXPECT_EQ(object.error().code, ErrorCode::kToolFailed);
+    }
+}
+
+TEST(GitSource, ChangedFilesParsesHunksOfWorkingTree) {
+    TempGitRepo repo("git_source_diff");
+    repo.Write("edit.py", "a\nb\nc\nd\ne\nf\n");
+    repo.Write("gone.py", "x\n");
+    repo.Write("old_name.py", "def f():\n    return 1\n\n\ndef g():\n    return 2\n");
+    repo.Write("notes.md", "text\n");
+    const auto base = repo.Commit("base");
+
+    repo.Write("edit.py", "a\nB\nc\ne\nf\ng\nh\n");  // Замена строки 2, удаление d, две новые в конце
+    repo.Remove("gone.py");
+    repo.Remove("old_name.py");
+    repo.Write("new_name.py", "def f():\n    return 1\n\n\ndef g():\n    return 3\n");
+    repo.Write("notes.md", "changed\n");
+    repo.Write("added.py", "y\n");
+    repo.Output("add -N added.py new_name.py");  // Неотслеживаемые файлы git diff не видит
+
+    const auto changes = git::ChangedFiles(base, {".py"}, repo.Root());
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    ASSERT_EQ(changes->size(), 3u);
+
+    const auto &added = (*changes)[0];
+    EXPECT_EQ(added.path, "added.py");
+    EXPECT_TRUE(added.base_object_id.empty());
+    ASSERT_EQ(added.lines.size(), 1u);
+    EXPECT_EQ(added.lines[0].first, 0u);
+    EXPECT_EQ(added.lines[0].last, 1u);
+
+    const auto &edit = (*changes)[1];
+    EXPECT_EQ(edit.path, "edit.py");
+    EXPECT_EQ(edit.base_path, "edit.py");
+    EXPECT_EQ(edit.base_object_id, repo.Output("rev-parse " + base + ":edit.py"));
+    std::vector<std::pair<std::size_t, std::size_t>> lines;
+    for (const auto &range : edit.lines)
+        lines.emplace_back(range.first, range.last);
+    // Удаление d отмечает соседние строки c и e, соприкасающиеся диапазоны сливаются
+    EXPECT_EQ(lines, (std::vector<std::pair<std::size_t, std::size_t>>{{1, 4}, {5, 7}}));
+
+    const auto &renamed = (*changes)[2];
+    EXPECT_EQ(renamed.path, "new_name.py");
+    EXPECT_EQ(renamed.base_path, "old_name.py");
+    EXPECT_EQ(renamed.base_object_id, repo.Output("rev-parse " + base + ":old_name.py"));
+    ASSERT_EQ(renamed.lines.size(), 1u);
+    EXPECT_EQ(renamed.lines[0].first, 5u);
+}
+
+TEST(GitSource, ChangedFilesAreRelativeToRepositoryArgument) {
+    TempGitRepo repo("git_source_diff_sub");
+    repo.Write("top.py", "a\n");
+    repo.Write("pkg/inner.py", "b\n");
+    const auto base = repo.Commit("base");
+    repo.Write("top.py", "A\n");
+
+    const auto changes = git::ChangedFiles(base, {".py"}, repo.Root() + "/pkg");
+    ASSERT_TRUE(changes.has_value()) << changes.error().message;
+    ASSERT_EQ(changes->size(), 1u);
+    EXPECT_EQ(changes->front().path, "../top.py");
+}
+
+TEST(GitSource, TempDirectoryIsRemoved) {
+    std::filesystem::path path;
+    {
+        auto directory = git::TempDirectory::Create("git_source_tmp-");
+        ASSERT_TRUE(directory.has_value());
+        path = directory->Path();
+        EXPECT_TRUE(std::filesystem::is_directory(path));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+}  // namespace analyzer::tests
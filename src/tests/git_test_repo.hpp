@@ -0,0 +1,75 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace analyzer::tests {
+
+// Временный git-репозиторий для тестов чтения ревизий
+class TempGitRepo {
+public:
+    explicit TempGitRepo(const std::string &name)
+        : root_(std::filesystem::temp_directory_path() / (name + "_" + std::to_string(getpid()))) {
+        std::filesystem::remove_all(root_);
+        std::filesystem::create_directories(root_);
+        Git("init -q");
+        Git("config user.email test@example.com");
+        Git("config user.name test");
+    }
+
+    ~TempGitRepo() { std::filesystem::remove_all(root_); }
+
+    void Write(const std::string &relative, const std::string &content) const {
+        const auto path = root_ / relative;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    void Copy(const std::filesystem::path &source, const std::string &relative) const {
+        const auto path = root_ / relative;
+        std::filesystem::create_directories(path.parent_path());
+        std::filesystem::copy_file(source, path, std::filesystem::copy_options::overwrite_existing);
+    }
+
+    void Remove(const std::string &relative) const { std::filesystem::remove(root_ / relative); }
+
+    // Коммитит всё рабочее дерево и возвращает id коммита
+    std::string Commit(const std::string &message) const {
+        Git("add -A");
+        Git("commit -q -m '" + message + "'");
+        return Output("rev-parse HEAD");
+    }
+
+    std::string Output(const std::string &args) const {
+        const std::string command = "git -C '" + Root() + "' " + args;
+        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
+        if (!pipe)
+            throw std::runtime_error("Failed to run " + command);
+        std::string output;
+        for (int ch; (ch = std::fgetc(pipe.get())) != EOF;)
+            output.push_back(static_cast<char>(ch));
+        while (!output.empty() && output.back() == '\n')
+            output.pop_back();
+        return output;
+    }
+
+    std::string Root() const { return root_.string(); }
+
+private:
+    void Git(const std::string &args) const {
+        const std::string command = "git -C '" + Root() + "' " + args + " >/dev/null 2>&1";
+        if (std::system(command.c_str()) != 0)
+            throw std::runtime_error("Command failed: " + command);
+    }
+
+    std::filesystem::path root_;
+};
+
+}  // namespace analyzer::tests
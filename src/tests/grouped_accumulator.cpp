@@ -0,0 +1,218 @@
+#include "grouped_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "function.hpp"
+#include "interner.hpp"
+#include "metric.hpp"
+#include "metric_accumulator_impl/sum_average_accumulator.hpp"
+#include "metric_accumulator_impl/top_k_accumulator.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+using SumAverageAccumulator = analyzer::metric_accumulator::metric_accumulator_impl::SumAverageAccumulator;
+using GroupedSumAverage = analyzer::metric_accumulator::GroupedAccumulator<SumAverageAccumulator>;
+using Entry = std::pair<analyzer::function::Function, analyzer::metric::MetricResults>;
+
+Entry MakeEntry(std::pmr::string filename, std::optional<std::pmr::string> class_name, int lines, int complexity) {
+    return Entry{analyzer::function::Function{.filename = std::move(filename),
+                                              .class_name = std::move(class_name),
+                                              .name = "func",
+                                              .ast = ""},
+                 {{.metric_name = "lines", .value = lines},
+                  {.metric_name = "ignored", .value = std::string("value")},
+                  {.metric_name = "complexity", .value = complexity}}};
+}
+
+std::vector<Entry> SampleAnalysis() {
+    return {MakeEntry("a.py", "Alpha", 4, 1), MakeEntry("a.py", std::nullopt, 6, 2),
+            MakeEntry("b.py", "Beta", 10, 3), MakeEntry("a.py", "Alpha", 2, 5)};
+}
+
+GroupedSumAverage BuildAccumulator() {
+    return GroupedSumAverage({"lines", "complexity"},
+                             {analyzer::metric_accumulator::GlobalLevel(), analyzer::metric_accumulator::FileLevel(),
+                              analyzer::metric_accumulator::ClassLevel()});
+}
+
+}  // namespace
+
+TEST(GroupedAccumulator, FillsAllLevelsInOnePass) {
+    auto accumulator = BuildAccumulator();
+    const auto analysis = SampleAnalysis();
+    accumulator.Accumulate(analysis);
+
+    ASSERT_EQ(accumulator.GetGroups(0).size(), 1u);
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(0, 0, 0).Get().sum, 22);
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(0, 0, 1).Get().sum, 11);
+
+    const auto &files = accumulator.GetGroups(1);
+    ASSERT_EQ(files.size(), 2u);
+    EXPECT_EQ(files[0].key, analyzer::interner::Intern("a.py"));
+    EXPECT_EQ(files[1].key, analyzer::interner::Intern("b.py"));
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(1, 0, 0).Get().sum, 12);
+    EXPECT_DOUBLE_EQ(accumulator.GetFinalizedAccumulator(1, 0, 0).Get().average, 4.0);
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(1, 1, 1).Get().sum, 3);
+}
+
+TEST(GroupedAccumulator, ClassLevelSkipsFreeFunctions) {
+    auto accumulator = BuildAccumulator();
+    const auto analysis = SampleAnalysis();
+    accumulator.Accumulate(analysis);
+
+    const auto &classes = accumulator.GetGroups(2);
+    ASSERT_EQ(classes.size(), 2u);
+    EXPECT_EQ(classes[0].representative, &analysis[0].first);
+    EXPECT_EQ(classes[1].representative, &analysis[2].first);
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(2, 0, 0).Get().sum, 6);
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(2, 0, 1).Get().sum, 6);
+}
+
+TEST(GroupedAccumulator, SupportsCompositeKeys) {
+    using analyzer::metric_accumulator::GroupingLevel;
+    GroupingLevel by_file_and_kind{
+        .name = "file_and_kind", .build_key = [](const analyzer::function::Function &func, GroupingLevel::Key &key) {
+            key = analyzer::interner::CombineIds(func.filename.Id(), func.class_name ? 1 : 0);
+            return true;
+        }};
+    GroupedSumAverage accumulator({"lines"}, {by_file_and_kind});
+    const auto analysis = SampleAnalysis();
+    accumulator.Accumulate(analysis);
+
+    const auto &groups = accumulator.GetGroups(0);
+    ASSERT_EQ(groups.size(), 3u);
+    EXPECT_EQ(groups[0].key, analyzer::interner::CombineIds(analyzer::interner::Intern("a.py"), 1));
+    EXPECT_EQ(groups[1].key, analyzer::interner::CombineIds(analyzer::interner::Intern("a.py"), 0));
+    EXPECT_EQ(groups[2].key, analyzer::interner::CombineIds(analyzer::interner::Intern("b.py"), 1));
+}
+
+TEST(GroupedAccumulator, ResetDropsGroups) {
+    auto accumulator = BuildAccumulator();
+    accumulator.Accumulate(SampleAnalysis());
+    accumulator.GetFinalizedAccumulator(0, 0, 0);
+    accumulator.Reset();
+
+    EXPECT_TRUE(accumulator.GetGroups(0).empty());
+    EXPECT_THROW(accumulator.GetFinalizedAccumulator(0, 0, 0), std::out_of_range);
+}
+
+TEST(GroupedAccumulator, RejectsEmptyMetricList) {
+    EXPECT_THROW(GroupedSumAverage({}, {analyzer::metric_accumulator::GlobalLevel()}), std::invalid_argument);
+}
+
+TEST(GroupedAccumulator, MergeMatchesSerialAccumulation) {
+    const auto analysis = SampleAnalysis();
+    const std::vector<Entry> head(analysis.begin(), analysis.begin() + 2);
+    const std::vector<Entry> tail(analysis.begin() + 2, analysis.end());
+
+    auto serial = BuildAccumulator();
+    auto left = BuildAccumulator();
+    auto right = BuildAccumulator();
+    serial.Accumulate(analysis);
+    left.Accumulate(head);
+    right.Accumulate(tail);
+    left.Merge(right);
+
+    for (std::size_t level = 0; level < serial.LevelsCount(); ++level) {
+        ASSERT_EQ(left.GetGroups(level).size(), serial.GetGroups(level).size());
+        for (std::size_t group = 0; group < serial.GetGroups(level).size(); ++group) {
+            EXPECT_EQ(left.GetGroups(level)[group].key, serial.GetGroups(level)[group].key);
+            for (std::size_t metric = 0; metric < serial.GetMetricNames().size(); ++metric)
+                EXPECT_EQ(left.GetFinalizedAccumulator(level, group, metric).Get(),
+                          serial.GetFinalizedAccumulator(level, group, metric).Get());
+        }
+    }
+}
+
+TEST(GroupedAccumulator, RejectsMergeWithItself) {
+    auto accumulator = BuildAccumulator();
+    accumulator.Accumulate(SampleAnalysis());
+    EXPECT_THROW(accumulator.Merge(accumulator), std::invalid_argument);
+}
+
+TEST(GroupedAccumulator, RetractThenAddMatchesFreshAccumulation) {
+    const auto analysis = SampleAnalysis();
+    const std::vector<Entry> old_a(analysis.begin(), analysis.begin() + 2);
+    const std::vector<Entry> b(analysis.begin() + 2, analysis.begin() + 3);
+    const std::vector<Entry> new_a = {MakeEntry("a.py", std::nullopt, 9, 4)};
+
+    auto live = BuildAccumulator();
+    live.Accumulate(old_a);
+    live.Accumulate(b);
+    live.Retract(old_a);
+    live.Accumulate(new_a);
+
+    auto fresh = BuildAccumulator();
+    fresh.Accumulate(new_a);
+    fresh.Accumulate(b);
+
+    EXPECT_EQ(live.GetFinalizedCopy(0, 0, 0).Get(), fresh.GetFinalizedCopy(0, 0, 0).Get());
+    EXPECT_EQ(live.GetGroups(0)[0].functions, 2u);
+    for (const auto &[func, results] : new_a) {
+        const auto key = func.filename.Id();
+        const auto live_group = live.FindGroup(1, key);
+        const auto fresh_group = fresh.FindGroup(1, key);
+        ASSERT_TRUE(live_group && fresh_group);
+        EXPECT_EQ(live.GetGroups(1)[*live_group].representative, &new_a.front().first);
+        for (std::size_t metric = 0; metric < 2; ++metric)
+            EXPECT_EQ(live.GetFinalizedCopy(1, *live_group, metric).Get(),
+                      fresh.GetFinalizedCopy(1, *fresh_group, metric).Get());
+    }
+
+    // Класс Alpha был только в старой версии a.py: группа остаётся, но пустая
+    const auto alpha = live.FindGroup(2, analyzer::interner::CombineIds(analyzer::interner::Intern("a.py"),
+                                                                        analyzer::interner::Intern("Alpha")));
+    ASSERT_TRUE(alpha.has_value());
+    EXPECT_EQ(live.GetGroups(2)[*alpha].functions, 0u);
+    EXPECT_EQ(live.GetGroups(2)[*alpha].representative, nullptr);
+    EXPECT_THROW(BuildAccumulator().Retract(new_a), std::invalid_argument);
+}
+
+TEST(GroupedAccumulator, MergeSkipsGroupsEmptiedByRetract) {
+    const auto analysis = SampleAnalysis();
+    const std::vector<Entry> a(analysis.begin(), analysis.begin() + 2);
+    const std::vector<Entry> b(analysis.begin() + 2, analysis.begin() + 3);
+
+    auto retracted = BuildAccumulator();
+    retracted.Accumulate(a);
+    retracted.Retract(a);
+
+    auto merged = BuildAccumulator();
+    merged.Accumulate(b);
+    merged.Merge(retracted);
+    auto fresh = BuildAccumulator();
+    fresh.Accumulate(b);
+    for (std::size_t level = 0; level < fresh.LevelsCount(); ++level)
+        EXPECT_EQ(merged.GetGroups(level).size(), fresh.GetGroups(level).size());
+
+    // Обратный порядок: пустые группы остаются, но получают представителя из other
+    retracted.Merge(fresh);
+    EXPECT_EQ(retracted.GetGroups(0)[0].functions, 1u);
+    EXPECT_EQ(retracted.GetGroups(0)[0].representative, &b.front().first);
+    EXPECT_EQ(retracted.GetFinalizedCopy(0, 0, 0).Get(), fresh.GetFinalizedCopy(0, 0, 0).Get());
+}
+
+TEST(GroupedAccumulator, BatchesKeepSourceFunctions) {
+    using TopKAccumulator = analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+    analyzer::metric_accumulator::GroupedAccumulator<TopKAccumulator> accumulator(
+        {"lines"}, {analyzer::metric_accumulator::FileLevel()});
+    const auto analysis = SampleAnalysis();
+    accumulator.Accumulate(analysis);
+
+    // Топ-K получает значения пачкой вместе с функциями: по умолчанию в топе все функции файла
+    const auto &top = accumulator.GetFinalizedAccumulator(0, 0, 0).Get();
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top.front().value, 6);
+    EXPECT_EQ(top.front().function.qualified_name, "func");
+    EXPECT_EQ(top.back().function.filename, "a.py");
+}
+
+}  // namespace analyzer::tests
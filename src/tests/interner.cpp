@@ -0,0 +1,81 @@
+#include "interner.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace analyzer::tests {
+
+namespace {
+
+using analyzer::interner::InternedString;
+using analyzer::interner::StringId;
+
+std::vector<StringId> InternRange(int begin, int end) {
+    std::vector<StringId> ids;
+    for (int i = begin; i < end; ++i)
+        ids.push_back(analyzer::interner::Intern("interner_test_" + std::to_string(i)));
+    return ids;
+}
+
+}  // namespace
+
+TEST(Interner, SameStringGetsSameIdAndStableView) {
+    std::string value = "interner_same.py";
+    const auto id = analyzer::interner::Intern(value);
+    const auto view = analyzer::interner::Lookup(id);
+    value.assign("something else");
+
+    EXPECT_EQ(analyzer::interner::Intern("interner_same.py"), id);
+    EXPECT_EQ(analyzer::interner::Lookup(id), "interner_same.py");
+    EXPECT_EQ(view.data(), analyzer::interner::Lookup(id).data());
+}
+
+TEST(Interner, EmptyStringHasIdZero) {
+    EXPECT_EQ(analyzer::interner::Intern(""), 0u);
+    EXPECT_EQ(analyzer::interner::Lookup(0), "");
+    EXPECT_EQ(InternedString{}, InternedString(""));
+}
+
+TEST(Interner, FindDoesNotIntern) {
+    EXPECT_FALSE(analyzer::interner::Find("interner_never_interned").has_value());
+    const auto id = analyzer::interner::Intern("interner_found");
+    EXPECT_EQ(analyzer::interner::Find("interner_found"), id);
+}
+
+TEST(Interner, LookupRejectsUnknownId) {
+    EXPECT_THROW(analyzer::interner::Lookup(0xFFFFFFF0u), std::out_of_range);
+}
+
+TEST(Interner, ConcurrentInterningAgreesOnIds) {
+    constexpr int kStrings = 2000;
+    auto first = std::async(std::launch::async, [] { return InternRange(0, kStrings); });
+    auto second = std::async(std::launch::async, [] { return InternRange(0, kStrings); });
+    const auto left = first.get();
+    const auto right = second.get();
+
+    EXPECT_EQ(left, right);
+    EXPECT_EQ(std::unordered_set<StringId>(left.begin(), left.end()).size(), static_cast<std::size_t>(kStrings));
+    for (int i = 0; i < kStrings; ++i)
+        EXPECT_EQ(analyzer::interner::Lookup(left[i]), "interner_test_" + std::to_string(i));
+}
+
+TEST(Interner, InternedStringComparesAndHashesById) {
+    const InternedString a("interner_a.py");
+    const InternedString b(std::string("interner_a.py"));
+    const InternedString c(std::string_view("interner_c.py"));
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.View(), "interner_a.py");
+    EXPECT_EQ(std::hash<InternedString>{}(a), std::hash<InternedString>{}(b));
+    EXPECT_EQ(std::unordered_set<InternedString>({a, b, c}).size(), 2u);
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,77 @@
+#include "live_analysis.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "analyse.hpp"
+#include "grouped_accumulator.hpp"
+#include "interner.hpp"
+#include "metric.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+const std::vector<std::string> kMetrics = {"code_lines_count", "cyclomatic_complexity"};
+
+// Сводные метрики живого состояния совпадают с полным анализом текущих файлов с нуля
+void ExpectMatchesFreshAnalysis(const LiveAnalysis &live, const std::vector<std::string> &files,
+                                const analyzer::metric::MetricExtractor &extractor) {
+    AnalysisErrors errors;
+    const auto analysis = AnalyseFunctions(files, extractor, errors);
+    ASSERT_TRUE(errors.empty());
+    LiveAnalysis::Aggregates fresh(kMetrics, {metric_accumulator::GlobalLevel(), metric_accumulator::FileLevel(),
+                                              metric_accumulator::ClassLevel()});
+    fresh.Accumulate(analysis);
+
+    const auto &aggregates = live.GetAggregates();
+    for (std::size_t metric = 0; metric < kMetrics.size(); ++metric) {
+        EXPECT_EQ(aggregates.GetFinalizedCopy(LiveAnalysis::kGlobalLevel, 0, metric).Get(),
+                  fresh.GetFinalizedCopy(LiveAnalysis::kGlobalLevel, 0, metric).Get());
+        for (const auto &file : files) {
+            const auto key = interner::Intern(file);
+            const auto live_group = aggregates.FindGroup(LiveAnalysis::kFileLevel, key);
+            const auto fresh_group = fresh.FindGroup(LiveAnalysis::kFileLevel, key);
+            ASSERT_TRUE(live_group && fresh_group) << file;
+            EXPECT_EQ(aggregates.GetFinalizedCopy(LiveAnalysis::kFileLevel, *live_group, metric).Get(),
+                      fresh.GetFinalizedCopy(LiveAnalysis::kFileLevel, *fresh_group, metric).Get());
+        }
+    }
+}
+
+}  // namespace
+
+TEST(LiveAnalysis, UpdateRetractsOldResultsAndAddsNewOnes) {
+    const TempTree tree("live_analysis_");
+    const auto first = tree.Path("first.py").string();
+    const auto second = tree.Path("second.py").string();
+    std::filesystem::copy_file(SampleFile("analysis_sample_one.py"), first,
+                               std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::copy_file(SampleFile("analysis_sample_two.py"), second,
+                               std::filesystem::copy_options::overwrite_existing);
+
+    const auto extractor = BuildExtractor();
+    LiveAnalysis live(extractor, kMetrics);
+    live.Load({first, second}, 2);
+    ASSERT_EQ(live.FilesCount(), 2u);
+    ExpectMatchesFreshAnalysis(live, {first, second}, extractor);
+
+    // Первый файл получает содержимое второго: функции класса Alpha исчезают
+    std::filesystem::copy_file(SampleFile("analysis_sample_two.py"), first,
+                               std::filesystem::copy_options::overwrite_existing);
+    ASSERT_TRUE(live.Update(first));
+    ExpectMatchesFreshAnalysis(live, {first, second}, extractor);
+    EXPECT_EQ(live.Find(first)->analysis.size(), live.Find(second)->analysis.size());
+
+    std::filesystem::remove(second);
+    ASSERT_TRUE(live.Update(second));
+    EXPECT_EQ(live.Find(second), nullptr);
+    ExpectMatchesFreshAnalysis(live, {first}, extractor);
+    EXPECT_FALSE(live.Update(second));
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,203 @@
+#include "metric_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "function.hpp"
+#include "metric.hpp"
+#include "metric_accumulator_impl/accumulators.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+using analyzer::metric_accumulator::MetricsAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::CategoricalAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::SumAverageAccumulator;
+
+MetricsAccumulator BuildAccumulator() {
+    MetricsAccumulator accumulator;
+    accumulator.RegisterAccumulator("lines", std::make_unique<SumAverageAccumulator>());
+    accumulator.RegisterAccumulator("style", std::make_unique<CategoricalAccumulator>());
+    return accumulator;
+}
+
+analyzer::metric::MetricResults MakeResults(int lines, std::string style) {
+    return {{.metric_name = "lines", .value = lines}, {.metric_name = "style", .value = std::move(style)}};
+}
+
+// Запоминает значения в порядке поступления
+struct RecordingAccumulator : analyzer::metric_accumulator::IAccumulator {
+    std::vector<std::string> seen;
+
+    void Accumulate(const analyzer::metric::MetricResult &metric_result) override {
+        if (const auto *value = std::get_if<int>(&metric_result.value))
+            seen.push_back(std::to_string(*value));
+        else
+            seen.push_back(std::get<std::string>(metric_result.value));
+    }
+    void Finalize() override { is_finalized = true; }
+    void Reset() override { seen.clear(); }
+};
+
+}  // namespace
+
+TEST(MetricsAccumulator, MergeMatchesSerialAccumulation) {
+    auto serial = BuildAccumulator();
+    auto left = BuildAccumulator();
+    auto right = BuildAccumulator();
+
+    const std::vector<analyzer::metric::MetricResults> head = {MakeResults(3, "snake"), MakeResults(5, "camel")};
+    const std::vector<analyzer::metric::MetricResults> tail = {MakeResults(8, "snake")};
+    for (const auto &results : head) {
+        serial.AccumulateNextFunctionResults(results);
+        left.AccumulateNextFunctionResults(results);
+    }
+    for (const auto &results : tail) {
+        serial.AccumulateNextFunctionResults(results);
+        right.AccumulateNextFunctionResults(results);
+    }
+    left.Merge(right);
+
+    EXPECT_EQ(left.GetFinalizedAccumulator<SumAverageAccumulator>("lines").Get(),
+              serial.GetFinalizedAccumulator<SumAverageAccumulator>("lines").Get());
+    EXPECT_EQ(left.GetFinalizedAccumulator<CategoricalAccumulator>("style").Get(),
+              serial.GetFinalizedAccumulator<CategoricalAccumulator>("style").Get());
+}
+
+TEST(MetricsAccumulator, BatchMatchesRowAccumulation) {
+    auto rows = BuildAccumulator();
+    auto batch = BuildAccumulator();
+    const std::vector<analyzer::metric::MetricResults> results = {MakeResults(3, "snake"), MakeResults(5, "camel"),
+                                                                  MakeResults(8, "snake")};
+    for (const auto &function_results : results)
+        rows.AccumulateNextFunctionResults(function_results);
+    batch.AccumulateFunctionResultsBatch(results);
+
+    EXPECT_EQ(batch.GetFinalizedAccumulator<SumAverageAccumulator>("lines").Get(),
+              rows.GetFinalizedAccumulator<SumAverageAccumulator>("lines").Get());
+    EXPECT_EQ(batch.GetFinalizedAccumulator<CategoricalAccumulator>("style").Get(),
+              rows.GetFinalizedAccumulator<CategoricalAccumulator>("style").Get());
+}
+
+TEST(MetricsAccumulator, BatchKeepsOrderOfMixedValues) {
+    MetricsAccumulator rows;
+    MetricsAccumulator batch;
+    const auto rows_handle = rows.RegisterAccumulator("mixed", std::make_unique<RecordingAccumulator>());
+    const auto batch_handle = batch.RegisterAccumulator("mixed", std::make_unique<RecordingAccumulator>());
+    using Value = analyzer::metric::MetricResult::ValueType;
+    std::vector<analyzer::metric::MetricResults> results;
+    for (const Value &value : {Value(1), Value(2), Value("a"), Value(3), Value("b"), Value(4)})
+        results.push_back({{.metric_name = "mixed", .value = value}});
+
+    for (const auto &function_results : results)
+        rows.AccumulateNextFunctionResults(function_results);
+    batch.AccumulateFunctionResultsBatch(results);
+
+    EXPECT_EQ(batch.GetFinalizedAccumulator(batch_handle).seen,
+              (std::vector<std::string>{"1", "2", "a", "3", "b", "4"}));
+    EXPECT_EQ(batch.GetFinalizedAccumulator(batch_handle).seen, rows.GetFinalizedAccumulator(rows_handle).seen);
+}
+
+TEST(MetricsAccumulator, FunctionBatchFeedsTopK) {
+    using analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+    MetricsAccumulator rows;
+    MetricsAccumulator batch;
+    const auto rows_handle = rows.RegisterAccumulator("lines", std::make_unique<TopKAccumulator>(2));
+    const auto batch_handle = batch.RegisterAccumulator("lines", std::make_unique<TopKAccumulator>(2));
+    std::vector<std::pair<analyzer::function::Function, analyzer::metric::MetricResults>> analysis;
+    for (const auto &[name, lines] : {std::pair{"a", 4}, {"b", 9}, {"c", 1}, {"d", 7}})
+        analysis.emplace_back(
+            analyzer::function::Function{.filename = "a.py", .class_name = std::nullopt, .name = name, .ast = ""},
+            MakeResults(lines, "snake"));
+
+    for (const auto &[function, function_results] : analysis)
+        rows.AccumulateNextFunctionResults(function, function_results);
+    batch.AccumulateFunctionAnalysisBatch(analysis);
+
+    const auto names = [](const TopKAccumulator &accumulator) {
+        std::vector<std::string> result;
+        for (const auto &entry : accumulator.Get())
+            result.push_back(entry.function.qualified_name);
+        return result;
+    };
+    EXPECT_EQ(names(batch.GetFinalizedAccumulator(batch_handle)), (std::vector<std::string>{"b", "d"}));
+    EXPECT_EQ(names(batch.GetFinalizedAccumulator(batch_handle)), names(rows.GetFinalizedAccumulator(rows_handle)));
+}
+
+TEST(MetricsAccumulator, MergeRejectsDifferentMetricSets) {
+    auto accumulator = BuildAccumulator();
+    MetricsAccumulator other;
+    other.RegisterAccumulator("lines", std::make_unique<SumAverageAccumulator>());
+
+    EXPECT_THROW(accumulator.Merge(other), std::invalid_argument);
+}
+
+TEST(MetricsAccumulator, MergeTreeCombinesAllPartials) {
+    std::vector<MetricsAccumulator> partials;
+    for (int worker = 0; worker < 5; ++worker) {
+        partials.push_back(BuildAccumulator());
+        partials.back().AccumulateNextFunctionResults(MakeResults(worker + 1, "snake"));
+    }
+
+    analyzer::metric_accumulator::MergeTree(partials);
+
+    const auto lines = partials.front().GetFinalizedAccumulator<SumAverageAccumulator>("lines").Get();
+    EXPECT_EQ(lines.sum, 15);
+    EXPECT_DOUBLE_EQ(lines.average, 3.0);
+    EXPECT_EQ(partials.front().GetFinalizedAccumulator<CategoricalAccumulator>("style").Get().at("snake"), 5);
+}
+
+TEST(MetricsAccumulator, RegisterReturnsTypedHandle) {
+    MetricsAccumulator accumulator;
+    const auto handle = accumulator.RegisterAccumulator("lines", std::make_unique<SumAverageAccumulator>());
+    EXPECT_EQ(handle.metric_id, analyzer::metric::RegisterMetricName("lines"));
+
+    accumulator.AccumulateNextFunctionResults(MakeResults(4, "snake"));
+    accumulator.AccumulateNextFunctionResults(MakeResults(6, "snake"));
+
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(handle).Get().sum, 10);
+}
+
+TEST(MetricsAccumulator, UsesMetricIdOfResults) {
+    MetricsAccumulator accumulator;
+    const auto handle = accumulator.RegisterAccumulator("lines", std::make_unique<SumAverageAccumulator>());
+
+    analyzer::metric::MetricResults results = {
+        {.metric_name = "renamed", .metric_id = handle.metric_id, .value = 7}};
+    accumulator.AccumulateNextFunctionResults(results);
+
+    EXPECT_EQ(accumulator.GetFinalizedAccumulator(handle).Get().sum, 7);
+}
+
+TEST(MetricsAccumulator, NamedLookupChecksType) {
+    auto accumulator = BuildAccumulator();
+
+    EXPECT_THROW(accumulator.GetFinalizedAccumulator<CategoricalAccumulator>("lines"), std::runtime_error);
+    EXPECT_THROW(accumulator.GetFinalizedAccumulator<SumAverageAccumulator>("missing_metric"), std::out_of_range);
+}
+
+TEST(MetricsAccumulator, PassesSourceFunctionToAccumulators) {
+    using analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+    MetricsAccumulator accumulator;
+    const auto handle = accumulator.RegisterAccumulator("lines", std::make_unique<TopKAccumulator>(1));
+
+    using analyzer::function::Function;
+    const Function small{.filename = "a.py", .class_name = std::nullopt, .name = "small", .ast = ""};
+    const Function big{.filename = "a.py", .class_name = "Service", .name = "big", .ast = ""};
+    accumulator.AccumulateNextFunctionResults(small, MakeResults(2, "snake"));
+    accumulator.AccumulateNextFunctionResults(big, MakeResults(9, "snake"));
+
+    const auto &top = accumulator.GetFinalizedAccumulator(handle).Get();
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top.front().function.qualified_name, "Service.big");
+}
+
+}  // namespace analyzer::tests
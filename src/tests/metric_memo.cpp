@@ -0,0 +1,152 @@
+#include "metric_memo.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "function.hpp"
+#include "metric.hpp"
+#include "result_cache.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+constexpr std::string_view kTopLevelAst =
+    "(function_definition [0, 0] - [2, 12]\n"
+    "  name: (identifier [0, 4] - [0, 7])\n"
+    "  parameters: (parameters [0, 7] - [0, 10]\n"
+    "    (identifier [0, 8] - [0, 9]))\n"
+    "  body: (block [1, 4] - [2, 12]\n"
+    "    (if_statement [1, 4] - [2, 12])))";
+
+// То же тело методом класса: другие строки и на два уровня глубже
+constexpr std::string_view kMethodAst =
+    "(function_definition [10, 4] - [12, 16]\n"
+    "      name: (identifier [10, 8] - [10, 11])\n"
+    "      parameters: (parameters [10, 11] - [10, 14]\n"
+    "        (identifier [10, 12] - [10, 13]))\n"
+    "      body: (block [11, 8] - [12, 16]\n"
+    "        (if_statement [11, 8] - [12, 16])))";
+
+// Считает вызовы, значение — число строк AST
+class CountingMetric final : public metric::IMetric {
+public:
+    CountingMetric(std::string name, bool structural) : name_(std::move(name)), structural_(structural) {}
+
+    bool IsStructural() const override { return structural_; }
+    int Calls() const { return calls_.load(); }
+
+protected:
+    Expected<metric::MetricResult::ValueType> CalculateImpl(const function::Function &f) const override {
+        ++calls_;
+        return static_cast<int>(std::ranges::count(f.ast, '\n'));
+    }
+    std::string Name() const override { return name_; }
+
+private:
+    std::string name_;
+    bool structural_;
+    mutable std::atomic<int> calls_{0};
+};
+
+function::Function MakeFunction(std::string_view filename, std::string_view ast) {
+    return function::Function{
+        .filename = filename, .class_name = std::nullopt, .name = "f", .ast = std::pmr::string(ast)};
+}
+
+}  // namespace
+
+TEST(MetricMemo, NormalizedHashIgnoresPositionsAndNesting) {
+    EXPECT_EQ(metric::NormalizedAstHash(kTopLevelAst), metric::NormalizedAstHash(kMethodAst));
+
+    std::string other_structure(kTopLevelAst);
+    other_structure.replace(other_structure.find("if_statement"), 12, "for_statement");
+    EXPECT_NE(metric::NormalizedAstHash(kTopLevelAst), metric::NormalizedAstHash(other_structure));
+
+    // Вложенность относительно функции сохраняется: блок на уровне параметров — другое дерево
+    std::string flattened(kTopLevelAst);
+    flattened.replace(flattened.find("    (if_statement"), 4, "  ");
+    EXPECT_NE(metric::NormalizedAstHash(kTopLevelAst), metric::NormalizedAstHash(flattened));
+}
+
+TEST(MetricMemo, DuplicateBodiesSkipStructuralMetrics) {
+    auto structural = std::make_unique<CountingMetric>("memo_test_structural", true);
+    auto positional = std::make_unique<CountingMetric>("memo_test_positional", false);
+    const auto *structural_metric = structural.get();
+    const auto *positional_metric = positional.get();
+    metric::MetricExtractor extractor;
+    extractor.RegisterMetric(std::move(positional));
+    extractor.RegisterMetric(std::move(structural));
+    metric::MetricMemo memo;
+    extractor.memo = &memo;
+
+    std::vector<metric::MetricError> errors;
+    const auto first = extractor.Get(MakeFunction("a.py", kTopLevelAst), std::pmr::get_default_resource(), errors);
+    const auto second = extractor.Get(MakeFunction("b.py", kMethodAst), std::pmr::get_default_resource(), errors);
+    ASSERT_TRUE(errors.empty());
+    EXPECT_EQ(structural_metric->Calls(), 1);
+    EXPECT_EQ(positional_metric->Calls(), 2);
+    EXPECT_EQ(memo.Hits(), 1u);
+    EXPECT_EQ(memo.Misses(), 1u);
+
+    // Порядок результатов — порядок регистрации, как и без memo
+    ASSERT_EQ(second.size(), 2u);
+    EXPECT_EQ(second[0].metric_name, positional_metric->MetricName());
+    EXPECT_EQ(second[1].metric_name, structural_metric->MetricName());
+    EXPECT_EQ(second[1].value, first[1].value);
+    EXPECT_EQ(second[1].metric_id, structural_metric->Id());
+}
+
+TEST(MetricMemo, SavedMemoIsReusedByNextRun) {
+    auto structural = std::make_unique<CountingMetric>("memo_test_persisted", true);
+    const auto *structural_metric = structural.get();
+    metric::MetricExtractor extractor;
+    extractor.RegisterMetric(std::move(structural));
+
+    const TempTree tree("metric_memo_");
+    const auto path = tree.Path("memo");
+    std::vector<metric::MetricError> errors;
+    {
+        metric::MetricMemo memo;
+        extractor.memo = &memo;
+        extractor.Get(MakeFunction("a.py", kTopLevelAst), std::pmr::get_default_resource(), errors);
+        ASSERT_TRUE(cache::SaveMemo(memo, path));
+    }
+
+    metric::MetricMemo memo;
+    ASSERT_TRUE(cache::LoadMemo(path, memo));
+    EXPECT_EQ(memo.Size(), 1u);
+    extractor.memo = &memo;
+    const auto results = extractor.Get(MakeFunction("b.py", kMethodAst), std::pmr::get_default_resource(), errors);
+    EXPECT_EQ(structural_metric->Calls(), 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].value, metric::MetricResult::ValueType(5));
+
+    std::filesystem::remove(path);
+    EXPECT_FALSE(cache::LoadMemo(path, memo));
+}
+
+TEST(MetricMemo, CapacityBoundsEntries) {
+    metric::MetricMemo memo(32);
+    // Старшие биты ключа выбирают шард: ключи расходятся по всем шардам
+    for (std::uint64_t i = 0; i < 1000; ++i)
+        memo.Store(i * 0x9e3779b97f4a7c15ull, {});
+    EXPECT_EQ(memo.Size(), 32u);
+
+    metric::MetricMemo unbounded;
+    for (std::uint64_t i = 0; i < 1000; ++i)
+        unbounded.Store(i * 0x9e3779b97f4a7c15ull, {});
+    EXPECT_EQ(unbounded.Size(), 1000u);
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,94 @@
+#include "path_list.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "path_queue.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+class Pipe {
+public:
+    Pipe() { EXPECT_EQ(::pipe(fds_), 0); }
+
+    ~Pipe() {
+        CloseWriter();
+        ::close(fds_[0]);
+    }
+
+    void Write(std::string_view data) { EXPECT_EQ(::write(fds_[1], data.data(), data.size()), data.size()); }
+
+    void CloseWriter() {
+        if (fds_[1] >= 0)
+            ::close(fds_[1]);
+        fds_[1] = -1;
+    }
+
+    int Reader() const { return fds_[0]; }
+
+private:
+    int fds_[2] = {-1, -1};
+};
+
+std::vector<std::string> Drain(PathQueue &paths) {
+    paths.Close();
+    std::vector<std::string> result;
+    while (auto path = paths.Pop())
+        result.push_back(std::move(path->path));
+    return result;
+}
+
+std::vector<std::string> ReadAll(std::string_view data) {
+    Pipe pipe;
+    pipe.Write(data);
+    pipe.CloseWriter();
+    PathQueue paths;
+    EXPECT_TRUE(input::ReadPathList(pipe.Reader(), paths).has_value());
+    return Drain(paths);
+}
+
+}  // namespace
+
+TEST(PathListTest, SplitsNewlineSeparatedList) {
+    EXPECT_EQ(ReadAll("a.py\n\nsrc/b.py\r\nc d.py"), (std::vector<std::string>{"a.py", "src/b.py", "c d.py"}));
+}
+
+TEST(PathListTest, SplitsNulSeparatedList) {
+    using namespace std::string_view_literals;
+    EXPECT_EQ(ReadAll("a.py\0with\nnewline.py\0b.py\0"sv),
+              (std::vector<std::string>{"a.py", "with\nnewline.py", "b.py"}));
+}
+
+TEST(PathListTest, PushesPathsBeforeInputEnds) {
+    Pipe pipe;
+    PathQueue paths;
+    std::jthread reader([&] { EXPECT_EQ(input::ReadPathList(pipe.Reader(), paths).value_or(0), 2u); });
+
+    pipe.Write("first.py\n");
+    const auto first = paths.Pop();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->path, "first.py");
+    EXPECT_EQ(first->index, 0u);
+
+    pipe.Write("second.py");
+    pipe.CloseWriter();
+    reader.join();
+    EXPECT_EQ(Drain(paths), std::vector<std::string>{"second.py"});
+}
+
+TEST(PathListTest, ReportsMissingListFile) {
+    PathQueue paths;
+    const auto result = input::ReadPathList(std::string("no_such_list.txt"), paths);
+
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, ErrorCode::kIo);
+}
+
+}  // namespace analyzer::tests
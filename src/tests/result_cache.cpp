@@ -0,0 +1,102 @@
+#include "result_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "metric.hpp"
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+cache::CachedFile SampleCachedFile() {
+    cache::CachedFile file;
+    file.functions.push_back({.class_name = "Parser",
+                              .name = "parse",
+                              .metrics = {{.metric_name = "cyclomatic_complexity", .value = 7},
+                                          {.metric_name = "naming", .value = std::string("snake\ncase 2")}}});
+    file.functions.push_back({.class_name = std::nullopt,
+                              .name = "main",
+                              .metrics = {{.metric_name = "cyclomatic_complexity", .value = -1}}});
+    return file;
+}
+
+void ExpectSameFile(const cache::CachedFile &actual, const cache::CachedFile &expected) {
+    ASSERT_EQ(actual.functions.size(), expected.functions.size());
+    for (std::size_t i = 0; i < expected.functions.size(); ++i) {
+        const auto &lhs = actual.functions[i];
+        const auto &rhs = expected.functions[i];
+        EXPECT_EQ(lhs.class_name, rhs.class_name);
+        EXPECT_EQ(lhs.name, rhs.name);
+        ASSERT_EQ(lhs.metrics.size(), rhs.metrics.size());
+        for (std::size_t j = 0; j < rhs.metrics.size(); ++j) {
+            EXPECT_EQ(lhs.metrics[j].metric_name, rhs.metrics[j].metric_name);
+            EXPECT_EQ(lhs.metrics[j].value, rhs.metrics[j].value);
+        }
+    }
+}
+
+}  // namespace
+
+TEST(ResultCache, SerializationRoundTrips) {
+    const auto file = SampleCachedFile();
+    const auto restored = cache::Deserialize(cache::Serialize(file));
+    ASSERT_TRUE(restored.has_value());
+    ExpectSameFile(*restored, file);
+}
+
+TEST(ResultCache, RejectsDamagedData) {
+    const auto data = cache::Serialize(SampleCachedFile());
+    EXPECT_FALSE(cache::Deserialize(data.substr(0, data.size() - 3)).has_value());
+    EXPECT_FALSE(cache::Deserialize("analyzer-cache 0\n0\n").has_value());
+    EXPECT_FALSE(cache::Deserialize(data + "tail").has_value());
+}
+
+TEST(ResultCache, PersistsEntriesAcrossInstances) {
+    const TempTree tree("result_cache_");
+    const auto directory = tree.Path("cache");
+    {
+        cache::ResultCache cache(directory);
+        EXPECT_EQ(cache.Find("abcdef"), nullptr);
+        cache.Store("abcdef", std::make_shared<const cache::CachedFile>(SampleCachedFile()));
+        EXPECT_NE(cache.Find("abcdef"), nullptr);
+        EXPECT_EQ(cache.Hits(), 1u);
+        EXPECT_EQ(cache.Misses(), 1u);
+    }
+
+    cache::ResultCache reopened(directory);
+    const auto restored = reopened.Find("abcdef");
+    ASSERT_NE(restored, nullptr);
+    ExpectSameFile(*restored, SampleCachedFile());
+
+    std::ofstream(directory / "ab" / "abcdef", std::ios::trunc) << "garbage";
+    EXPECT_EQ(cache::ResultCache(directory).Find("abcdef"), nullptr);
+}
+
+TEST(ResultCache, MemoryOnlyCacheKeepsEntries) {
+    cache::ResultCache cache;
+    cache.Store("key", std::make_shared<const cache::CachedFile>(SampleCachedFile()));
+    ASSERT_NE(cache.Find("key"), nullptr);
+    EXPECT_EQ(cache.Find("other"), nullptr);
+}
+
+TEST(ResultCache, CapacityEvictsLeastRecentlyUsed) {
+    cache::ResultCache cache({}, 2);
+    const auto file = std::make_shared<const cache::CachedFile>(SampleCachedFile());
+    cache.Store("a", file);
+    cache.Store("b", file);
+    ASSERT_NE(cache.Find("a"), nullptr);
+    cache.Store("c", file);
+
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_NE(cache.Find("a"), nullptr);
+    EXPECT_EQ(cache.Find("b"), nullptr);
+    EXPECT_NE(cache.Find("c"), nullptr);
+}
+
+}  // namespace analyzer::tests
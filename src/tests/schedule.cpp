@@ -0,0 +1,82 @@
+#include "schedule.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace analyzer::tests {
+
+using analyzer::schedule::LongestFirstOrder;
+using analyzer::schedule::RunLongestFirst;
+using analyzer::schedule::ScheduleProfile;
+
+TEST(Schedule, LongestFirstOrderIsStableByDescendingCost) {
+    const std::vector<std::uint64_t> costs = {5, 100, 5, 0, 42};
+
+    EXPECT_EQ(LongestFirstOrder(costs), (std::vector<std::size_t>{1, 4, 0, 2, 3}));
+}
+
+TEST(Schedule, RunsEveryTaskOnceInLongestFirstOrder) {
+    const std::vector<std::uint64_t> costs = {1, 7, 3, 7, 2, 9};
+    std::vector<std::size_t> started;
+
+    const auto profile = RunLongestFirst(costs, 1, [&](std::size_t index, std::size_t worker) {
+        EXPECT_EQ(worker, 0u);
+        started.push_back(index);
+    });
+
+    EXPECT_EQ(started, LongestFirstOrder(costs));
+    EXPECT_EQ(profile.workers, 1u);
+}
+
+TEST(Schedule, ParallelWorkersCoverAllTasks) {
+    constexpr std::size_t kTasks = 200;
+    constexpr std::size_t kWorkers = 4;
+    const std::vector<std::uint64_t> costs(kTasks, 1);
+    std::vector<std::atomic<int>> visits(kTasks);
+    std::atomic<bool> bad_worker{false};
+
+    const auto profile = RunLongestFirst(costs, kWorkers, [&](std::size_t index, std::size_t worker) {
+        if (worker >= kWorkers)
+            bad_worker = true;
+        visits[index].fetch_add(1);
+    });
+
+    EXPECT_FALSE(bad_worker);
+    for (const auto &count : visits)
+        EXPECT_EQ(count.load(), 1);
+    EXPECT_EQ(profile.workers, kWorkers);
+    EXPECT_LE(profile.longest_task, profile.total_work);
+}
+
+TEST(Schedule, RethrowsTaskFailure) {
+    const std::vector<std::uint64_t> costs = {1, 2, 3};
+
+    EXPECT_THROW(RunLongestFirst(costs, 2,
+                                 [](std::size_t index, std::size_t) {
+                                     if (index == 1)
+                                         throw std::runtime_error("task failed");
+                                 }),
+                 std::runtime_error);
+}
+
+TEST(Schedule, IdealIsBoundedByLongestTaskAndAverageLoad) {
+    using std::chrono::nanoseconds;
+    const ScheduleProfile balanced{
+        .workers = 4, .makespan = nanoseconds(30), .total_work = nanoseconds(100), .longest_task = nanoseconds(10)};
+    const ScheduleProfile skewed{
+        .workers = 4, .makespan = nanoseconds(80), .total_work = nanoseconds(100), .longest_task = nanoseconds(80)};
+
+    EXPECT_EQ(balanced.Ideal(), nanoseconds(25));
+    EXPECT_DOUBLE_EQ(balanced.Efficiency(), 25.0 / 30.0);
+    EXPECT_EQ(skewed.Ideal(), nanoseconds(80));
+    EXPECT_DOUBLE_EQ(skewed.Efficiency(), 1.0);
+}
+
+}  // namespace analyzer::tests
@@ -0,0 +1,138 @@
+#include "source_reader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test_helpers.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+struct Expectation {
+    std::vector<std::string> paths;
+    std::vector<std::string> contents;  // Пустая строка у отсутствующего файла
+};
+
+Expectation MakeSources(const TempTree &sources, std::size_t count) {
+    Expectation expectation;
+    for (std::size_t i = 0; i < count; ++i) {
+        // Пустой, маленькие и больше страницы, чтобы проверить дочитывание
+        const auto content =
+            i % 7 == 0 ? std::string() : std::string(i * 311 % 9000 + 1, static_cast<char>('a' + i % 26));
+        expectation.paths.push_back(sources.Write("f" + std::to_string(i) + ".py", content));
+        expectation.contents.push_back(content);
+    }
+    expectation.paths.push_back(sources.Path("missing.py").string());
+    expectation.contents.emplace_back();
+    return expectation;
+}
+
+void ExpectBatchMatches(io::IBatchReader &reader, const Expectation &expectation) {
+    const auto result = reader.ReadBatch(expectation.paths);
+    ASSERT_EQ(result.size(), expectation.paths.size());
+    for (std::size_t i = 0; i + 1 < result.size(); ++i) {
+        ASSERT_TRUE(result[i].has_value()) << reader.Name() << ": " << result[i].error().message;
+        EXPECT_EQ(*result[i], expectation.contents[i]) << reader.Name() << ": " << expectation.paths[i];
+    }
+    ASSERT_FALSE(result.back().has_value());
+    EXPECT_EQ(result.back().error().code, ErrorCode::kIo);
+}
+
+// Считает прочитанные файлы и передаёт чтение настоящему читателю
+class CountingReader : public io::IBatchReader {
+public:
+    explicit CountingReader(std::atomic<std::size_t> &read) : read_(read) {}
+
+    std::vector<io::Source> ReadBatch(std::span<const std::string> paths) override {
+        read_ += paths.size();
+        return inner_->ReadBatch(paths);
+    }
+
+    std::string_view Name() const override { return "counting"; }
+
+private:
+    std::atomic<std::size_t> &read_;
+    std::unique_ptr<io::IBatchReader> inner_ = io::MakeBatchReader(io::Backend::kThreadPool, 2);
+};
+
+}  // namespace
+
+TEST(SourceReaderTest, ThreadPoolReadsWholeFiles) {
+    TempTree sources("reader_test_");
+    const auto expectation = MakeSources(sources, 50);
+    ExpectBatchMatches(*io::MakeBatchReader(io::Backend::kThreadPool, 3), expectation);
+}
+
+TEST(SourceReaderTest, IoUringReadsWholeFiles) {
+    std::unique_ptr<io::IBatchReader> reader;
+    try {
+        reader = io::MakeBatchReader(io::Backend::kIoUring);
+    } catch (const std::runtime_error &e) {
+        GTEST_SKIP() << e.what();
+    }
+    TempTree sources("reader_test_");
+    // Больше одного раунда кольца
+    const auto expectation = MakeSources(sources, 100);
+    ExpectBatchMatches(*reader, expectation);
+}
+
+TEST(SourceReaderTest, PrefetcherHandsOutFilesInAnyTakeOrder) {
+    TempTree sources("reader_test_");
+    const auto expectation = MakeSources(sources, 80);
+    std::vector<std::size_t> order(expectation.paths.size());
+    std::iota(order.rbegin(), order.rend(), 0);
+
+    io::Prefetcher prefetcher(expectation.paths, order, io::MakeBatchReader(), 8);
+    for (std::size_t index : order) {
+        auto source = prefetcher.Take(index);
+        if (index + 1 == expectation.paths.size()) {
+            EXPECT_FALSE(source.has_value());
+            continue;
+        }
+        ASSERT_TRUE(source.has_value()) << source.error().message;
+        EXPECT_EQ(*source, expectation.contents[index]);
+    }
+}
+
+TEST(SourceReaderTest, PrefetcherStopsWithUntakenFiles) {
+    TempTree sources("reader_test_");
+    const auto expectation = MakeSources(sources, 40);
+    std::vector<std::size_t> order(expectation.paths.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    io::Prefetcher prefetcher(expectation.paths, order, io::MakeBatchReader(), 4);
+    EXPECT_EQ(prefetcher.Take(0).value_or("x"), "");
+}
+
+TEST(SourceReaderTest, StoppedPrefetcherReadsNoMoreBatches) {
+    TempTree sources("reader_test_");
+    const auto expectation = MakeSources(sources, 100);
+    std::vector<std::size_t> order(expectation.paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::atomic<std::size_t> read = 0;
+
+    {
+        io::Prefetcher prefetcher(expectation.paths, order, std::make_unique<CountingReader>(read), 4);
+        ASSERT_TRUE(prefetcher.Take(0).has_value());
+        prefetcher.Stop();
+        // Прочитанное до остановки по-прежнему выдаётся, непрочитанное — сразу ошибка
+        EXPECT_EQ(prefetcher.Take(1).value_or(""), expectation.contents[1]);
+        const auto unread = prefetcher.Take(90);
+        ASSERT_FALSE(unread.has_value());
+        EXPECT_EQ(unread.error().code, ErrorCode::kSkipped);
+    }
+    // Первая пачка заполнила окно, после Stop новых пачек не было
+    EXPECT_LT(read.load(), expectation.paths.size());
+}
+
+}  // namespace analyzer::tests
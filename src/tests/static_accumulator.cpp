@@ -0,0 +1,149 @@
+#include "static_accumulator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "function.hpp"
+#include "metric.hpp"
+#include "metric_accumulator.hpp"
+#include "metric_accumulator_impl/accumulators.hpp"
+#include "metric_impl/metrics.hpp"
+
+namespace analyzer::tests {
+
+namespace {
+
+using analyzer::metric_accumulator::Bind;
+using analyzer::metric_accumulator::MetricsAccumulator;
+using analyzer::metric_accumulator::StaticMetricsAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::CategoricalAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::QuantileAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::SumAverageAccumulator;
+using analyzer::metric_accumulator::metric_accumulator_impl::TopKAccumulator;
+
+struct AstSizeMetric final : analyzer::metric::IMetric {
+    analyzer::Expected<int> CalculateValue(const analyzer::function::Function &f) const {
+        return static_cast<int>(f.ast.size());
+    }
+
+protected:
+    analyzer::Expected<analyzer::metric::MetricResult::ValueType> CalculateImpl(
+        const analyzer::function::Function &f) const override {
+        return *CalculateValue(f);
+    }
+
+    std::string Name() const override { return "static_ast_size"; }
+};
+
+struct FirstLetterMetric final : analyzer::metric::IMetric {
+protected:
+    analyzer::Expected<analyzer::metric::MetricResult::ValueType> CalculateImpl(
+        const analyzer::function::Function &f) const override {
+        return std::string(f.name.substr(0, 1));
+    }
+
+    std::string Name() const override { return "static_first_letter"; }
+};
+
+std::vector<analyzer::function::Function> SampleFunctions() {
+    std::vector<analyzer::function::Function> functions;
+    for (int i = 0; i < 40; ++i)
+        functions.push_back({.filename = "sample.py",
+                             .class_name = std::nullopt,
+                             .name = std::pmr::string((i % 3 == 0 ? "alpha_" : "beta_") + std::to_string(i)),
+                             .ast = std::pmr::string(static_cast<std::size_t>((i * 37) % 101), 'x')});
+    return functions;
+}
+
+using SizeBind = Bind<AstSizeMetric, SumAverageAccumulator, QuantileAccumulator, TopKAccumulator>;
+using LetterBind = Bind<FirstLetterMetric, CategoricalAccumulator>;
+
+}  // namespace
+
+TEST(StaticAccumulator, MatchesRuntimeAccumulatorPath) {
+    const auto functions = SampleFunctions();
+
+    StaticMetricsAccumulator<SizeBind, LetterBind> compiled;
+    compiled.EvaluateAll(functions);
+
+    analyzer::metric::MetricExtractor extractor;
+    extractor.RegisterMetric(std::make_unique<AstSizeMetric>());
+    extractor.RegisterMetric(std::make_unique<FirstLetterMetric>());
+    MetricsAccumulator sums;
+    MetricsAccumulator tops;
+    const auto sum_handle = sums.RegisterAccumulator("static_ast_size", std::make_unique<SumAverageAccumulator>());
+    const auto letters_handle =
+        sums.RegisterAccumulator("static_first_letter", std::make_unique<CategoricalAccumulator>());
+    const auto top_handle = tops.RegisterAccumulator("static_ast_size", std::make_unique<TopKAccumulator>());
+    for (const auto &function : functions) {
+        const auto results = extractor.Get(function);
+        sums.AccumulateNextFunctionResults(function, results);
+        tops.AccumulateNextFunctionResults(function, results);
+    }
+
+    auto &size_bind = compiled.Get<SizeBind>();
+    EXPECT_EQ(size_bind.GetFinalizedAccumulator<SumAverageAccumulator>().Get(),
+              sums.GetFinalizedAccumulator(sum_handle).Get());
+    EXPECT_EQ(size_bind.GetFinalizedAccumulator<TopKAccumulator>().Get(),
+              tops.GetFinalizedAccumulator(top_handle).Get());
+    EXPECT_EQ(compiled.Get<1>().GetFinalizedAccumulator<CategoricalAccumulator>().Get(),
+              sums.GetFinalizedAccumulator(letters_handle).Get());
+}
+
+TEST(StaticAccumulator, MergeMatchesSerialEvaluation) {
+    const auto functions = SampleFunctions();
+    SizeBind serial;
+    SizeBind left;
+    SizeBind right;
+    for (std::size_t i = 0; i < functions.size(); ++i) {
+        serial.Evaluate(functions[i]);
+        (i < functions.size() / 2 ? left : right).Evaluate(functions[i]);
+    }
+
+    left.Merge(right);
+
+    EXPECT_EQ(left.GetFinalizedAccumulator<SumAverageAccumulator>().Get(),
+              serial.GetFinalizedAccumulator<SumAverageAccumulator>().Get());
+    EXPECT_EQ(left.GetFinalizedAccumulator<TopKAccumulator>().Get(),
+              serial.GetFinalizedAccumulator<TopKAccumulator>().Get());
+    EXPECT_EQ(left.GetFinalizedAccumulator<QuantileAccumulator>().Get(0.5),
+              serial.GetFinalizedAccumulator<QuantileAccumulator>().Get(0.5));
+}
+
+TEST(StaticAccumulator, AccumulatorsCanBeConfigured) {
+    Bind<AstSizeMetric, TopKAccumulator> bind(TopKAccumulator(2));
+    for (const auto &function : SampleFunctions())
+        bind.Evaluate(function);
+
+    EXPECT_EQ(bind.GetFinalizedAccumulator<TopKAccumulator>().Get().size(), 2u);
+
+    bind.Reset();
+    EXPECT_TRUE(bind.GetFinalizedAccumulator<TopKAccumulator>().Get().empty());
+}
+
+TEST(StaticAccumulator, IntMetricsBypassMetricResult) {
+    using analyzer::metric::metric_impl::CountParametersMetric;
+    using analyzer::metric::metric_impl::CyclomaticComplexityMetric;
+    static_assert(analyzer::metric_accumulator::detail::IntMetric<CyclomaticComplexityMetric>);
+    static_assert(!analyzer::metric_accumulator::detail::IntMetric<FirstLetterMetric>);
+
+    const analyzer::function::Function branchy{.filename = "a.py",
+                                               .class_name = std::nullopt,
+                                               .name = "branchy",
+                                               .ast = "(if_statement\n(for_statement\n(if_statement\n"};
+    Bind<CyclomaticComplexityMetric, SumAverageAccumulator, TopKAccumulator> bind;
+    bind.Evaluate(branchy);
+    EXPECT_EQ(bind.GetFinalizedAccumulator<SumAverageAccumulator>().Get().sum, 3);
+    EXPECT_EQ(bind.GetFinalizedAccumulator<TopKAccumulator>().Get().front().function.qualified_name, "branchy");
+
+    // Ошибка типизированного вычисления бросается так же, как из IMetric::Calculate
+    Bind<CountParametersMetric, SumAverageAccumulator> parameters;
+    EXPECT_THROW(parameters.Evaluate(branchy), std::runtime_error);
+}
+
+}  // namespace analyzer::tests
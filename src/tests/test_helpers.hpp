@@ -0,0 +1,75 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file.hpp"
+#include "metric.hpp"
+#include "metric_impl/metrics.hpp"
+
+namespace analyzer::tests {
+
+// Образец из src/tests/files
+inline std::filesystem::path SampleFile(const std::string &name = "analysis_sample_one.py") {
+    return std::filesystem::path(__FILE__).parent_path() / "files" / name;
+}
+
+// Метрики строк кода и цикломатической сложности — обе зависят от разбора файла
+inline metric::MetricExtractor BuildExtractor() {
+    metric::MetricExtractor extractor;
+    extractor.RegisterMetric(std::make_unique<metric::metric_impl::CodeLinesCountMetric>());
+    extractor.RegisterMetric(std::make_unique<metric::metric_impl::CyclomaticComplexityMetric>());
+    return extractor;
+}
+
+// Временный каталог <tmp>/<prefix><pid>; удаляется вместе с содержимым
+class TempTree {
+public:
+    explicit TempTree(const std::string &prefix)
+        : root_(std::filesystem::temp_directory_path() / (prefix + std::to_string(getpid()))) {
+        std::filesystem::remove_all(root_);
+        std::filesystem::create_directories(root_);
+    }
+
+    TempTree(const TempTree &) = delete;
+    TempTree &operator=(const TempTree &) = delete;
+
+    ~TempTree() { std::filesystem::remove_all(root_); }
+
+    // Создаёт файл вместе с родительскими каталогами и возвращает его путь
+    std::string Write(const std::string &relative, const std::string &content = "") const {
+        const auto path = root_ / relative;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+        return path.string();
+    }
+
+    std::filesystem::path Path(const std::string &relative) const { return root_ / relative; }
+    std::string Root() const { return root_.string(); }
+
+private:
+    std::filesystem::path root_;
+};
+
+// Подменяет команду разбора file::File::command до конца области видимости
+class ScopedParserCommand {
+public:
+    explicit ScopedParserCommand(std::vector<std::string> command)
+        : saved_(std::exchange(file::File::command, std::move(command))) {}
+
+    ScopedParserCommand(const ScopedParserCommand &) = delete;
+    ScopedParserCommand &operator=(const ScopedParserCommand &) = delete;
+
+    ~ScopedParserCommand() { file::File::command = std::move(saved_); }
+
+private:
+    std::vector<std::string> saved_;
+};
+
+}  // namespace analyzer::tests